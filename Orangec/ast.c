@@ -12,12 +12,13 @@
 
 #include "./ast.h"
 
+#include "../util/alloc.h"
 #include "../util/debug.h"
 
 /*
     Allocates and initializes an Abstract Syntax Tree node, with the proper type */
 struct astNode* ast_create(enum astType type, const char* filename, int line, struct symbolNode* scope, struct astNode* parent) {
-    struct astNode* retval = (struct astNode*) calloc(1, sizeof(struct astNode));
+    struct astNode* retval = (struct astNode*)alloc_calloc(ALLOC_AST, 1, sizeof(struct astNode));
     retval->type = type;
     retval->children = list_create();
     retval->filename = filename;
@@ -27,6 +28,33 @@ struct astNode* ast_create(enum astType type, const char* filename, int line, st
     return retval;
 }
 
+/*
+    Frees an AST node and all of its children. 
+    
+    Blocks own the symbol that holds their local variables, which is removed 
+    from its parent and freed along with the block. Symbol definitions do not 
+    own the symbol they define, it is freed with the block it is in. */
+void ast_destroy(struct astNode* node) {
+    if(node == NULL) {
+        return;
+    }
+    struct listElem* elem;
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        ast_destroy(elem->data);
+    }
+    list_destroy(node->children);
+
+    if(node->type == AST_BLOCK) {
+        struct symbolNode* block = node->data;
+        map_remove(block->parent->children, block->name);
+        symbol_destroy(block);
+    } else if(node->type != AST_SYMBOLDEFINE) {
+        free(node->data);
+    }
+    free(node->valueType);
+    alloc_free(ALLOC_AST, node, sizeof(struct astNode));
+}
+
 /*
     Converts an AST type to a string */
 char* ast_toString(enum astType type) {
@@ -93,6 +121,8 @@ char* ast_toString(enum astType type) {
         return "astType.IFELSE";
     case AST_WHILE: 
         return "astType.WHILE";
+    case AST_PARALLEL: 
+        return "astType.PARALLEL";
     case AST_RETURN: 
         return "astType.RETURN";
     case AST_DOT: 
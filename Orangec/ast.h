@@ -27,7 +27,7 @@ enum astType {
     // Type operators
     AST_CAST, AST_NEW, AST_FREE,
     // StatementNode types
-	AST_BLOCK, AST_SYMBOLDEFINE, AST_IF, AST_IFELSE, AST_WHILE, AST_RETURN,
+	AST_BLOCK, AST_SYMBOLDEFINE, AST_IF, AST_IFELSE, AST_WHILE, AST_PARALLEL, AST_RETURN,
     // Indexing
     AST_DOT, AST_INDEX, AST_MODULEACCESS,
     // Unused
@@ -43,12 +43,20 @@ struct astNode {
     struct list* children; // list of OTHER AST's ONLY!
     void* data;
     struct symbolNode* scope;
+    char* valueType; // type of an expression, filled in by the validator
+    long minValue;   // range of int arithmetic, kept by range.c while rangeStamp is current
+    long maxValue;
+    long rangeStamp;
+    struct symbolNode* assigned; // local that assignsLocal was last worked out for, by range.c
+    int assignsLocal;            // whether anything in this AST assigns to that local
+    struct symbolNode* symbol; // symbol a variable names, kept once symbol_findVar finds it
 
 	const char* filename;
 	int line;
 };
 
 struct astNode* ast_create(enum astType, const char*, int, struct symbolNode*, struct astNode*);
+void ast_destroy(struct astNode*);
 char* ast_toString(enum astType);
 char* itoa(int);
 enum astType ast_tokenToAST(enum tokenType);
@@ -9,29 +9,251 @@
     Date: 3/6/21
 */
 
+#include <ctype.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "./ast.h"
 #include "./generator.h"
+#include "./ir.h"
 #include "./main.h"
+#include "./parser.h"
+#include "./profile.h"
+#include "./range.h"
 #include "./symbol.h"
+#include "./validator.h"
 
 #include "../util/debug.h"
 #include "../util/list.h"
 #include "../util/map.h"
 
+/*
+    Counts of how names are used throughout a program, used to decide which 
+    names are shortened when minifying, and what they are shortened to */
+struct nameUses {
+    int* ids;               // UID -> number of times the symbol is written out
+    struct map* fields;     // field name -> int* number of times the field is written out
+    struct map* kept;       // set of field names that JavaScript code may depend on
+    int* constructed;       // struct UID -> whether the struct is ever created with new
+    int* accessed;          // struct UID -> whether a field of the struct is ever read or written
+    int* interop;           // struct UID -> whether the struct is passed to or from JavaScript
+};
+
+/*
+    A name, and how often it is used. Sorted to give the most used names the
+    shortest replacements */
+struct nameRank {
+    int id;
+    char* name;
+    int uses;
+};
+
+/*
+    Symbols being written out in parallel. Each thread takes the next symbol 
+    that has not been taken yet, and writes it to that symbol's own buffer. */
+struct parallelWork {
+    struct symbolNode** symbols;
+    char** buffers;         // generated code for each symbol
+    size_t* lengths;        // length of each buffer
+    int numSymbols;
+    int next;               // index of the next symbol to take
+    pthread_mutex_t lock;   // guards next
+};
+
+/*
+    Shortened names, used when minifying. Filled in before any code is 
+    written, and only read from afterwards. */
+static int* idRanks = NULL;         // UID -> number to print in place of UID
+static struct map* fieldNames = NULL; // field name -> shortened field name
+
+/*
+    What is known about how modules use each other, used when splitting a 
+    program into one chunk per module. Filled in before any chunks are 
+    written, and only read from afterwards. */
+struct splitInfo {
+    int* asValue;           // function UID -> whether the function is ever used as a value
+    int* called;            // function UID -> whether the function is ever called directly
+    int* eager;             // module UID -> whether the module is loaded up front rather than lazily
+    int* exported;          // UID -> whether the symbol is used by another module
+    struct list** imports;  // module UID -> symbols the module uses from other modules
+    struct list** loads;    // function UID -> lazy modules to import before the function runs
+};
+
+static struct splitInfo* split = NULL;
+static char* chunkBase = NULL; // output filename, without the .js extension
+
+/*
+    Where each function counts its calls and time in the profile table, used
+    when instrumenting. Filled in before any code is written, and only read
+    from afterwards. */
+static int* profileSlots = NULL;            // function UID -> index in the profile table
+static struct list* profiledFunctions = NULL; // functions, in the order of their index
+
+/*
+    A call that is being written out as the expression that the function it
+    calls returns. Parameters of the function are written out as the arguments
+    given in the call. Threads inline calls separately, so each thread has its
+    own. */
+struct inlineCall {
+    struct symbolNode* function;
+    struct astNode** args; // argument given for each parameter, in order
+    int numArgs;
+};
+
+static __thread struct inlineCall* inlining = NULL;
+
+// Functions are only inlined if they were called this often in the profile
+static const int INLINE_MIN_CALLS = 1000;
+// and return an expression with at most this many nodes
+static const int INLINE_MAX_NODES = 16;
+
+/*
+    A row of the size report. Names are kept when a symbol is written, since 
+    its code, and the symbols in it, may be freed after that when streaming */
+struct sizeEntry {
+    char* name;
+    const char* kind;
+    const char* module;
+    long bytes;
+};
+
+/*
+    Bytes of output written for each symbol, for --size-report. Each symbol is
+    only written by one thread, so threads can add to it without locking. */
+static struct sizeEntry* symbolSizes = NULL; // UID -> size of the symbol's output
+static int numSizes = 0;
+
+/*
+    Where struct fields are kept, when structs are laid out in one heap. 
+    Filled in before any code is written, and only read from afterwards. */
+static int* heapSizes = NULL;   // struct UID -> bytes in each record, 0 if the struct is kept as an object
+static int* heapOffsets = NULL; // field UID -> bytes from the start of its record to the field
+
+/*
+    How a field is kept in a heap record. Ints, enums, booleans, and pointers 
+    to other records take 4 bytes, reals take 8. Anything else, like arrays, 
+    strings, and JavaScript objects, is kept in a plain array at the index of
+    its 4 bytes in the record. */
+enum heapKind {
+    HEAP_INT, HEAP_REAL, HEAP_BOOLEAN, HEAP_POINTER, HEAP_OBJECT
+};
+
+/*
+    A while loop that counts an int up by one each time around. Loops like this
+    come from for loops, and are often written out by hand:
+
+        int i = start;
+        while i < end {
+            ...
+            i = i + 1;
+        }
+
+    The condition may also be <=. The counter may be set with an assignment
+    rather than a definition, or not be set right before the loop at all. */
+struct countedLoop {
+    struct astNode* loop;
+    struct symbolNode* counter;
+    struct astNode* start;      // what the counter is set to right before the loop, NULL if not known
+    struct astNode* end;        // what the counter is compared with
+    int inclusive;              // whether the counter is compared with <=
+    struct astNode* increment;  // the last statement of the body
+};
+
+// Loops are unrolled if they go around a known number of times, at most this many
+static const int UNROLL_MAX_TRIPS = 8;
+// and their body, written out that many times, has at most this many nodes
+static const int UNROLL_MAX_NODES = 64;
+
+static void generateSymbol(FILE*, struct symbolNode*);
+static void recordSize(struct symbolNode*, long);
+static void reportSizes(long);
+static int compareSizes(const void*, const void*);
+static int compareNames(const void*, const void*);
+static void generateParallel(FILE*, struct list*);
+static void* generateWorker(void*);
 static void constructLists(struct symbolNode*, struct list*, struct list*, struct list*, struct list*);
+static void parseBody(struct symbolNode*);
+static void releaseCode(struct symbolNode*);
+static void findCalls(struct astNode*, struct splitInfo*);
+static void findReferences(struct astNode*, struct symbolNode*, struct symbolNode*, struct splitInfo*);
+static struct symbolNode* referencedSymbol(struct astNode*);
+static struct symbolNode* symbolModule(struct symbolNode*);
+static int isCallback(struct symbolNode*, struct splitInfo*);
+static void addUnique(struct list*, void*);
+static char* chunkFilename(struct symbolNode*, int);
+static void generateChunk(FILE*, struct symbolNode*);
+static void generateReference(FILE*, struct symbolNode*, struct astNode*);
+static void minifyNames(struct list*, struct list*, struct list*);
+static void countUses(struct list*, struct list*, struct list*, struct nameUses*);
+static void layoutHeap(struct list*, struct list*, struct list*);
+static enum heapKind heapKind(const char*);
+static struct symbolNode* heapStruct(const char*);
+static void generateHeap(FILE*);
+static void generateHeapStruct(FILE*, struct symbolNode*);
+static void generateHeapField(FILE*, struct astNode*, int);
+static int maxID(struct symbolNode*);
+static void countSymbols(struct symbolNode*, struct nameUses*);
+static void countAST(struct astNode*, struct nameUses*);
+static void addFieldUses(struct map*, char*, int);
+static struct symbolNode* typeStruct(const char*);
+static void keepVerbatimNames(char*, struct map*);
+static int compareRanks(const void*, const void*);
+static char* shortName(int);
+static char* fieldName(char*);
 static void fprintb(FILE*, int);
+static void generateReal(FILE*, float);
+static void generateSemicolon(FILE*, int);
 static void generateEnum(FILE*, struct symbolNode*);
 static void generateStruct(FILE*, struct symbolNode*);
 static void generateVariable(FILE*, struct symbolNode*);
 static void generateFunction(FILE*, struct symbolNode*);
+static void generateParams(FILE*, struct symbolNode*);
+static void assignProfileSlots(struct list*);
+static void generateProfileTable(FILE*);
+static void generateProfileEntry(FILE*, struct symbolNode*);
+static void generateProfileExit(FILE*, struct symbolNode*);
+static struct astNode* inlineExpression(struct astNode*, struct symbolNode*);
+static int countInlineNodes(struct astNode*);
+static int isInlineArg(struct astNode*);
+static void generateInline(FILE*, struct astNode*, struct symbolNode*, struct astNode*);
+static void generateFunctionIR(FILE*, struct irFunction*);
+static void generateLocals(FILE*, struct symbolNode*, int*);
+static void generateInstr(FILE*, struct irInstr*, int*, struct irBlock*);
+static void generatePhiMoves(FILE*, struct irBlock*, struct irBlock*);
+static void generateIRValue(FILE*, struct irInstr*);
+static void generateIRExpression(FILE*, struct irInstr*);
+static int isInlineValue(enum irOp);
 static void generateAST(FILE*, int, struct astNode*);
+static void generateBlock(FILE*, struct astNode*, struct astNode*);
+static int findCountedLoop(struct astNode*, struct astNode*, struct countedLoop*);
+static void generateCountedLoop(FILE*, int, struct countedLoop*);
+static void generateFill(FILE*, struct countedLoop*);
+static int generateUnrolled(FILE*, int, struct countedLoop*);
+static void generateEnd(FILE*, struct countedLoop*);
+static int isVarOf(struct astNode*, struct symbolNode*);
+static int isPure(struct astNode*);
+static int assignsTo(struct astNode*, struct symbolNode*, struct astNode*);
+static int assignedByClosure(struct astNode*, struct symbolNode*);
+static int countLoopNodes(struct astNode*);
+static void generateParallelLoop(FILE*, int, struct astNode*);
+static void findCaptures(struct astNode*, struct symbolNode*, struct symbolNode*, struct list*);
+static int hasParallelLoops(struct list*);
+static void generateWorkerPool(FILE*);
 static void generateExpression(FILE*, struct astNode*);
+static void generateIntArithmetic(FILE*, struct astNode*);
 
 /*
-    Writes a JavaScript file to the given file according to the program structure. */
+    Writes a JavaScript file to the given file according to the program structure. 
+    
+    When streaming, the bodies of functions are parsed and validated right 
+    before they are written, and their code is freed right after, so that only
+    the code of one function is held on to at a time. Functions inside other functions are written right 
+    after the function they are in, and are validated and freed along with it. 
+    
+    When there is more than one job, symbols are written in parallel instead,
+    each to its own buffer, and the buffers are written out in order. IR dumps
+    are printed in order, so they are always written one at a time. */
 void generator_generate(FILE* out) {
     fprintf(out, "/*\n\tGenerated with Orange compiler\n\tWritten and developed by Joseph Shimel\n\thttps://github.com/rakhyvel/Orange\n*/\n");
     struct list* enumList = list_create();
@@ -39,36 +261,546 @@ void generator_generate(FILE* out) {
     struct list* globalList = list_create();
     struct list* functionList = list_create();
     struct symbolNode* start = NULL;
+    if(options.sizeReport != NULL) {
+        numSizes = maxID(program) + 1;
+        symbolSizes = (struct sizeEntry*)calloc(numSizes, sizeof(struct sizeEntry));
+    }
+    constructLists(program, enumList, structList, globalList, functionList);
+    profile_order(functionList);
+    if(options.minify) {
+        minifyNames(structList, globalList, functionList);
+    }
+    if(options.instrument) {
+        assignProfileSlots(functionList);
+        generateProfileTable(out);
+    }
+    if(options.heap) {
+        layoutHeap(structList, globalList, functionList);
+        generateHeap(out);
+    }
+    if(hasParallelLoops(functionList)) {
+        generateWorkerPool(out);
+    }
+
+    // Symbols are written in this order, since JavaScript reads files in order
+    struct list* symbols = list_create();
+    struct list* lists[] = {enumList, structList, globalList, functionList};
+    struct listElem* elem;
+    for(int i = 0; i < 4; i++) {
+        for(elem = list_begin(lists[i]); elem != list_end(lists[i]); elem = list_next(elem)) {
+            queue_push(symbols, elem->data);
+        }
+    }
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem)) {
+        if(!strcmp(((struct symbolNode*)elem->data)->name, "start")) {
+            start = elem->data;
+        }
+    }
+    int startID = start != NULL ? start->id : -1; // start's code may be freed when streaming
+
+    if(options.jobs > 1 && !options.dumpIR) {
+        generateParallel(out, symbols);
+    } else {
+        struct symbolNode* streamed = NULL;
+        for(elem = list_begin(symbols); elem != list_end(symbols); elem = list_next(elem)) {
+            struct symbolNode* symbol = elem->data;
+            if(options.stream && symbol->symbolType == SYMBOL_FUNCTION && symbol->parent->symbolType != SYMBOL_BLOCK) {
+                releaseCode(streamed);
+                parseBody(symbol);
+                validator_validate(symbol);
+                streamed = symbol;
+            }
+            generateSymbol(out, symbol);
+        }
+        releaseCode(streamed);
+    }
+
+    if(startID != -1) {
+        fprintb(out, startID);
+        fprintf(out, "()%s", options.minify ? "" : "\n");
+    }
+    if(symbolSizes != NULL) {
+        reportSizes(ftell(out));
+    }
+}
+
+/*
+    Writes out an enum, struct, global, or function, followed by a new line. */
+static void generateSymbol(FILE* out, struct symbolNode* symbol) {
+    long start = symbolSizes != NULL ? ftell(out) : 0;
+    switch(symbol->symbolType) {
+    case SYMBOL_ENUM:
+        generateEnum(out, symbol);
+        break;
+    case SYMBOL_STRUCT:
+        generateStruct(out, symbol);
+        break;
+    case SYMBOL_VARIABLE:
+        generateVariable(out, symbol);
+        fprintf(out, ";");
+        break;
+    default:
+        if(options.emitIR || options.dumpIR) {
+            struct irFunction* function = ir_lower(symbol);
+            ir_verify(function);
+            if(options.dumpIR) {
+                ir_print(stdout, function);
+            }
+            if(options.emitIR) {
+                generateFunctionIR(out, function);
+            } else {
+                generateFunction(out, symbol);
+            }
+        } else {
+            generateFunction(out, symbol);
+        }
+    }
+    fprintf(out, "%s", options.minify ? "" : "\n");
+    if(symbolSizes != NULL) {
+        recordSize(symbol, ftell(out) - start);
+    }
+}
+
+/*
+    Writes out symbols using a thread for each job. Generating a symbol only 
+    reads the program structure, so threads can share it without locking. Each
+    symbol is written to its own buffer, and once every thread is done, the 
+    buffers are written out in the same order the symbols are in. */
+static void generateParallel(FILE* out, struct list* symbols) {
+    struct parallelWork work;
+    work.numSymbols = symbols->size;
+    work.next = 0;
+    work.symbols = (struct symbolNode**)malloc(sizeof(struct symbolNode*) * (work.numSymbols + 1));
+    work.buffers = (char**)calloc(work.numSymbols + 1, sizeof(char*));
+    work.lengths = (size_t*)calloc(work.numSymbols + 1, sizeof(size_t));
+    pthread_mutex_init(&work.lock, NULL);
+    int i = 0;
+    struct listElem* elem;
+    for(elem = list_begin(symbols); elem != list_end(symbols); elem = list_next(elem)) {
+        work.symbols[i++] = elem->data;
+    }
+
+    int numThreads = options.jobs < work.numSymbols ? options.jobs : work.numSymbols;
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * (numThreads + 1));
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, STACK_SIZE);
+    for(i = 0; i < numThreads; i++) {
+        if(pthread_create(&threads[i], &attributes, generateWorker, &work)) {
+            PANIC("Could not create generator thread");
+        }
+    }
+    for(i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_attr_destroy(&attributes);
+
+    for(i = 0; i < work.numSymbols; i++) {
+        fwrite(work.buffers[i], 1, work.lengths[i], out);
+        free(work.buffers[i]);
+    }
+    pthread_mutex_destroy(&work.lock);
+    free(threads);
+    free(work.lengths);
+    free(work.buffers);
+    free(work.symbols);
+}
+
+/*
+    Takes symbols that have not been written yet one at a time, and writes 
+    them to their buffers, until there are none left. */
+static void* generateWorker(void* arg) {
+    struct parallelWork* work = (struct parallelWork*)arg;
+    while(1) {
+        pthread_mutex_lock(&work->lock);
+        int i = work->next++;
+        pthread_mutex_unlock(&work->lock);
+        if(i >= work->numSymbols) {
+            break;
+        }
+        FILE* buffer = open_memstream(&work->buffers[i], &work->lengths[i]);
+        if(buffer == NULL) {
+            PANIC("Could not create generator buffer");
+        }
+        generateSymbol(buffer, work->symbols[i]);
+        fclose(buffer);
+    }
+    return NULL;
+}
+
+/*
+    Writes a program as ES modules, one chunk for each Orange module, and an
+    entry file that imports the module with the start function and calls it. 
+    Chunks are written next to the entry file, named after it and their 
+    module. Pages must load the entry file as a module script.
+    
+    Chunks import what they use from other modules. Modules that are only 
+    used by callbacks (void functions that are used as values, and never 
+    called directly) are not imported up front. Instead, the callbacks that 
+    use them become async functions that import the module when they first 
+    run, so that pages only parse what start needs to load.
+    
+    Representation:
+        import {symbolUID, ...} from "./output.Module.js";
+        export function functionUID(param, ...){ ...code... }
+        async function callbackUID(param, ...){const $Module=await import("./output.Module.js");{ ...code... }} */
+void generator_generateSplit(const char* filename) {
+    struct list* enumList = list_create();
+    struct list* structList = list_create();
+    struct list* globalList = list_create();
+    struct list* functionList = list_create();
     constructLists(program, enumList, structList, globalList, functionList);
+    if(options.minify) {
+        minifyNames(structList, globalList, functionList);
+    }
+    if(options.instrument) {
+        assignProfileSlots(functionList);
+    }
+
+    chunkBase = (char*)malloc(strlen(filename) + 1);
+    strcpy(chunkBase, filename);
+    int length = strlen(chunkBase);
+    if(length > 3 && !strcmp(chunkBase + length - 3, ".js")) {
+        chunkBase[length - 3] = '\0';
+    }
+
+    int numIDs = maxID(program) + 1;
+    struct splitInfo* info = (struct splitInfo*)malloc(sizeof(struct splitInfo));
+    info->asValue = (int*)calloc(numIDs, sizeof(int));
+    info->called = (int*)calloc(numIDs, sizeof(int));
+    info->eager = (int*)calloc(numIDs, sizeof(int));
+    info->exported = (int*)calloc(numIDs, sizeof(int));
+    info->imports = (struct list**)calloc(numIDs, sizeof(struct list*));
+    info->loads = (struct list**)calloc(numIDs, sizeof(struct list*));
+
+    // Callbacks must be known before references can be sorted into eager and lazy
+    struct listElem* elem;
+    for(elem = list_begin(globalList); elem != list_end(globalList); elem = list_next(elem)) {
+        findCalls(((struct symbolNode*)elem->data)->code, info);
+    }
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem)) {
+        findCalls(((struct symbolNode*)elem->data)->code, info);
+    }
+    struct symbolNode* start = NULL;
+    for(elem = list_begin(globalList); elem != list_end(globalList); elem = list_next(elem)) {
+        struct symbolNode* global = (struct symbolNode*)elem->data;
+        findReferences(global->code, NULL, symbolModule(global), info);
+    }
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem)) {
+        struct symbolNode* function = (struct symbolNode*)elem->data;
+        findReferences(function->code, function, symbolModule(function), info);
+        if(!strcmp(function->name, "start")) {
+            start = function;
+            info->eager[symbolModule(start)->id] = 1;
+            info->exported[start->id] = 1;
+        }
+    }
+    // Callbacks only need to import modules that are not already loaded
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem)) {
+        struct symbolNode* function = (struct symbolNode*)elem->data;
+        struct list* loads = info->loads[function->id];
+        if(loads == NULL) continue;
+        info->loads[function->id] = list_create();
+        struct listElem* loadElem;
+        for(loadElem = list_begin(loads); loadElem != list_end(loads); loadElem = list_next(loadElem)) {
+            if(!info->eager[((struct symbolNode*)loadElem->data)->id]) {
+                queue_push(info->loads[function->id], loadElem->data);
+            }
+        }
+    }
+    split = info;
+
+    long total = 0;
+    if(options.sizeReport != NULL) {
+        numSizes = numIDs;
+        symbolSizes = (struct sizeEntry*)calloc(numSizes, sizeof(struct sizeEntry));
+    }
+    for(elem = list_begin(program->children->keyList); elem != list_end(program->children->keyList); elem = list_next(elem)) {
+        struct symbolNode* module = (struct symbolNode*)map_get(program->children, elem->data);
+        char* chunkName = chunkFilename(module, 0);
+        char* chunk;
+        size_t chunkLength;
+        FILE* out = open_memstream(&chunk, &chunkLength);
+        generateChunk(out, module);
+        fclose(out);
+        writeOutput(chunkName, (unsigned char*)chunk, chunkLength);
+        total += chunkLength;
+        free(chunk);
+        free(chunkName);
+    }
+
+    char* entry;
+    size_t entryLength;
+    FILE* out = open_memstream(&entry, &entryLength);
+    fprintf(out, "/*\n\tGenerated with Orange compiler\n\tWritten and developed by Joseph Shimel\n\thttps://github.com/rakhyvel/Orange\n*/\n");
+    if(start != NULL) {
+        char* chunkName = chunkFilename(symbolModule(start), 1);
+        fprintf(out, "import {");
+        fprintb(out, start->id);
+        fprintf(out, "} from \"%s\";%s", chunkName, options.minify ? "" : "\n");
+        fprintb(out, start->id);
+        fprintf(out, "()%s", options.minify ? "" : "\n");
+        free(chunkName);
+    }
+    fclose(out);
+    writeOutput(filename, (unsigned char*)entry, entryLength);
+    free(entry);
+    if(symbolSizes != NULL) {
+        reportSizes(total + entryLength);
+    }
+}
+
+/*
+    Writes out the chunk for a module: its imports, followed by its enums, 
+    structs, globals, and functions. Symbols used by other modules are
+    exported. */
+static void generateChunk(FILE* out, struct symbolNode* module) {
+    LOG("Generate chunk %s", module->name);
+    const char* newline = options.minify ? "" : "\n";
+    fprintf(out, "/*\n\tGenerated with Orange compiler\n\tWritten and developed by Joseph Shimel\n\thttps://github.com/rakhyvel/Orange\n*/\n");
+
+    // Imports, grouped by the module they are from
+    struct list* imports = split->imports[module->id];
+    struct listElem* moduleElem;
+    for(moduleElem = list_begin(program->children->keyList); imports != NULL && moduleElem != list_end(program->children->keyList); moduleElem = list_next(moduleElem)) {
+        struct symbolNode* other = (struct symbolNode*)map_get(program->children, moduleElem->data);
+        if(!split->eager[other->id]) {
+            continue;
+        }
+        int numImports = 0;
+        struct listElem* elem;
+        for(elem = list_begin(imports); elem != list_end(imports); elem = list_next(elem)) {
+            struct symbolNode* symbol = (struct symbolNode*)elem->data;
+            if(symbolModule(symbol) == other) {
+                fprintf(out, numImports++ ? "," : "import {");
+                fprintb(out, symbol->id);
+            }
+        }
+        if(numImports > 0) {
+            char* chunkName = chunkFilename(other, 1);
+            fprintf(out, "} from \"%s\";%s", chunkName, newline);
+            free(chunkName);
+        }
+    }
 
-    struct listElem* elem = list_begin(enumList);
-    for(;elem != list_end(enumList); elem = list_next(elem)) {
+    struct list* enumList = list_create();
+    struct list* structList = list_create();
+    struct list* globalList = list_create();
+    struct list* functionList = list_create();
+    constructLists(module, enumList, structList, globalList, functionList);
+    profile_order(functionList);
+    if(options.instrument) {
+        generateProfileTable(out);
+    }
+    if(hasParallelLoops(functionList)) {
+        generateWorkerPool(out);
+    }
+    struct listElem* elem;
+    for(elem = list_begin(enumList); elem != list_end(enumList); elem = list_next(elem)) {
+        long start = ftell(out);
+        fprintf(out, split->exported[((struct symbolNode*)elem->data)->id] ? "export let " : "let ");
         generateEnum(out, elem->data);
-        fprintf(out, "\n");
+        fprintf(out, "%s", newline);
+        recordSize(elem->data, ftell(out) - start);
     }
-    elem = list_begin(structList);
-    for(;elem != list_end(structList); elem = list_next(elem)) {
+    for(elem = list_begin(structList); elem != list_end(structList); elem = list_next(elem)) {
+        long start = ftell(out);
+        fprintf(out, split->exported[((struct symbolNode*)elem->data)->id] ? "export " : "");
         generateStruct(out, elem->data);
-        fprintf(out, "\n");
+        fprintf(out, "%s", newline);
+        recordSize(elem->data, ftell(out) - start);
     }
-    elem = list_begin(globalList);
-    for(;elem != list_end(globalList); elem = list_next(elem)) {
+    for(elem = list_begin(globalList); elem != list_end(globalList); elem = list_next(elem)) {
+        long start = ftell(out);
+        fprintf(out, split->exported[((struct symbolNode*)elem->data)->id] ? "export " : "");
         generateVariable(out, elem->data);
-        fprintf(out, "\n");
+        fprintf(out, ";%s", newline);
+        recordSize(elem->data, ftell(out) - start);
     }
-    elem = list_begin(functionList);
-    for(;elem != list_end(functionList); elem = list_next(elem)) {
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem)) {
+        long start = ftell(out);
+        fprintf(out, split->exported[((struct symbolNode*)elem->data)->id] ? "export " : "");
         generateFunction(out, elem->data);
-        if(!strcmp(((struct symbolNode*)elem->data)->name, "start")) {
-            start = elem->data;
+        fprintf(out, "%s", newline);
+        recordSize(elem->data, ftell(out) - start);
+    }
+}
+
+/*
+    Finds functions that are used as values, and functions that are called
+    directly */
+static void findCalls(struct astNode* node, struct splitInfo* info) {
+    if(node == NULL) return;
+    struct listElem* elem;
+    switch(node->type) {
+    case AST_SYMBOLDEFINE: {
+        struct symbolNode* symbol = (struct symbolNode*)node->data;
+        if(symbol->symbolType == SYMBOL_VARIABLE) {
+            findCalls(symbol->code, info);
+        }
+        return;
+    }
+    case AST_DOT:
+        findCalls(node->children->head.next->next->data, info);
+        return;
+    case AST_VAR:
+    case AST_CALL: {
+        struct symbolNode* symbol = referencedSymbol(node);
+        if(symbol != NULL && symbol->symbolType == SYMBOL_FUNCTION) {
+            if(node->type == AST_VAR) {
+                info->asValue[symbol->id] = 1;
+            } else {
+                info->called[symbol->id] = 1;
+            }
         }
-        fprintf(out, "\n");
+    } break;
+    default:
+        break;
     }
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        findCalls(elem->data, info);
+    }
+}
 
-    if(start != NULL) {
-        fprintb(out, start->id);
-        fprintf(out, "()\n");
+/*
+    Finds the symbols from other modules that code in a module uses. The 
+    function the code is in is NULL for global initializers. 
+    
+    Modules used outside of callbacks must be loaded up front. Modules used 
+    in callbacks are loaded when the callback runs, unless they are already 
+    loaded up front. */
+static void findReferences(struct astNode* node, struct symbolNode* function, struct symbolNode* module, struct splitInfo* info) {
+    if(node == NULL) return;
+    struct listElem* elem;
+    switch(node->type) {
+    case AST_SYMBOLDEFINE: {
+        struct symbolNode* symbol = (struct symbolNode*)node->data;
+        if(symbol->symbolType == SYMBOL_VARIABLE) {
+            findReferences(symbol->code, function, module, info);
+        }
+        return;
+    }
+    case AST_DOT:
+        findReferences(node->children->head.next->next->data, function, module, info);
+        return;
+    case AST_ASSIGN: {
+        // Imported bindings are read only
+        struct astNode* leftAST = node->children->head.next->next->data;
+        if(leftAST->type == AST_MODULEACCESS) {
+            leftAST = leftAST->children->head.next->data;
+        }
+        struct symbolNode* var = leftAST->type == AST_VAR ? referencedSymbol(leftAST) : NULL;
+        if(var != NULL && symbolModule(var) != module) {
+            error(node->filename, node->line, "Cannot assign to \"%s\" from another module when splitting modules into chunks", var->name);
+        }
+    } break;
+    case AST_VAR:
+    case AST_CALL: {
+        struct symbolNode* symbol = referencedSymbol(node);
+        if(symbol == NULL || symbol->parent == NULL || symbol->parent->symbolType != SYMBOL_MODULE) {
+            break;
+        }
+        struct symbolNode* other = symbol->parent;
+        if(other == module) {
+            break;
+        }
+        info->exported[symbol->id] = 1;
+        if(info->imports[module->id] == NULL) {
+            info->imports[module->id] = list_create();
+        }
+        addUnique(info->imports[module->id], symbol);
+        if(function != NULL && isCallback(function, info)) {
+            if(info->loads[function->id] == NULL) {
+                info->loads[function->id] = list_create();
+            }
+            addUnique(info->loads[function->id], other);
+        } else {
+            info->eager[other->id] = 1;
+        }
+    } break;
+    default:
+        break;
+    }
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        findReferences(elem->data, function, module, info);
+    }
+}
+
+/*
+    Returns the symbol that a variable or call AST refers to, or NULL if it 
+    does not refer to one */
+static struct symbolNode* referencedSymbol(struct astNode* node) {
+    if(node->type == AST_VAR) {
+        return symbol_findVar(node);
+    } else if(node->type == AST_CALL && !strstr(node->data, " array")) {
+        struct symbolNode* symbol = symbol_findVar(node);
+        if(symbol == NULL) {
+            symbol = map_get(typeMap, node->data);
+        }
+        return symbol;
+    }
+    return NULL;
+}
+
+/*
+    Returns the module a symbol is defined in */
+static struct symbolNode* symbolModule(struct symbolNode* symbol) {
+    while(symbol != NULL && symbol->symbolType != SYMBOL_MODULE) {
+        symbol = symbol->parent;
     }
+    return symbol;
+}
+
+/*
+    Returns whether a function is a callback: a void function that is used as 
+    a value, but never called directly. Nothing waits for a callback to 
+    return, so callbacks can wait for modules to load. */
+static int isCallback(struct symbolNode* function, struct splitInfo* info) {
+    return info->asValue[function->id] && !info->called[function->id] && !strcmp(function->type, "void");
+}
+
+/*
+    Adds an element to a list, if it is not in the list already */
+static void addUnique(struct list* list, void* data) {
+    struct listElem* elem;
+    for(elem = list_begin(list); elem != list_end(list); elem = list_next(elem)) {
+        if(elem->data == data) {
+            return;
+        }
+    }
+    queue_push(list, data);
+}
+
+/*
+    Returns the filename of the chunk for a module. Relative filenames are 
+    used to import chunks from other chunks, which are in the same directory */
+static char* chunkFilename(struct symbolNode* module, int relative) {
+    const char* base = chunkBase;
+    if(relative) {
+        const char* slash = strrchr(chunkBase, '/');
+        base = slash != NULL ? slash + 1 : chunkBase;
+    }
+    char* retval = (char*)malloc(strlen(base) + strlen(module->name) + 8);
+    sprintf(retval, "%s%s.%s.js", relative ? "./" : "", base, module->name);
+    return retval;
+}
+
+/*
+    Writes out a reference to a symbol. When splitting, symbols from modules 
+    that are loaded lazily are accessed through the module they were imported
+    as. */
+static void generateReference(FILE* out, struct symbolNode* symbol, struct astNode* node) {
+    if(split != NULL) {
+        struct symbolNode* module = symbolModule(symbol);
+        struct astNode* site = node;
+        if(site->parent != NULL && site->parent->type == AST_MODULEACCESS) {
+            site = site->parent; // right side of a module access is scoped to the module accessed
+        }
+        if(module != NULL && !split->eager[module->id] && module != symbolModule(site->scope)) {
+            fprintf(out, "$%s.", module->name);
+        }
+    }
+    fprintb(out, symbol->id);
 }
 
 /*
@@ -92,7 +824,7 @@ static void constructLists(struct symbolNode* node, struct list* enumList, struc
             LOG("%s", child->name);
         } else if(child->symbolType == SYMBOL_VARIABLE && node->symbolType == SYMBOL_MODULE) {
             queue_push(globalList, child);
-        } else if(child->symbolType == SYMBOL_FUNCTION && child->code != NULL) {
+        } else if(child->symbolType == SYMBOL_FUNCTION && (child->code != NULL || child->body != NULL)) {
             queue_push(functionList, child);
             LOG("%s", child->name);
         }
@@ -101,164 +833,1387 @@ static void constructLists(struct symbolNode* node, struct list* enumList, struc
 }
 
 /*
-    Prints out a base 36 representation of a number to a stream.
-    
-    Used to print out UID's to the output file */ 
-static void fprintb(FILE* out, int num) {
-    char* buf = itoa(num);
-    fprintf(out, "_%s", buf);
-    //free(buf); //@fix why does this causes a "free(): invalid pointer" error
+    Parses the body of a function that was skipped over when streaming, and 
+    links and types the scopes in it, as was done for the rest of the program
+    before it was validated */
+static void parseBody(struct symbolNode* function) {
+    if(function->body != NULL) {
+        parser_parseBody(function);
+        symbol_linkScopes(function->code->data);
+        validator_updateStructType(function->code->data);
+    }
 }
 
 /*
-    Writes a JavaScript version of an enum
+    Frees the code of a function that has been written out. The function's 
+    symbol and parameters are kept, since other functions may still call it. */
+static void releaseCode(struct symbolNode* function) {
+    if(function != NULL) {
+        ast_destroy(function->code);
+        function->code = NULL;
+    }
+}
+
+/*
+    Decides the names that symbols and struct fields are written out as when
+    minifying.
+
+    Symbols are still written out as an underscore followed by a base 36 
+    number, but the number is the symbol's rank in how often it is written
+    out rather than its UID, so that the most used symbols are the shortest.
     
-    Representation:
-        enumUID = {field:ordinal, field:ordinal, ...}; */
-static void generateEnum(FILE* out, struct symbolNode* num) {
-    LOG("Generate enum");
-    fprintb(out, num->id);
-    fprintf(out, "={");
-    int ordinal = 0;
-    struct list* nums = num->children->keyList;
-    struct listElem* numElem;
-    for(numElem = list_begin(nums); numElem != list_end(nums); numElem = list_next(numElem)) {
-        fprintf(out, "%s:%d", (char*)numElem->data, ordinal++);
-        if(numElem->next != list_end(nums)){
-            fprintf(out, ", ");
+    Struct fields are renamed to short names the same way. A field name is
+    only renamed if JavaScript code cannot depend on it. That is, the name is 
+    not used in the text of a verbatim, and is not a field of a struct that 
+    JavaScript can see. Structs are considered visible to JavaScript if their
+    fields are used but they are never created with new (like KeyEvent, which
+    is created by the browser), if they are cast to, if they are passed into a
+    verbatim, or if they are a field of another such struct. */
+static void minifyNames(struct list* structList, struct list* globalList, struct list* functionList) {
+    int numIDs = maxID(program) + 1;
+    struct nameUses uses;
+    countUses(structList, globalList, functionList, &uses);
+    struct listElem* elem;
+
+    // Most used fields get the shortest names
+    struct list* fieldList = uses.fields->keyList;
+    struct nameRank* fields = (struct nameRank*)calloc(fieldList->size + 1, sizeof(struct nameRank));
+    int numFields = 0;
+    for(elem = list_begin(fieldList); elem != list_end(fieldList); elem = list_next(elem)) {
+        if(!set_contains(uses.kept, elem->data)) {
+            fields[numFields].id = numFields;
+            fields[numFields].name = elem->data;
+            fields[numFields].uses = *(int*)map_get(uses.fields, elem->data);
+            numFields++;
+        }
+    }
+    qsort(fields, numFields, sizeof(struct nameRank), compareRanks);
+    fieldNames = map_create();
+    int nameNum = 0;
+    for(int i = 0; i < numFields; i++) {
+        char* name = shortName(nameNum++);
+        while(set_contains(uses.kept, name)) {
+            name = shortName(nameNum++);
+        }
+        map_put(fieldNames, fields[i].name, name);
+    }
+
+    // Most used symbols get the shortest UIDs
+    struct nameRank* ids = (struct nameRank*)calloc(numIDs, sizeof(struct nameRank));
+    for(int i = 0; i < numIDs; i++) {
+        ids[i].id = i;
+        ids[i].uses = uses.ids[i];
+    }
+    qsort(ids, numIDs, sizeof(struct nameRank), compareRanks);
+    idRanks = (int*)calloc(numIDs, sizeof(int));
+    for(int i = 0; i < numIDs; i++) {
+        idRanks[ids[i].id] = i;
+    }
+
+    free(fields);
+    free(ids);
+    free(uses.ids);
+    free(uses.constructed);
+    free(uses.accessed);
+    free(uses.interop);
+}
+
+/*
+    Counts how often each symbol and field name is written out, and finds the
+    structs that JavaScript can see */
+static void countUses(struct list* structList, struct list* globalList, struct list* functionList, struct nameUses* uses) {
+    int numIDs = maxID(program) + 1;
+    uses->ids = (int*)calloc(numIDs, sizeof(int));
+    uses->fields = map_create();
+    uses->kept = map_create();
+    uses->constructed = (int*)calloc(numIDs, sizeof(int));
+    uses->accessed = (int*)calloc(numIDs, sizeof(int));
+    uses->interop = (int*)calloc(numIDs, sizeof(int));
+    set_add(uses->kept, "length"); // arrays
+    // Fields are also written out as constructor parameters, so keywords cannot be used
+    static char* keywords[] = {"do", "if", "in", "for", "let", "new", "try", "var", NULL};
+    for(int i = 0; keywords[i] != NULL; i++) {
+        set_add(uses->kept, keywords[i]);
+    }
+
+    countSymbols(program, uses);
+    struct listElem* elem;
+    for(elem = list_begin(globalList); elem != list_end(globalList); elem = list_next(elem)) {
+        countAST(((struct symbolNode*)elem->data)->code, uses);
+    }
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem)) {
+        countAST(((struct symbolNode*)elem->data)->code, uses);
+    }
+
+    // Structs visible to JavaScript make the structs in their fields visible too
+    for(elem = list_begin(structList); elem != list_end(structList); elem = list_next(elem)) {
+        struct symbolNode* dataStruct = (struct symbolNode*)elem->data;
+        if(uses->accessed[dataStruct->id] && !uses->constructed[dataStruct->id]) {
+            uses->interop[dataStruct->id] = 1;
+        }
+    }
+    int changed = 1;
+    while(changed) {
+        changed = 0;
+        for(elem = list_begin(structList); elem != list_end(structList); elem = list_next(elem)) {
+            struct symbolNode* dataStruct = (struct symbolNode*)elem->data;
+            if(!uses->interop[dataStruct->id]) {
+                continue;
+            }
+            struct listElem* fieldElem;
+            for(fieldElem = list_begin(dataStruct->children->keyList); fieldElem != list_end(dataStruct->children->keyList); fieldElem = list_next(fieldElem)) {
+                struct symbolNode* field = (struct symbolNode*)map_get(dataStruct->children, fieldElem->data);
+                struct symbolNode* fieldStruct = typeStruct(field->type);
+                if(fieldStruct != NULL && !uses->interop[fieldStruct->id]) {
+                    uses->interop[fieldStruct->id] = 1;
+                    changed = 1;
+                }
+                set_add(uses->kept, fieldElem->data);
+            }
+        }
+    }
+}
+
+/*
+    Returns the largest UID of any symbol in a symbol tree */
+static int maxID(struct symbolNode* node) {
+    int max = node->id;
+    struct listElem* elem;
+    for(elem = list_begin(node->children->keyList); elem != list_end(node->children->keyList); elem = list_next(elem)) {
+        int childMax = maxID(map_get(node->children, elem->data));
+        if(childMax > max) {
+            max = childMax;
+        }
+    }
+    return max;
+}
+
+/*
+    Counts the places symbols and struct fields are written out where they 
+    are defined, rather than where they are used */
+static void countSymbols(struct symbolNode* node, struct nameUses* uses) {
+    uses->ids[node->id]++;
+    struct listElem* elem;
+    for(elem = list_begin(node->children->keyList); elem != list_end(node->children->keyList); elem = list_next(elem)) {
+        if(node->symbolType == SYMBOL_STRUCT) {
+            addFieldUses(uses->fields, elem->data, 3); // constructor(field){this.field=field}
+        }
+        countSymbols(map_get(node->children, elem->data), uses);
+    }
+}
+
+/*
+    Counts the places symbols and struct fields are written out in an AST. 
+    Also finds structs that are created with new, and structs that are passed
+    to or from JavaScript. */
+static void countAST(struct astNode* node, struct nameUses* uses) {
+    if(node == NULL) return;
+    struct listElem* elem;
+    switch(node->type) {
+    case AST_SYMBOLDEFINE: {
+        struct symbolNode* symbol = (struct symbolNode*)node->data;
+        if(symbol->symbolType == SYMBOL_VARIABLE) {
+            countAST(symbol->code, uses);
+        }
+        return;
+    }
+    case AST_VAR: {
+        struct symbolNode* symbol = symbol_findVar(node);
+        if(symbol != NULL) {
+            uses->ids[symbol->id]++;
+        }
+        return;
+    }
+    case AST_CALL:
+        if(!strstr(node->data, " array")) {
+            struct symbolNode* symbol = symbol_findVar(node);
+            if(symbol == NULL) {
+                symbol = map_get(typeMap, node->data);
+            }
+            if(symbol != NULL) {
+                uses->ids[symbol->id]++;
+            }
+        }
+        break;
+    case AST_DOT: {
+        struct astNode* leftAST = node->children->head.next->next->data;
+        struct symbolNode* dataStruct = typeStruct(leftAST->valueType);
+        if(dataStruct != NULL && !strstr(leftAST->valueType, " array")) {
+            uses->accessed[dataStruct->id] = 1;
+        }
+        countAST(leftAST, uses);
+        addFieldUses(uses->fields, ((struct astNode*)node->children->head.next->data)->data, 1);
+        return;
+    }
+    case AST_NEW: {
+        struct symbolNode* dataStruct = typeStruct(node->valueType);
+        if(dataStruct != NULL && !strstr(node->valueType, " array")) {
+            uses->constructed[dataStruct->id] = 1;
+        }
+    } break;
+    case AST_CAST: {
+        // Records in the heap can be cast back from Any, only casts from JavaScript make structs visible
+        struct astNode* operand = node->children->head.next->data;
+        struct symbolNode* dataStruct = typeStruct(node->valueType);
+        if(dataStruct != NULL && (!options.heap || operand->type == AST_VERBATIM)) {
+            uses->interop[dataStruct->id] = 1;
+        }
+    } break;
+    case AST_VERBATIM:
+        for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+            struct astNode* child = (struct astNode*)elem->data;
+            if(child->type == AST_STRINGLITERAL) {
+                keepVerbatimNames(child->data, uses->kept);
+            } else {
+                struct symbolNode* dataStruct = typeStruct(child->valueType);
+                if(dataStruct != NULL) {
+                    uses->interop[dataStruct->id] = 1;
+                }
+                countAST(child, uses);
+            }
+        }
+        return;
+    default:
+        break;
+    }
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        countAST(elem->data, uses);
+    }
+}
+
+/*
+    Adds to the number of times a field name is written out */
+static void addFieldUses(struct map* fields, char* name, int num) {
+    int* count = (int*)map_get(fields, name);
+    if(count == NULL) {
+        count = (int*)calloc(1, sizeof(int));
+        map_put(fields, name, count);
+    }
+    *count += num;
+}
+
+/*
+    Returns the struct of a type, or the struct of an array type. Returns NULL
+    if the type is not a struct type */
+static struct symbolNode* typeStruct(const char* type) {
+    if(type == NULL) return NULL;
+    char structType[255];
+    strncpy(structType, type, 254);
+    structType[254] = '\0';
+    char* array = strstr(structType, " array");
+    if(array != NULL) {
+        *array = '\0';
+    }
+    struct symbolNode* dataStruct = map_get(typeMap, structType);
+    if(dataStruct == NULL || dataStruct->symbolType != SYMBOL_STRUCT) {
+        return NULL;
+    }
+    return dataStruct;
+}
+
+/*
+    Adds every identifier in the text of a verbatim to a set, so that fields
+    with those names are never renamed */
+static void keepVerbatimNames(char* text, struct map* kept) {
+    while(*text != '\0') {
+        if(isalpha(*text) || *text == '_' || *text == '$') {
+            char* start = text;
+            while(isalnum(*text) || *text == '_' || *text == '$') {
+                text++;
+            }
+            char* name = (char*)calloc(text - start + 1, 1);
+            strncpy(name, start, text - start);
+            set_add(kept, name);
+        } else {
+            text++;
+        }
+    }
+}
+
+/*
+    Orders names by most used first. Ties are broken by id, so that output 
+    does not depend on the sort */
+static int compareRanks(const void* a, const void* b) {
+    const struct nameRank* left = (const struct nameRank*)a;
+    const struct nameRank* right = (const struct nameRank*)b;
+    if(left->uses != right->uses) {
+        return right->uses - left->uses;
+    }
+    return left->id - right->id;
+}
+
+/*
+    Returns the nth short field name: a, b, ..., z, aa, ab, ... */
+static char* shortName(int n) {
+    char buf[8];
+    int i = 7;
+    buf[i] = '\0';
+    for(n++; n > 0; n /= 26) {
+        n--;
+        buf[--i] = 'a' + n % 26;
+    }
+    char* retval = (char*)malloc(8 - i);
+    strcpy(retval, buf + i);
+    return retval;
+}
+
+/*
+    Returns the name a struct field is written out as */
+static char* fieldName(char* name) {
+    if(fieldNames != NULL) {
+        char* shortened = map_get(fieldNames, name);
+        if(shortened != NULL) {
+            return shortened;
+        }
+    }
+    return name;
+}
+
+/*
+    Prints out a base 36 representation of a number to a stream.
+    
+    Used to print out UID's to the output file */ 
+static void fprintb(FILE* out, int num) {
+    char* buf = itoa(idRanks != NULL ? idRanks[num] : num);
+    fprintf(out, "_%s", buf);
+    //free(buf); //@fix why does this causes a "free(): invalid pointer" error
+}
+
+/*
+    Writes out a real number. When minifying, trailing zeros and leading 
+    zeros are left out, so 0.500000 is written as .5 */
+static void generateReal(FILE* out, float num) {
+    char buf[64];
+    snprintf(buf, 64, "%f", num);
+    char* retval = buf;
+    if(options.minify) {
+        int length = strlen(buf);
+        while(buf[length - 1] == '0') {
+            buf[--length] = '\0';
+        }
+        if(buf[length - 1] == '.') {
+            buf[--length] = '\0';
+        }
+        if(buf[0] == '0' && buf[1] == '.') {
+            retval = buf + 1;
+        }
+    }
+    fprintf(out, "%s", retval);
+}
+
+/*
+    Ends a statement. When minifying, the last statement in a block does not 
+    need a semicolon */
+static void generateSemicolon(FILE* out, int isLast) {
+    if(!options.minify || !isLast) {
+        fprintf(out, ";");
+    }
+}
+
+/*
+    Writes a JavaScript version of an enum
+    
+    Representation:
+        enumUID = {field:ordinal, field:ordinal, ...}; */
+static void generateEnum(FILE* out, struct symbolNode* num) {
+    LOG("Generate enum");
+    fprintb(out, num->id);
+    fprintf(out, "={");
+    int ordinal = 0;
+    struct list* nums = num->children->keyList;
+    struct listElem* numElem;
+    for(numElem = list_begin(nums); numElem != list_end(nums); numElem = list_next(numElem)) {
+        fprintf(out, "%s:%d", (char*)numElem->data, ordinal++);
+        if(numElem->next != list_end(nums)){
+            fprintf(out, options.minify ? "," : ", ");
+        }
+    }
+    fprintf(out, "};");
+}
+
+/*
+    Writes a struct in JavaScript to a file. The fields are written as their 
+    ascii names, rather than their UID, to better aid in cross compatibility 
+    with JavaScript classes.
+
+    Every field is given a value of its type in the constructor, in the order
+    the fields are declared, even if it is not passed in. That way every
+    instance of a struct has the same fields in the same order, and holds the
+    same kind of value in each, so engines can give them all one shape. Ints
+    are truncated to whole numbers, other numbers default to 0, booleans to 
+    false, and everything else to null.
+
+    Representation:
+        class structUID { constructor(field, field, ...) {this.int = int|0; this.real = real??0; this.boolean = !!boolean; this.other = other??null; ...} }  */
+static void generateStruct(FILE* out, struct symbolNode* dataStruct) {
+    LOG("Generate struct");
+    if(heapSizes != NULL && heapSizes[dataStruct->id] > 0) {
+        generateHeapStruct(out, dataStruct);
+        return;
+    }
+    fprintf(out, "class ");
+    fprintb(out, dataStruct->id);
+    fprintf(out, options.minify ? "{constructor(" : " {\n\tconstructor(");
+    struct list* fields = dataStruct->children->keyList;
+    struct listElem* fieldElem;
+    for(fieldElem = list_begin(fields); fieldElem != list_end(fields); fieldElem = list_next(fieldElem)) {
+        fprintf(out, "%s", fieldName(fieldElem->data));
+        if(fieldElem->next != list_end(fields)){
+            fprintf(out, options.minify ? "," : ", ");
+        }
+    }
+    fprintf(out, options.minify ? "){" : ") {");
+    for(fieldElem = list_begin(fields); fieldElem != list_end(fields); fieldElem = list_next(fieldElem)) {
+        struct symbolNode* field = (struct symbolNode*)map_get(dataStruct->children, fieldElem->data);
+        struct symbolNode* enumType = map_get(typeMap, field->type);
+        char* name = fieldName(fieldElem->data);
+        if(!strcmp(field->type, "int") || (enumType != NULL && enumType->symbolType == SYMBOL_ENUM)) {
+            fprintf(out, "this.%s=%s|0", name, name);
+        } else if(!strcmp(field->type, "real")) {
+            fprintf(out, "this.%s=%s??0", name, name);
+        } else if(!strcmp(field->type, "boolean")) {
+            fprintf(out, "this.%s=!!%s", name, name);
+        } else {
+            fprintf(out, "this.%s=%s??null", name, name);
+        }
+        generateSemicolon(out, fieldElem->next == list_end(fields));
+    }
+    fprintf(out, options.minify ? "}}" : "}\n}");
+}
+
+/*
+    Writes a variable in Javascript to a file. The semicolon is left for the 
+    caller to write.
+    
+    Representations:
+        let varUID
+        let varUID = varExpr */
+static void generateVariable(FILE* out, struct symbolNode* variable) {
+    LOG("Generate global");
+    if(variable->code != NULL) {
+        fprintf(out, "let ");
+        fprintb(out, variable->id);
+        fprintf(out, "=");
+        generateExpression(out, variable->code);
+    } else {
+        fprintf(out, "let ");
+        fprintb(out, variable->id);
+    }
+}
+
+/*
+    Writes a function in Javascript to a file.
+    
+    Representation:
+        function functionUID(param, param, ...){ ...code... } */
+static void generateFunction(FILE* out, struct symbolNode* function) {
+    LOG("Generate function");
+    range_analyze(function);
+    struct list* loads = split != NULL ? split->loads[function->id] : NULL;
+    if(loads != NULL && !list_isEmpty(loads)) {
+        fprintf(out, "async function ");
+        fprintb(out, function->id);
+        generateParams(out, function);
+        fprintf(out, "{");
+        struct listElem* elem;
+        for(elem = list_begin(loads); elem != list_end(loads); elem = list_next(elem)) {
+            struct symbolNode* module = (struct symbolNode*)elem->data;
+            char* chunkName = chunkFilename(module, 1);
+            fprintf(out, "const $%s=await import(\"%s\");", module->name, chunkName);
+            free(chunkName);
+        }
+        generateProfileEntry(out, function);
+        generateAST(out, 0, function->code);
+        generateProfileExit(out, function);
+        fprintf(out, "}");
+    } else {
+        fprintf(out, "function ");
+        fprintb(out, function->id);
+        generateParams(out, function);
+        generateProfileEntry(out, function);
+        generateAST(out, 0, function->code);
+        generateProfileExit(out, function);
+    }
+}
+
+/*
+    Writes out the parameter list of a function, including parenthesis */
+static void generateParams(FILE* out, struct symbolNode* function) {
+    fprintf(out, "(");
+    struct list* params = function->children->keyList;
+    struct listElem* paramElem;
+    for(paramElem = list_begin(params); paramElem != list_end(params); paramElem = list_next(paramElem)) {
+        if(strstr((char*)paramElem->data, "_block")) {
+            continue;
+        }
+        struct symbolNode* symbol = (struct symbolNode*)map_get(function->children, paramElem->data);
+        ASSERT(symbol != NULL);
+        fprintb(out, symbol->id);
+        if(!(paramElem->next == list_end(params) || strstr((char*)paramElem->next->data, "_block"))){
+            fprintf(out, options.minify ? "," : ", ");
+        }
+    }
+    fprintf(out,")");
+}
+
+/*
+    Gives each function an index in the profile table, in the order that the
+    functions are in */
+static void assignProfileSlots(struct list* functionList) {
+    profileSlots = (int*)calloc(maxID(program) + 1, sizeof(int));
+    profiledFunctions = functionList;
+    int slot = 0;
+    struct listElem* elem;
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem)) {
+        profileSlots[((struct symbolNode*)elem->data)->id] = slot++;
+    }
+}
+
+/*
+    Writes out the profile table that instrumented functions count their calls
+    and time in. Every chunk of a split program shares the same table.
+    
+    Representation:
+        const $p=globalThis.orangeProfile||(globalThis.orangeProfile={names:["Module.function", ...],calls:new Float64Array(n),time:new Float64Array(n),dump(){...}}); */
+static void generateProfileTable(FILE* out) {
+    int numFunctions = profiledFunctions->size;
+    fprintf(out, "const $p=globalThis.orangeProfile||(globalThis.orangeProfile={names:[");
+    struct listElem* elem;
+    for(elem = list_begin(profiledFunctions); elem != list_end(profiledFunctions); elem = list_next(elem)) {
+        char* name = profile_functionName(elem->data);
+        fprintf(out, "\"%s\"%s", name, elem->next != list_end(profiledFunctions) ? "," : "");
+        free(name);
+    }
+    fprintf(out, "],calls:new Float64Array(%d),time:new Float64Array(%d),", numFunctions, numFunctions);
+    fprintf(out, "dump(){const o={};for(let i=0;i<this.names.length;i++)if(this.calls[i])o[this.names[i]]={calls:this.calls[i],time:this.time[i]};return JSON.stringify(o)}});");
+    fprintf(out, "%s", options.minify ? "" : "\n");
+}
+
+/*
+    When instrumenting, starts a function by counting the call and noting the
+    time, and runs its body in a try so that the time is added when it returns.
+    
+    Representation:
+        {const $s=performance.now();$p.calls[slot]++;try{ ...code... }finally{$p.time[slot]+=performance.now()-$s}} */
+static void generateProfileEntry(FILE* out, struct symbolNode* function) {
+    if(options.instrument) {
+        fprintf(out, "{const $s=performance.now();$p.calls[%d]++;try", profileSlots[function->id]);
+    }
+}
+
+static void generateProfileExit(FILE* out, struct symbolNode* function) {
+    if(options.instrument) {
+        fprintf(out, "finally{$p.time[%d]+=performance.now()-$s}}", profileSlots[function->id]);
+    }
+}
+
+/*
+    Writes a function in JavaScript from its IR, rather than from its AST. 
+    SSA values are held in variables named after their value number, and each
+    basic block is a case of a switch statement that is looped over. Functions
+    with only one block leave out the loop and switch.
+    
+    Representation:
+        function functionUID(param, ...){let localUID, $value, ...;let $b=0;for(;;)switch($b){case 0:...}} */
+static void generateFunctionIR(FILE* out, struct irFunction* function) {
+    LOG("Generate function from IR");
+    fprintf(out, "function ");
+    fprintb(out, function->symbol->id);
+    generateParams(out, function->symbol);
+    generateProfileEntry(out, function->symbol);
+
+    // Count uses of each value, values that are never used are not stored
+    int* uses = (int*)calloc(function->numValues + 1, sizeof(int));
+    struct listElem* blockElem;
+    struct listElem* elem;
+    for(blockElem = list_begin(function->blocks); blockElem != list_end(function->blocks); blockElem = list_next(blockElem)) {
+        struct irBlock* block = (struct irBlock*)blockElem->data;
+        for(elem = list_begin(block->instrs); elem != list_end(block->instrs); elem = list_next(elem)) {
+            struct listElem* argElem;
+            struct list* args = ((struct irInstr*)elem->data)->args;
+            for(argElem = list_begin(args); argElem != list_end(args); argElem = list_next(argElem)) {
+                uses[((struct irInstr*)argElem->data)->id]++;
+            }
+        }
+    }
+
+    fprintf(out, "{");
+    int declared = 0;
+    generateLocals(out, function->symbol, &declared);
+    for(blockElem = list_begin(function->blocks); blockElem != list_end(function->blocks); blockElem = list_next(blockElem)) {
+        struct irBlock* block = (struct irBlock*)blockElem->data;
+        for(elem = list_begin(block->instrs); elem != list_end(block->instrs); elem = list_next(elem)) {
+            struct irInstr* instr = (struct irInstr*)elem->data;
+            if(instr->id >= 0 && uses[instr->id] > 0 && !isInlineValue(instr->op)) {
+                fprintf(out, declared++ ? "," : "let ");
+                fprintf(out, "$%d", instr->id);
+            }
+        }
+    }
+    if(declared) {
+        fprintf(out, ";");
+    }
+
+    int single = function->blocks->size == 1;
+    if(!single) {
+        fprintf(out, "let $b=0;for(;;)switch($b){");
+    }
+    for(blockElem = list_begin(function->blocks); blockElem != list_end(function->blocks); blockElem = list_next(blockElem)) {
+        struct irBlock* block = (struct irBlock*)blockElem->data;
+        struct irBlock* next = blockElem->next != list_end(function->blocks) ? blockElem->next->data : NULL;
+        if(!single) {
+            fprintf(out, "case %d:", block->id);
+        }
+        for(elem = list_begin(block->instrs); elem != list_end(block->instrs); elem = list_next(elem)) {
+            generateInstr(out, (struct irInstr*)elem->data, uses, next);
+        }
+    }
+    if(!single) {
+        fprintf(out, "}");
+    }
+    fprintf(out, "}");
+    generateProfileExit(out, function->symbol);
+    free(uses);
+}
+
+/*
+    Declares the local variables of a function, which are the variables of
+    the blocks within the function. Variables of nested functions are left to
+    those functions. */
+static void generateLocals(FILE* out, struct symbolNode* scope, int* declared) {
+    struct listElem* elem;
+    for(elem = list_begin(scope->children->keyList); elem != list_end(scope->children->keyList); elem = list_next(elem)) {
+        struct symbolNode* child = (struct symbolNode*)map_get(scope->children, elem->data);
+        if(child->symbolType == SYMBOL_BLOCK) {
+            generateLocals(out, child, declared);
+        } else if(child->symbolType == SYMBOL_VARIABLE && scope->symbolType == SYMBOL_BLOCK) {
+            fprintf(out, (*declared)++ ? "," : "let ");
+            fprintb(out, child->id);
+        }
+    }
+}
+
+/*
+    Writes out a single IR instruction as a JavaScript statement. The block
+    that is written out after this one is given, so that jumps to it can fall
+    through instead. */
+static void generateInstr(FILE* out, struct irInstr* instr, int* uses, struct irBlock* next) {
+    struct listElem* argElem = list_begin(instr->args);
+    switch(instr->op) {
+    case IR_PHI: // Assigned to by the predecessor blocks
+        break;
+    case IR_STORE:
+        fprintb(out, instr->symbol->id);
+        fprintf(out, "=");
+        generateIRValue(out, argElem->data);
+        fprintf(out, ";");
+        break;
+    case IR_SETFIELD:
+        generateIRValue(out, argElem->data);
+        fprintf(out, ".%s=", fieldName(instr->data));
+        generateIRValue(out, argElem->next->data);
+        fprintf(out, ";");
+        break;
+    case IR_SETINDEX:
+        generateIRValue(out, argElem->data);
+        fprintf(out, "[");
+        generateIRValue(out, argElem->next->data);
+        fprintf(out, "]=");
+        generateIRValue(out, argElem->next->next->data);
+        fprintf(out, ";");
+        break;
+    case IR_JUMP:
+        generatePhiMoves(out, instr->block, instr->targets[0]);
+        if(instr->targets[0] != next) {
+            fprintf(out, "$b=%d;continue;", instr->targets[0]->id);
+        }
+        break;
+    case IR_BRANCH: {
+        struct irInstr* firstTrue = queue_peek(instr->targets[0]->instrs);
+        struct irInstr* firstFalse = queue_peek(instr->targets[1]->instrs);
+        if(firstTrue->op != IR_PHI && firstFalse->op != IR_PHI) {
+            fprintf(out, "$b=");
+            generateIRValue(out, argElem->data);
+            fprintf(out, "?%d:%d;continue;", instr->targets[0]->id, instr->targets[1]->id);
+        } else {
+            fprintf(out, "if(");
+            generateIRValue(out, argElem->data);
+            fprintf(out, "){");
+            generatePhiMoves(out, instr->block, instr->targets[0]);
+            fprintf(out, "$b=%d}else{", instr->targets[0]->id);
+            generatePhiMoves(out, instr->block, instr->targets[1]);
+            fprintf(out, "$b=%d}continue;", instr->targets[1]->id);
+        }
+    } break;
+    case IR_RETURN:
+        if(argElem != list_end(instr->args)) {
+            fprintf(out, "return ");
+            generateIRValue(out, argElem->data);
+            fprintf(out, ";");
+        } else {
+            fprintf(out, "return;");
+        }
+        break;
+    default:
+        if(uses[instr->id] > 0) {
+            if(!isInlineValue(instr->op)) {
+                fprintf(out, "$%d=", instr->id);
+                generateIRExpression(out, instr);
+                fprintf(out, ";");
+            }
+        } else if(instr->op == IR_CALL || instr->op == IR_VERBATIM || instr->op == IR_NEWSTRUCT) { // Unused, but may have side effects
+            generateIRExpression(out, instr);
+            fprintf(out, ";");
+        }
+        break;
+    }
+}
+
+/*
+    Assigns the incoming values of the phis in a block, for a jump from a 
+    given predecessor block */
+static void generatePhiMoves(FILE* out, struct irBlock* from, struct irBlock* to) {
+    struct listElem* elem;
+    for(elem = list_begin(to->instrs); elem != list_end(to->instrs); elem = list_next(elem)) {
+        struct irInstr* phi = (struct irInstr*)elem->data;
+        if(phi->op != IR_PHI) {
+            break;
+        }
+        struct listElem* argElem;
+        struct listElem* blockElem;
+        for(argElem = list_begin(phi->args), blockElem = list_begin(phi->phiBlocks); 
+            argElem != list_end(phi->args); 
+            argElem = list_next(argElem), blockElem = list_next(blockElem)) {
+            if(blockElem->data == from) {
+                fprintf(out, "$%d=", phi->id);
+                generateIRValue(out, argElem->data);
+                fprintf(out, ";");
+            }
+        }
+    }
+}
+
+/*
+    Writes out a reference to an IR value. Constants are written out in place,
+    everything else is read from the variable it was stored in. */
+static void generateIRValue(FILE* out, struct irInstr* instr) {
+    if(isInlineValue(instr->op)) {
+        generateIRExpression(out, instr);
+    } else {
+        fprintf(out, "$%d", instr->id);
+    }
+}
+
+/*
+    Writes out the JavaScript expression that computes an IR value */
+static void generateIRExpression(FILE* out, struct irInstr* instr) {
+    struct listElem* elem;
+    switch(instr->op) {
+    case IR_INT:
+        fprintf(out, "%d", *(int*)instr->data);
+        break;
+    case IR_REAL:
+        generateReal(out, *(float*)instr->data);
+        break;
+    case IR_CHAR:
+        fprintf(out, "'%s'", (char*)instr->data);
+        break;
+    case IR_STRING:
+        fprintf(out, "\"%s\"", (char*)instr->data);
+        break;
+    case IR_BOOLEAN:
+        fprintf(out, "%s", (char*)instr->data);
+        break;
+    case IR_NULL:
+        fprintf(out, "null");
+        break;
+    case IR_UNDEFINED:
+        fprintf(out, "undefined");
+        break;
+    case IR_SYMBOL:
+    case IR_LOAD:
+        fprintb(out, instr->symbol->id);
+        break;
+    case IR_ADD:
+    case IR_SUBTRACT:
+    case IR_MULTIPLY:
+    case IR_DIVIDE:
+    case IR_IS:
+    case IR_ISNT:
+    case IR_GREATER:
+    case IR_LESSER:
+    case IR_GREATEREQUAL:
+    case IR_LESSEREQUAL: {
+        // Ranges are not worked out for IR, so int arithmetic is always coerced
+        static const char* operators[] = {"+", "-", "*", "/", "==", "!=", ">", "<", ">=", "<="};
+        int isInt = instr->op <= IR_DIVIDE && instr->type != NULL && !strcmp(instr->type, "int");
+        fprintf(out, isInt ? (instr->op == IR_MULTIPLY ? "Math.imul(" : "(") : "");
+        generateIRValue(out, instr->args->head.next->data);
+        fprintf(out, "%s", isInt && instr->op == IR_MULTIPLY ? "," : operators[instr->op - IR_ADD]);
+        generateIRValue(out, instr->args->head.next->next->data);
+        fprintf(out, isInt ? (instr->op == IR_MULTIPLY ? ")" : "|0)") : "");
+    } break;
+    case IR_CAST: {
+        struct irInstr* operand = instr->args->head.next->data;
+        int toInt = !strcmp(instr->type, "int") && operand->type != NULL && !strcmp(operand->type, "real");
+        fprintf(out, toInt ? "(" : "");
+        generateIRValue(out, operand);
+        fprintf(out, toInt ? "|0)" : "");
+    } break;
+    case IR_NEWARRAY:
+        fprintf(out, "new Array(");
+        generateIRValue(out, instr->args->head.next->data);
+        fprintf(out, ")");
+        break;
+    case IR_ARRAYLITERAL:
+    case IR_NEWSTRUCT:
+    case IR_CALL:
+        if(instr->op == IR_ARRAYLITERAL) {
+            fprintf(out, "[");
+        } else {
+            fprintf(out, instr->op == IR_NEWSTRUCT ? "new " : "");
+            fprintb(out, instr->symbol->id);
+            fprintf(out, "(");
+        }
+        for(elem = list_begin(instr->args); elem != list_end(instr->args); elem = list_next(elem)) {
+            generateIRValue(out, elem->data);
+            if(elem->next != list_end(instr->args)) {
+                fprintf(out, options.minify ? "," : ", ");
+            }
+        }
+        fprintf(out, instr->op == IR_ARRAYLITERAL ? "]" : ")");
+        break;
+    case IR_VERBATIM: {
+        struct listElem* argElem = list_begin(instr->args);
+        for(elem = list_begin(instr->data); elem != list_end(instr->data); elem = list_next(elem)) {
+            if(elem->data != NULL) {
+                fprintf(out, "%s", (char*)elem->data);
+            } else {
+                generateIRValue(out, argElem->data);
+                argElem = list_next(argElem);
+            }
+        }
+    } break;
+    case IR_GETFIELD:
+        generateIRValue(out, instr->args->head.next->data);
+        fprintf(out, ".%s", fieldName(instr->data));
+        break;
+    case IR_GETINDEX:
+        generateIRValue(out, instr->args->head.next->data);
+        fprintf(out, "[");
+        generateIRValue(out, instr->args->head.next->next->data);
+        fprintf(out, "]");
+        break;
+    default:
+        PANIC("IR %s does not have a value", ir_toString(instr->op));
+    }
+}
+
+/*
+    Returns whether or not values of an IR operation are cheap and constant
+    enough to be written out everywhere they are used */
+static int isInlineValue(enum irOp op) {
+    return op == IR_INT || op == IR_REAL || op == IR_CHAR || op == IR_STRING || 
+        op == IR_BOOLEAN || op == IR_NULL || op == IR_UNDEFINED || op == IR_SYMBOL;
+}
+
+/*
+    Writes out an AST in Javascript to a file. Statements that are the last in
+    their block may leave out their semicolon. */
+static void generateAST(FILE* out, int isLast, struct astNode* node) {
+    LOG("Generate AST %s", ast_toString(node->type));
+    if(node == NULL) return;
+
+    switch(node->type) {
+    case AST_BLOCK:
+        generateBlock(out, node, NULL);
+        break;
+    case AST_SYMBOLDEFINE: {
+        struct symbolNode* symbol = (struct symbolNode*) node->data;
+        if(symbol->symbolType == SYMBOL_VARIABLE) { // Don't write to functions, structs, or enums. They are written elsewhere
+            generateVariable(out, node->data);
+            generateSemicolon(out, isLast);
+        }
+    } break;
+    case AST_IF:
+        fprintf(out, "if(");
+        generateExpression(out, node->children->head.next->data);
+        fprintf(out, ")");
+        range_enter(node, 0);
+        generateAST(out, 0, node->children->head.next->next->data);
+        range_leave();
+        break;
+    case AST_IFELSE:
+        fprintf(out, "if(");
+        generateExpression(out, node->children->head.next->data);
+        fprintf(out, ")");
+        range_enter(node, 0);
+        generateAST(out, 0, node->children->head.next->next->data);
+        range_leave();
+        fprintf(out, "else");
+        range_enter(node, 1);
+        generateAST(out, 0, node->children->head.next->next->next->data);
+        range_leave();
+        break;
+    case AST_WHILE:
+        fprintf(out, "while(");
+        generateExpression(out, node->children->head.next->data);
+        fprintf(out, ")");
+        range_enter(node, 0);
+        generateAST(out, 0, node->children->head.next->next->data);
+        range_leave();
+        break;
+    case AST_PARALLEL:
+        generateParallelLoop(out, isLast, node);
+        break;
+    case AST_RETURN:
+        fprintf(out, "return ");
+        generateExpression(out, node->children->head.next->data);
+        generateSemicolon(out, isLast);
+        break;
+    default:
+        generateExpression(out, node);
+        generateSemicolon(out, isLast);
+        break;
+    }
+}
+
+/*
+    Writes out the statements of a block, in braces, leaving out the statement
+    skip if it is not NULL. While loops that count up are written as counted
+    loops. */
+static void generateBlock(FILE* out, struct astNode* block, struct astNode* skip) {
+    fprintf(out, "{");
+    struct astNode* last = list_isEmpty(block->children) ? NULL : block->children->tail.prev->data;
+    if(last == skip && block->children->size > 1) {
+        last = block->children->tail.prev->prev->data;
+    }
+    struct astNode* before = NULL;
+    struct listElem* elem;
+    for(elem = list_begin(block->children); elem != list_end(block->children); elem = list_next(elem)) {
+        struct astNode* statement = elem->data;
+        struct countedLoop counted;
+        if(statement == skip) {
+            continue;
+        } else if(statement->type == AST_WHILE && findCountedLoop(before, statement, &counted)) {
+            generateCountedLoop(out, statement == last, &counted);
+        } else {
+            generateAST(out, statement == last, statement);
+        }
+        before = statement;
+    }
+    fprintf(out, "}");
+}
+
+/*
+    Checks whether a while loop counts an int up by one each time around, and
+    fills in what is known about it if it does. The statement before the loop
+    is looked at to find where the counter starts, and may be NULL. */
+static int findCountedLoop(struct astNode* before, struct astNode* loop, struct countedLoop* counted) {
+    struct astNode* condition = loop->children->head.next->data;
+    struct astNode* body = loop->children->head.next->next->data;
+    if((condition->type != AST_LESSER && condition->type != AST_LESSEREQUAL) || list_isEmpty(body->children)) {
+        return 0;
+    }
+    struct astNode* counterAST = condition->children->head.next->next->data;
+    if(counterAST->type != AST_VAR || counterAST->valueType == NULL || strcmp(counterAST->valueType, "int")) {
+        return 0;
+    }
+    struct symbolNode* counter = symbol_findVar(counterAST);
+    if(counter == NULL || counter->symbolType != SYMBOL_VARIABLE) {
+        return 0;
+    }
+
+    // Last statement must be counter = counter + 1, or counter = 1 + counter
+    struct astNode* increment = body->children->tail.prev->data;
+    if(increment->type != AST_ASSIGN || !isVarOf(increment->children->head.next->next->data, counter)) {
+        return 0;
+    }
+    struct astNode* sum = increment->children->head.next->data;
+    if(sum->type != AST_ADD) {
+        return 0;
+    }
+    struct astNode* right = sum->children->head.next->data;
+    struct astNode* left = sum->children->head.next->next->data;
+    struct astNode* one = isVarOf(left, counter) ? right : isVarOf(right, counter) ? left : NULL;
+    if(one == NULL || one->type != AST_INTLITERAL || *(int*)one->data != 1) {
+        return 0;
+    }
+
+    counted->loop = loop;
+    counted->counter = counter;
+    counted->start = NULL;
+    counted->end = condition->children->head.next->data;
+    counted->inclusive = condition->type == AST_LESSEREQUAL;
+    counted->increment = increment;
+    if(before != NULL && before->type == AST_SYMBOLDEFINE && before->data == counter) {
+        counted->start = counter->code;
+    } else if(before != NULL && before->type == AST_ASSIGN && isVarOf(before->children->head.next->next->data, counter)) {
+        counted->start = before->children->head.next->data;
+    }
+    return 1;
+}
+
+/*
+    Writes out a counted loop. Loops that only set each element of an array to
+    the same value are written as a fill, and short loops with known start and
+    end are unrolled. Otherwise, the loop is written as a for loop, with the
+    increment taken out of the body and put in the loop header:
+
+        for(;i<end;i++){...} */
+static void generateCountedLoop(FILE* out, int isLast, struct countedLoop* counted) {
+    if(generateUnrolled(out, isLast, counted)) {
+        return;
+    }
+    struct astNode* body = counted->loop->children->head.next->next->data;
+    generateFill(out, counted);
+    fprintf(out, "for(;");
+    generateExpression(out, counted->loop->children->head.next->data);
+    fprintf(out, ";");
+    generateExpression(out, counted->increment->children->head.next->next->data);
+    fprintf(out, "++)");
+    range_enter(counted->loop, 0);
+    generateBlock(out, body, counted->increment);
+    range_leave();
+}
+
+/*
+    Writes out a fill for loops that set each element of an array to the same
+    value, and nothing else:
+
+        while i < end {
+            array[i] = value;
+            i = i + 1;
+        }
+
+    The fill is only used when the loop sets elements that are already in the
+    array, from a start that is not negative, since fill does not make arrays
+    longer and counts negative indices from the end. It skips the loop that
+    follows it by setting the counter to the end:
+
+        if(0<=i&&i<end&&end<=array.length){array.fill(value,i,end);i=end}
+
+    The checks on i are left out when the start and end are known. Ends that
+    are not ints are left to the loop, since fill would cut them down to the 
+    int below them, and the counter would be set to a real. */
+static void generateFill(FILE* out, struct countedLoop* counted) {
+    struct astNode* body = counted->loop->children->head.next->next->data;
+    if(body->children->size != 2 || !isPure(counted->end) || counted->end->valueType == NULL || strcmp(counted->end->valueType, "int")) {
+        return;
+    }
+    struct astNode* assign = body->children->head.next->data;
+    if(assign->type != AST_ASSIGN) {
+        return;
+    }
+    struct astNode* value = assign->children->head.next->data;
+    struct astNode* element = assign->children->head.next->next->data;
+    if(element->type != AST_INDEX || !isVarOf(element->children->head.next->data, counted->counter)) {
+        return;
+    }
+    struct astNode* array = element->children->head.next->next->data;
+    int length = array->valueType == NULL ? 0 : strlen(array->valueType);
+    if(array->type != AST_VAR || isVarOf(array, counted->counter) || length < 6 || 
+            strcmp(array->valueType + length - 6, " array") || !strcmp(array->valueType, "char array")) {
+        return;
+    }
+    if(!isPure(value) || isVarOf(value, counted->counter)) {
+        return;
+    }
+
+    struct astNode* counter = counted->increment->children->head.next->next->data;
+    int known = counted->start != NULL && counted->start->type == AST_INTLITERAL && counted->end->type == AST_INTLITERAL &&
+        *(int*)counted->start->data >= 0 && *(int*)counted->start->data < *(int*)counted->end->data + counted->inclusive;
+    fprintf(out, "if(");
+    if(!known) {
+        fprintf(out, "0<=");
+        generateExpression(out, counter);
+        fprintf(out, "&&");
+        generateExpression(out, counter);
+        fprintf(out, "<");
+        generateEnd(out, counted);
+        fprintf(out, "&&");
+    }
+    generateEnd(out, counted);
+    fprintf(out, "<=");
+    generateExpression(out, array);
+    fprintf(out, ".length){");
+    generateExpression(out, array);
+    fprintf(out, ".fill(");
+    generateExpression(out, value);
+    fprintf(out, ",");
+    generateExpression(out, counter);
+    fprintf(out, ",");
+    generateEnd(out, counted);
+    fprintf(out, ");");
+    generateExpression(out, counter);
+    fprintf(out, "=");
+    generateEnd(out, counted);
+    fprintf(out, "}");
+}
+
+/*
+    Writes out the body of a loop once for each time around, for loops with a
+    known start and end that go around only a few times. The counter is still 
+    counted up after each copy of the body, so the body and any code after the
+    loop see it as they would have. Loops are not unrolled if anything else
+    in them could change the counter, or if functions are defined in them.
+    Gives whether the loop was unrolled. */
+static int generateUnrolled(FILE* out, int isLast, struct countedLoop* counted) {
+    if(counted->start == NULL || counted->start->type != AST_INTLITERAL || counted->end->type != AST_INTLITERAL) {
+        return 0;
+    }
+    int trips = *(int*)counted->end->data - *(int*)counted->start->data + counted->inclusive;
+    struct astNode* body = counted->loop->children->head.next->next->data;
+    if(trips < 1 || trips > UNROLL_MAX_TRIPS || countLoopNodes(body) * trips > UNROLL_MAX_NODES) {
+        return 0;
+    }
+    struct symbolNode* function = counted->counter->parent;
+    while(function->symbolType == SYMBOL_BLOCK) {
+        function = function->parent;
+    }
+    if(function->symbolType != SYMBOL_FUNCTION || assignsTo(body, counted->counter, counted->increment) ||
+            assignedByClosure(function->code, counted->counter)) {
+        return 0;
+    }
+
+    struct astNode* counter = counted->increment->children->head.next->next->data;
+    range_enter(counted->loop, 0);
+    for(int i = 0; i < trips; i++) {
+        generateBlock(out, body, counted->increment);
+        generateExpression(out, counter);
+        fprintf(out, "++");
+        generateSemicolon(out, isLast && i == trips - 1);
+    }
+    range_leave();
+    return 1;
+}
+
+/*
+    Writes the first value a counted loop does not reach */
+static void generateEnd(FILE* out, struct countedLoop* counted) {
+    if(counted->inclusive && counted->end->type == AST_INTLITERAL) {
+        fprintf(out, "%d", *(int*)counted->end->data + 1);
+    } else {
+        generateExpression(out, counted->end);
+        if(counted->inclusive) {
+            fprintf(out, "+1");
+        }
+    }
+}
+
+/*
+    Whether an AST is a variable that refers to the given symbol */
+static int isVarOf(struct astNode* node, struct symbolNode* symbol) {
+    return node->type == AST_VAR && symbol_findVar(node) == symbol;
+}
+
+/*
+    Whether an expression can be written out more than once, or once rather 
+    than many times, without changing what it does. Literals, variables, and 
+    fields of variables are. */
+static int isPure(struct astNode* node) {
+    switch(node->type) {
+    case AST_INTLITERAL:
+    case AST_REALLITERAL:
+    case AST_CHARLITERAL:
+    case AST_STRINGLITERAL:
+    case AST_TRUE:
+    case AST_FALSE:
+    case AST_NULL:
+    case AST_VAR:
+        return 1;
+    case AST_DOT:
+        return ((struct astNode*)node->children->head.next->next->data)->type == AST_VAR;
+    default:
+        return 0;
+    }
+}
+
+/*
+    Whether an AST assigns to a variable anywhere in it, other than in the 
+    statement except. Functions and variables defined in the AST are looked 
+    in as well. */
+static int assignsTo(struct astNode* node, struct symbolNode* symbol, struct astNode* except) {
+    if(node == NULL) {
+        return 0;
+    } else if(node->type == AST_ASSIGN && node != except && isVarOf(node->children->head.next->next->data, symbol)) {
+        return 1;
+    } else if(node->type == AST_SYMBOLDEFINE) {
+        return assignsTo(((struct symbolNode*)node->data)->code, symbol, except);
+    }
+    struct listElem* elem;
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        if(assignsTo(elem->data, symbol, except)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+    Whether any function defined in an AST assigns to a variable. Such a 
+    function could be called while a loop that counts with the variable runs. */
+static int assignedByClosure(struct astNode* node, struct symbolNode* symbol) {
+    if(node == NULL) {
+        return 0;
+    } else if(node->type == AST_SYMBOLDEFINE) {
+        struct symbolNode* defined = node->data;
+        return defined->symbolType == SYMBOL_FUNCTION && assignsTo(defined->code, symbol, NULL);
+    }
+    struct listElem* elem;
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        if(assignedByClosure(elem->data, symbol)) {
+            return 1;
         }
     }
-    fprintf(out, "};");
+    return 0;
 }
 
 /*
-    Writes a struct in JavaScript to a file. The fields are written as their 
-    ascii names, rather than their UID, to better aid in cross compatibility 
-    with JavaScript classes.
-
-    Representation:
-        class structUID { constructor(field, field, ...) {this.field = field; this.field = field; ...} }  */
-static void generateStruct(FILE* out, struct symbolNode* dataStruct) {
-    LOG("Generate struct");
-    fprintf(out, "class ");
-    fprintb(out, dataStruct->id);
-    fprintf(out, " {\n\tconstructor(");
-    struct list* fields = dataStruct->children->keyList;
-    struct listElem* fieldElem;
-    for(fieldElem = list_begin(fields); fieldElem != list_end(fields); fieldElem = list_next(fieldElem)) {
-        fprintf(out, "%s", (char*)fieldElem->data);
-        if(fieldElem->next != list_end(fields)){
-            fprintf(out, ", ");
-        }
+    Counts the nodes in the body of a loop. Bodies that define functions are
+    counted as too big to unroll, since each copy would define them again. */
+static int countLoopNodes(struct astNode* node) {
+    if(node == NULL) {
+        return 0;
+    } else if(node->type == AST_SYMBOLDEFINE) {
+        struct symbolNode* defined = node->data;
+        return defined->symbolType == SYMBOL_VARIABLE ? 1 + countLoopNodes(defined->code) : UNROLL_MAX_NODES + 1;
     }
-    fprintf(out,") {");
-    for(fieldElem = list_begin(fields); fieldElem != list_end(fields); fieldElem = list_next(fieldElem)) {
-        fprintf(out, "this.%s=%s;", (char*)fieldElem->data, (char*)fieldElem->data);
-        
+    int count = 1;
+    struct listElem* elem;
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        count += countLoopNodes(elem->data);
     }
-    fprintf(out, "}\n}");
+    return count;
 }
 
 /*
-    Writes a variable in Javascript to a file.
-    
-    Representations:
-        let varUID; 
-        let varUID = varExpr; */
-static void generateVariable(FILE* out, struct symbolNode* variable) {
-    LOG("Generate global");
-    if(variable->code != NULL) {
-        fprintf(out, "let ");
-        fprintb(out, variable->id);
-        fprintf(out, "=");
-        generateExpression(out, variable->code);
-        fprintf(out, ";");
-    } else {
-        fprintf(out, "let ");
-        fprintb(out, variable->id);
-        fprintf(out, ";");
+    Writes a parallel loop as a call to $parallel. The body is written as a
+    function of the range of trips to run, followed by the values the body 
+    uses from outside of it. The values are passed in, rather than closed 
+    over, so that the function can be sent to workers as text. The function
+    is also what runs the loop on this thread, when it is not split up.
+
+    Representation:
+        $parallel(function($lo,$hi,value,...){for(let counter=$lo;counter<$hi;counter++){ ...code... }},counter,end,[value,...]); */
+static void generateParallelLoop(FILE* out, int isLast, struct astNode* loop) {
+    struct astNode* condition = loop->children->head.next->data;
+    struct astNode* counterAST = condition->children->head.next->next->data;
+    struct symbolNode* counter = symbol_findVar(counterAST);
+    struct astNode* body = loop->children->head.next->next->data;
+    struct list* captures = list_create();
+    findCaptures(body, body->data, counter, captures);
+
+    struct listElem* elem;
+    fprintf(out, "$parallel(function($lo,$hi");
+    for(elem = list_begin(captures); elem != list_end(captures); elem = list_next(elem)) {
+        fprintf(out, ",");
+        fprintb(out, ((struct symbolNode*)elem->data)->id);
     }
+    fprintf(out, "){for(let ");
+    fprintb(out, counter->id);
+    fprintf(out, "=$lo;");
+    fprintb(out, counter->id);
+    fprintf(out, "<$hi;");
+    fprintb(out, counter->id);
+    fprintf(out, "++)");
+    range_enter(loop, 0);
+    generateBlock(out, body, body->children->tail.prev->data);
+    range_leave();
+    fprintf(out, "},");
+    fprintb(out, counter->id);
+    fprintf(out, ",");
+    generateExpression(out, condition->children->head.next->data);
+    fprintf(out, ",[");
+    for(elem = list_begin(captures); elem != list_end(captures); elem = list_next(elem)) {
+        fprintb(out, ((struct symbolNode*)elem->data)->id);
+        fprintf(out, "%s", elem->next != list_end(captures) ? "," : "");
+    }
+    fprintf(out, "])");
+    generateSemicolon(out, isLast);
+    list_destroy(captures);
 }
 
 /*
-    Writes a function in Javascript to a file.
-    
-    Representation:
-        function functionUID(param, param, ...){ ...code... } */
-static void generateFunction(FILE* out, struct symbolNode* function) {
-    LOG("Generate function");
-    fprintf(out, "function ");
-    fprintb(out, function->id);
-    fprintf(out, "(");
-    struct list* params = function->children->keyList;
-    struct listElem* paramElem;
-    for(paramElem = list_begin(params); paramElem != list_end(params); paramElem = list_next(paramElem)) {
-        if(strstr((char*)paramElem->data, "_block")) {
-            continue;
+    Finds the variables used in the body of a parallel loop that are defined
+    outside of it, other than the loop's counter */
+static void findCaptures(struct astNode* node, struct symbolNode* body, struct symbolNode* counter, struct list* captures) {
+    if(node->type == AST_VAR) {
+        struct symbolNode* var = symbol_findVar(node);
+        struct symbolNode* scope = var;
+        while(scope != NULL && scope != body) {
+            scope = scope->parent;
         }
-        struct symbolNode* symbol = (struct symbolNode*)map_get(function->children, paramElem->data);
-        ASSERT(symbol != NULL);
-        fprintb(out, symbol->id);
-        if(!(paramElem->next == list_end(params) || strstr((char*)paramElem->next->data, "_block"))){
-            fprintf(out, ", ");
+        if(var != NULL && var->symbolType == SYMBOL_VARIABLE && var != counter && scope == NULL) {
+            addUnique(captures, var);
         }
+        return;
+    } else if(node->type == AST_DOT) { // the field is not a variable
+        findCaptures(node->children->head.next->next->data, body, counter, captures);
+        return;
+    } else if(node->type == AST_SYMBOLDEFINE && ((struct symbolNode*)node->data)->code != NULL) {
+        findCaptures(((struct symbolNode*)node->data)->code, body, counter, captures);
+    }
+    struct listElem* elem;
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        findCaptures(elem->data, body, counter, captures);
     }
-    fprintf(out,")");
-    generateAST(out, 0, function->code);
 }
 
 /*
-    Writes out an AST in Javascript to a file. */
-static void generateAST(FILE* out, int tabs, struct astNode* node) {
-    LOG("Generate AST %s", ast_toString(node->type));
-    if(node == NULL) return;
-
-    switch(node->type) {
-    case AST_BLOCK: {
-        fprintf(out, "{");
-        struct listElem* elem;
-        for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
-            generateAST(out, tabs + 1, (struct astNode*)elem->data);
-        }
-        fprintf(out, "}");
-        break;
-    }
-    case AST_SYMBOLDEFINE: {
-        struct symbolNode* symbol = (struct symbolNode*) node->data;
-        if(symbol->symbolType == SYMBOL_VARIABLE) { // Don't write to functions, structs, or enums. They are written elsewhere
-            generateVariable(out, node->data);
+    Returns whether any of the functions in a list has a parallel loop in it.
+    The parser marks the functions it finds parallel loops in, so that their
+    code does not have to be gone over again. */
+static int hasParallelLoops(struct list* functionList) {
+    struct listElem* elem;
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem)) {
+        if(((struct symbolNode*)elem->data)->hasParallelLoop) {
+            return 1;
         }
-    } break;
-    case AST_IF:
-        fprintf(out, "if(");
-        generateExpression(out, node->children->head.next->data);
-        fprintf(out, ")");
-        generateAST(out, tabs, node->children->head.next->next->data);
-        break;
-    case AST_IFELSE:
-        fprintf(out, "if(");
-        generateExpression(out, node->children->head.next->data);
-        fprintf(out, ")");
-        generateAST(out, tabs, node->children->head.next->next->data);
-        fprintf(out, "else");
-        generateAST(out, tabs, node->children->head.next->next->next->data);
-        break;
-    case AST_WHILE:
-        fprintf(out, "while(");
-        generateExpression(out, node->children->head.next->data);
-        fprintf(out, ")");
-        generateAST(out, tabs, node->children->head.next->next->data);
-        break;
-    case AST_RETURN:
-        fprintf(out, "return ");
-        generateExpression(out, node->children->head.next->data);
-        fprintf(out, ";");
-        break;
-    default:
-        generateExpression(out, node);
-        fprintf(out, ";");
-        break;
     }
+    return 0;
+}
+
+/*
+    Writes out the pool of workers that parallel loops are split up between.
+    
+    The trips of a loop are cut into chunks, about eight for each thread. A
+    counter in a SharedArrayBuffer hands out the chunks, so threads that get 
+    through their chunks sooner take more of them. This thread takes chunks
+    too, and then waits for each worker to say it has run out. Workers keep
+    the body of each loop they are sent, so the text is only compiled once.
+
+    Loops are run on this thread alone when there are no workers, and when
+    the body uses values that cannot be shared: anything but numbers, 
+    booleans, strings, and typed arrays over a SharedArrayBuffer. Browsers do 
+    not let their main thread wait, so loops only use workers there when the
+    program itself runs in a worker. Workers are made the first time they are
+    needed, one less than the number of cores, or globalThis.orangeWorkers.
+
+    Representation:
+        const $pool={workers:null};
+        function $parallel(body,start,end,values){ ... }
+        function $run(body,message){ ... }
+        function $shareable(value){ ... }
+        function $workers(){ ... } */
+static void generateWorkerPool(FILE* out) {
+    const char* newline = options.minify ? "" : "\n";
+    fprintf(out, "const $pool={workers:null};%s", newline);
+    fprintf(out, "function $parallel(body,start,end,args){const w=end-start>1&&args.every($shareable)?$workers():null;if(w===null){if(start<end)body(start,end,...args);return}");
+    fprintf(out, "const chunk=Math.max(1,Math.ceil((end-start)/(w.length+1)/8));");
+    fprintf(out, "const m={body:body.toString(),state:new Int32Array(new SharedArrayBuffer(8)),start,end,chunk,chunks:Math.ceil((end-start)/chunk),args};");
+    fprintf(out, "for(const x of w)x.postMessage(m);$run(body,m);for(let d;(d=Atomics.load(m.state,1))<w.length;)Atomics.wait(m.state,1,d)}%s", newline);
+    fprintf(out, "function $run(body,m){for(let k;(k=Atomics.add(m.state,0,1))<m.chunks;){const lo=m.start+k*m.chunk;body(lo,Math.min(lo+m.chunk,m.end),...m.args)}}%s", newline);
+    fprintf(out, "function $shareable(v){return typeof v===\"number\"||typeof v===\"boolean\"||typeof v===\"string\"||ArrayBuffer.isView(v)&&typeof SharedArrayBuffer!==\"undefined\"&&v.buffer instanceof SharedArrayBuffer}%s", newline);
+    fprintf(out, "function $workers(){if($pool.workers===null){$pool.workers=[];");
+    fprintf(out, "const node=typeof require===\"function\"&&typeof process!==\"undefined\"?require(\"worker_threads\"):null;");
+    fprintf(out, "if(typeof SharedArrayBuffer===\"undefined\"||node===null&&typeof WorkerGlobalScope===\"undefined\")return null;");
+    fprintf(out, "const os=node!==null?require(\"os\"):null;");
+    fprintf(out, "const n=globalThis.orangeWorkers?\?(os!==null?(os.availableParallelism?os.availableParallelism():os.cpus().length):navigator.hardwareConcurrency)-1;");
+    fprintf(out, "const src=\"const $b=new Map();\"+$run+\"function $on(m){let b=$b.get(m.body);if(b===undefined){b=(0,eval)('('+m.body+')');$b.set(m.body,b)}$run(b,m);Atomics.add(m.state,1,1);Atomics.notify(m.state,1)}\"");
+    fprintf(out, "+(node!==null?\"require('worker_threads').parentPort.on('message',$on)\":\"onmessage=e=>$on(e.data)\");");
+    fprintf(out, "for(let i=0;i<n;i++){const x=node!==null?new node.Worker(src,{eval:true}):new Worker(URL.createObjectURL(new Blob([src])));if(node!==null)x.unref();$pool.workers.push(x)}}");
+    fprintf(out, "return $pool.workers.length>0?$pool.workers:null}%s", newline);
 }
 
 /*
@@ -269,18 +2224,31 @@ static void generateExpression(FILE* out, struct astNode* node) {
     if(node == NULL) return;
     switch(node->type){
     case AST_VAR: {
-        struct symbolNode* symbol = symbol_find(node->data, node->scope);
-        if(symbol == NULL) {
+        struct symbolNode* symbol = symbol_findVar(node);
+        if(inlining != NULL && symbol != NULL && symbol->parent == inlining->function) {
+            // Parameter of a function being inlined, write the argument given instead
+            struct inlineCall* call = inlining;
+            int i = 0;
+            struct listElem* elem;
+            for(elem = list_begin(call->function->children->keyList); strcmp(elem->data, symbol->name); elem = list_next(elem)) {
+                i++;
+            }
+            inlining = NULL;
+            fprintf(out, "(");
+            generateExpression(out, call->args[i]);
+            fprintf(out, ")");
+            inlining = call;
+        } else if(symbol == NULL) {
             fprintf(out, "%s", (char*)node->data);
         } else {
-            fprintb(out, symbol->id);
+            generateReference(out, symbol, node);
         }
     } break;
     case AST_INTLITERAL:
         fprintf(out, "%d", *(int*)node->data);
         break;
     case AST_REALLITERAL:
-        fprintf(out, "%f", *(float*)node->data);
+        generateReal(out, *(float*)node->data);
         break;
     case AST_CHARLITERAL:
         fprintf(out, "'%s'", (char*)node->data);
@@ -298,19 +2266,24 @@ static void generateExpression(FILE* out, struct astNode* node) {
             fprintf(out, "Array(");
         } else {
             LOG("%s", (char*)node->data);
-            struct symbolNode* symbol = symbol_find(node->data, node->scope);
+            struct symbolNode* symbol = symbol_findVar(node);
             if(symbol == NULL) {
                 symbol = map_get(typeMap, node->data);
             }
             ASSERT(symbol != NULL);
-            fprintb(out, symbol->id);
+            struct astNode* inlined = inlineExpression(node, symbol);
+            if(inlined != NULL) {
+                generateInline(out, node, symbol, inlined);
+                break;
+            }
+            generateReference(out, symbol, node);
             fprintf(out, "(");
         }
         struct listElem* elem;
         for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
             generateExpression(out, (struct astNode*)elem->data);
             if(elem->next != list_end(node->children)){
-                fprintf(out, ", ");
+                fprintf(out, options.minify ? "," : ", ");
             }
         }
         fprintf(out, ")");
@@ -331,6 +2304,10 @@ static void generateExpression(FILE* out, struct astNode* node) {
     case AST_SUBTRACT:
     case AST_MULTIPLY:
     case AST_DIVIDE:
+        if(!strcmp(node->valueType, "int") && !range_fits(node)) {
+            generateIntArithmetic(out, node);
+            break;
+        } // otherwise written like any other operator
     case AST_ASSIGN:
     case AST_IS:
     case AST_ISNT:
@@ -339,12 +2316,24 @@ static void generateExpression(FILE* out, struct astNode* node) {
     case AST_GREATEREQUAL:
     case AST_LESSEREQUAL:
     case AST_AND:
-    case AST_OR:
-        generateExpression(out, node->children->head.next->next->data);
+    case AST_OR: {
+        struct astNode* leftAST = node->children->head.next->next->data;
+        if(node->type == AST_ASSIGN && leftAST->type == AST_DOT && heapStruct(((struct astNode*)leftAST->children->head.next->next->data)->valueType) != NULL) {
+            generateHeapField(out, leftAST, 1);
+        } else {
+            generateExpression(out, leftAST);
+        }
         fprintf(out, "%s", (char*)node->data);
         generateExpression(out, node->children->head.next->data);
-        break;
+    } break;
     case AST_CAST: {
+        struct astNode* operand = node->children->head.next->data;
+        if(!strcmp(node->data, "int") && !strcmp(operand->valueType, "real")) {
+            fprintf(out, "(");
+            generateExpression(out, operand);
+            fprintf(out, "|0)");
+            break;
+        }
         struct listElem* elem;
         for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
             generateExpression(out, (struct astNode*)elem->data);
@@ -352,18 +2341,32 @@ static void generateExpression(FILE* out, struct astNode* node) {
     } break;
     case AST_NEW: {
         struct astNode* rightAST = node->children->head.next->data;
-        fprintf(out, "new ");
+        if(heapStruct(node->valueType) == NULL) {
+            fprintf(out, "new ");
+        }
         if(rightAST->type == AST_CALL) {
             generateExpression(out, node->children->head.next->data);
         } else if(rightAST->type == AST_INDEX) {
             fprintf(out, "Array(%d)", *(int*)(((struct astNode*)rightAST->children->head.next->data)->data));
         }
     }break;
-    case AST_FREE: break;
+    case AST_FREE: {
+        struct astNode* freed = node->children->head.next->data;
+        struct symbolNode* dataStruct = heapStruct(freed->valueType);
+        if(dataStruct != NULL) {
+            fprintf(out, "$release(");
+            generateExpression(out, freed);
+            fprintf(out, ",%d)", heapSizes[dataStruct->id]);
+        }
+    } break;
     case AST_DOT:
+        if(heapStruct(((struct astNode*)node->children->head.next->next->data)->valueType) != NULL) {
+            generateHeapField(out, node, 0);
+            break;
+        }
         generateExpression(out, node->children->head.next->next->data);
         fprintf(out, ".");
-        fprintf(out, "%s", (char*)((struct astNode*)node->children->head.next->data)->data);
+        fprintf(out, "%s", fieldName(((struct astNode*)node->children->head.next->data)->data));
         break;
     case AST_INDEX:
         generateExpression(out, node->children->head.next->next->data);
@@ -377,4 +2380,441 @@ static void generateExpression(FILE* out, struct astNode* node) {
     default:
         break;
     }
-}
\ No newline at end of file
+}
+
+/*
+    Writes out int arithmetic that may not give an int, coerced so that it 
+    wraps around like 32 bit arithmetic:
+
+        (a+b|0)     (a-b|0)     Math.imul(a,b)      (a/b|0)
+
+    Dividing a number that is never negative by a power of two is written as
+    a shift instead, which rounds the same way. */
+static void generateIntArithmetic(FILE* out, struct astNode* node) {
+    struct astNode* right = node->children->head.next->data;
+    struct astNode* left = node->children->head.next->next->data;
+    if(node->type == AST_MULTIPLY) {
+        fprintf(out, "Math.imul(");
+        generateExpression(out, left);
+        fprintf(out, ",");
+        generateExpression(out, right);
+        fprintf(out, ")");
+        return;
+    }
+    if(node->type == AST_DIVIDE && right->type == AST_INTLITERAL && range_get(left).min >= 0) {
+        int divisor = *(int*)right->data;
+        int shift = 0;
+        while(shift < 31 && (1 << shift) != divisor) {
+            shift++;
+        }
+        if(shift < 31) {
+            fprintf(out, "(");
+            generateExpression(out, left);
+            fprintf(out, ">>%d)", shift);
+            return;
+        }
+    }
+    fprintf(out, "(");
+    generateExpression(out, left);
+    fprintf(out, "%s", (char*)node->data);
+    generateExpression(out, right);
+    fprintf(out, "|0)");
+}
+
+/*
+    Gives the expression that a call can be replaced with, or NULL if the call
+    should not be inlined. Calls are only inlined when a profile is used, and
+    the function called:
+    - was called often in the profile
+    - is in a module, rather than nested in another function
+    - only returns a small expression, which does not call or assign anything
+    
+    Arguments must be literals or local variables, since they may be written 
+    out any number of times, in any order, once the call is inlined. */
+static struct astNode* inlineExpression(struct astNode* call, struct symbolNode* function) {
+    if(options.profileUse == NULL || options.stream || inlining != NULL) {
+        return NULL;
+    }
+    if(function->symbolType != SYMBOL_FUNCTION || function->code == NULL || function->parent->symbolType != SYMBOL_MODULE) {
+        return NULL;
+    }
+    if(split != NULL && (symbolModule(function) != symbolModule(call->scope) || split->loads[function->id] != NULL)) {
+        return NULL;
+    }
+    struct astNode* body = function->code;
+    if(body->type != AST_BLOCK || body->children->size != 1) {
+        return NULL;
+    }
+    struct astNode* statement = list_begin(body->children)->data;
+    if(statement->type != AST_RETURN || list_isEmpty(statement->children)) {
+        return NULL;
+    }
+    struct astNode* expression = list_begin(statement->children)->data;
+    if(countInlineNodes(expression) > INLINE_MAX_NODES) {
+        return NULL;
+    }
+    struct listElem* elem;
+    for(elem = list_begin(call->children); elem != list_end(call->children); elem = list_next(elem)) {
+        if(!isInlineArg(elem->data)) {
+            return NULL;
+        }
+    }
+    struct profileEntry* entry = profile_get(function);
+    if(entry == NULL || entry->calls < INLINE_MIN_CALLS) {
+        return NULL;
+    }
+    return expression;
+}
+
+/*
+    Counts the nodes in an expression. Expressions that cannot be inlined 
+    count as too many. */
+static int countInlineNodes(struct astNode* node) {
+    switch(node->type) {
+    case AST_CALL:
+    case AST_ASSIGN:
+    case AST_NEW:
+    case AST_FREE:
+    case AST_BLOCK:
+        return INLINE_MAX_NODES + 1;
+    default: {
+        int count = 1;
+        struct listElem* elem;
+        for(elem = list_begin(node->children); elem != list_end(node->children) && count <= INLINE_MAX_NODES; elem = list_next(elem)) {
+            count += countInlineNodes(elem->data);
+        }
+        return count;
+    }
+    }
+}
+
+/*
+    Whether an argument can be written out in place of a parameter. Literals 
+    and local variables cannot change while an inlined expression runs. */
+static int isInlineArg(struct astNode* arg) {
+    switch(arg->type) {
+    case AST_INTLITERAL:
+    case AST_REALLITERAL:
+    case AST_CHARLITERAL:
+    case AST_STRINGLITERAL:
+    case AST_TRUE:
+    case AST_FALSE:
+    case AST_NULL:
+        return 1;
+    case AST_VAR: {
+        struct symbolNode* symbol = symbol_findVar(arg);
+        return symbol != NULL && symbol->symbolType == SYMBOL_VARIABLE && 
+            (symbol->parent->symbolType == SYMBOL_BLOCK || symbol->parent->symbolType == SYMBOL_FUNCTION);
+    }
+    default:
+        return 0;
+    }
+}
+
+/*
+    Writes out the expression a function returns in place of a call to it,
+    with the arguments of the call in place of the parameters.
+    
+    Representation:
+        (expression) */
+static void generateInline(FILE* out, struct astNode* call, struct symbolNode* function, struct astNode* expression) {
+    struct inlineCall inlineCall;
+    inlineCall.function = function;
+    inlineCall.numArgs = call->children->size;
+    inlineCall.args = (struct astNode**)malloc(sizeof(struct astNode*) * (inlineCall.numArgs + 1));
+    int i = 0;
+    struct listElem* elem;
+    for(elem = list_begin(call->children); elem != list_end(call->children); elem = list_next(elem)) {
+        inlineCall.args[i++] = elem->data;
+    }
+    inlining = &inlineCall;
+    range_share(1); // other threads may be inlining the same expression
+    fprintf(out, "(");
+    generateExpression(out, expression);
+    fprintf(out, ")");
+    range_share(0);
+    inlining = NULL;
+    free(inlineCall.args);
+}
+
+/*
+    Decides which structs are kept in the heap, and lays out their records. 
+    Structs are kept in the heap if they are created with new, and JavaScript
+    cannot see them. Fields are laid out in the order they are declared, with
+    reals aligned to 8 bytes. Records are a multiple of 8 bytes long, so that
+    records of the same size can share a free list. */
+static void layoutHeap(struct list* structList, struct list* globalList, struct list* functionList) {
+    int numIDs = maxID(program) + 1;
+    struct nameUses uses;
+    countUses(structList, globalList, functionList, &uses);
+    heapSizes = (int*)calloc(numIDs, sizeof(int));
+    heapOffsets = (int*)calloc(numIDs, sizeof(int));
+
+    struct listElem* elem;
+    for(elem = list_begin(structList); elem != list_end(structList); elem = list_next(elem)) {
+        struct symbolNode* dataStruct = (struct symbolNode*)elem->data;
+        if(uses.constructed[dataStruct->id] && !uses.interop[dataStruct->id]) {
+            heapSizes[dataStruct->id] = 1; // sized below, once every heap struct is known
+        }
+    }
+    for(elem = list_begin(structList); elem != list_end(structList); elem = list_next(elem)) {
+        struct symbolNode* dataStruct = (struct symbolNode*)elem->data;
+        if(heapSizes[dataStruct->id] == 0) {
+            continue;
+        }
+        int size = 0;
+        struct listElem* fieldElem;
+        for(fieldElem = list_begin(dataStruct->children->keyList); fieldElem != list_end(dataStruct->children->keyList); fieldElem = list_next(fieldElem)) {
+            struct symbolNode* field = (struct symbolNode*)map_get(dataStruct->children, fieldElem->data);
+            if(heapKind(field->type) == HEAP_REAL) {
+                size = (size + 7) / 8 * 8;
+                heapOffsets[field->id] = size;
+                size += 8;
+            } else {
+                heapOffsets[field->id] = size;
+                size += 4;
+            }
+        }
+        heapSizes[dataStruct->id] = size > 0 ? (size + 7) / 8 * 8 : 8;
+    }
+    free(uses.ids);
+    free(uses.constructed);
+    free(uses.accessed);
+    free(uses.interop);
+}
+
+/*
+    Gives how a field of a given type is kept in a heap record */
+static enum heapKind heapKind(const char* type) {
+    struct symbolNode* typeSymbol = map_get(typeMap, type);
+    if(!strcmp(type, "int") || (typeSymbol != NULL && typeSymbol->symbolType == SYMBOL_ENUM)) {
+        return HEAP_INT;
+    } else if(!strcmp(type, "real")) {
+        return HEAP_REAL;
+    } else if(!strcmp(type, "boolean")) {
+        return HEAP_BOOLEAN;
+    } else if(heapStruct(type) != NULL) {
+        return HEAP_POINTER;
+    } else {
+        return HEAP_OBJECT;
+    }
+}
+
+/*
+    Returns the struct of a type if the struct is kept in the heap, NULL 
+    otherwise */
+static struct symbolNode* heapStruct(const char* type) {
+    if(heapSizes == NULL || type == NULL || strstr(type, " array")) {
+        return NULL;
+    }
+    struct symbolNode* dataStruct = typeStruct(type);
+    if(dataStruct == NULL || heapSizes[dataStruct->id] == 0) {
+        return NULL;
+    }
+    return dataStruct;
+}
+
+/*
+    Writes out the heap, and the allocator that hands out its records. Records
+    are handed out from the top of the heap, and freed records are kept in a 
+    free list for their size, to be handed out again before the heap grows.
+    When the heap is full, it is copied into one twice as big. Address 0 is
+    never handed out, so that it can stand for null. The array of objects is
+    kept as long as the heap is, since JavaScript engines slow down a lot on
+    arrays with gaps.
+    
+    Representation:
+        let $heap=new ArrayBuffer(...),$i32=new Int32Array($heap),$f64=new Float64Array($heap),$r=[],$top=8,$free=[];
+        function $alloc(size){ ... }
+        function $release(address,size){ ... } */
+static void generateHeap(FILE* out) {
+    const char* newline = options.minify ? "" : "\n";
+    fprintf(out, "let $heap=new ArrayBuffer(65536),$i32=new Int32Array($heap),$f64=new Float64Array($heap),$r=[],$top=8,$free=[];%s", newline);
+    fprintf(out, "function $alloc(n){const l=$free[n>>3];if(l!==undefined&&l.length>0)return l.pop();");
+    fprintf(out, "if($top+n>$heap.byteLength){let s=$heap.byteLength*2;while(s<$top+n)s*=2;const h=new ArrayBuffer(s);new Int32Array(h).set($i32);$heap=h;$i32=new Int32Array(h);$f64=new Float64Array(h)}");
+    fprintf(out, "const p=$top;$top+=n;while($r.length<$top>>2)$r.push(null);return p}%s", newline);
+    fprintf(out, "function $release(p,n){if(p==null)return;$r.fill(undefined,p>>2,p+n>>2);($free[n>>3]||($free[n>>3]=[])).push(p)}%s", newline);
+}
+
+/*
+    Writes a struct that is kept in the heap. Instead of a class, the struct is
+    a function that allocates a record, gives every field a value of its type,
+    and returns the address of the record.
+    
+    Representation:
+        function structUID(field, field, ...){const $a=$alloc(size);$i32[$a+offset>>2]=field;$f64[$a+offset>>3]=field??0;$r[$a+offset>>2]=field??null;...;return $a} */
+static void generateHeapStruct(FILE* out, struct symbolNode* dataStruct) {
+    fprintf(out, "function ");
+    fprintb(out, dataStruct->id);
+    fprintf(out, "(");
+    struct list* fields = dataStruct->children->keyList;
+    struct listElem* fieldElem;
+    for(fieldElem = list_begin(fields); fieldElem != list_end(fields); fieldElem = list_next(fieldElem)) {
+        struct symbolNode* field = (struct symbolNode*)map_get(dataStruct->children, fieldElem->data);
+        fprintb(out, field->id);
+        if(fieldElem->next != list_end(fields)){
+            fprintf(out, ",");
+        }
+    }
+    fprintf(out, "){const $a=$alloc(%d);", heapSizes[dataStruct->id]);
+    for(fieldElem = list_begin(fields); fieldElem != list_end(fields); fieldElem = list_next(fieldElem)) {
+        struct symbolNode* field = (struct symbolNode*)map_get(dataStruct->children, fieldElem->data);
+        int offset = heapOffsets[field->id];
+        switch(heapKind(field->type)) {
+        case HEAP_REAL:
+            fprintf(out, "$f64[$a+%d>>3]=", offset);
+            fprintb(out, field->id);
+            fprintf(out, "??0;");
+            break;
+        case HEAP_OBJECT:
+            fprintf(out, "$r[$a+%d>>2]=", offset);
+            fprintb(out, field->id);
+            fprintf(out, "??null;");
+            break;
+        default: // Int32Array stores turn undefined and null into 0, and booleans into 0 or 1
+            fprintf(out, "$i32[$a+%d>>2]=", offset);
+            fprintb(out, field->id);
+            fprintf(out, ";");
+            break;
+        }
+    }
+    fprintf(out, "return $a}");
+}
+
+/*
+    Writes out a field of a record in the heap. Fields that are being assigned
+    to are written as the element of the array they are kept in. Fields that 
+    are read are turned back into the type of the field.
+    
+    Representation:
+        $i32[(record)+offset>>2]            ints, and stores to booleans and pointers
+        ($i32[(record)+offset>>2]!==0)      booleans
+        ($i32[(record)+offset>>2]||null)    pointers
+        $f64[(record)+offset>>3]            reals
+        $r[(record)+offset>>2]              everything else */
+static void generateHeapField(FILE* out, struct astNode* dot, int isStore) {
+    struct astNode* record = dot->children->head.next->next->data;
+    struct symbolNode* dataStruct = heapStruct(record->valueType);
+    struct symbolNode* field = map_get(dataStruct->children, ((struct astNode*)dot->children->head.next->data)->data);
+    ASSERT(field != NULL);
+    enum heapKind kind = heapKind(field->type);
+    int wrapped = !isStore && (kind == HEAP_BOOLEAN || kind == HEAP_POINTER);
+    if(wrapped) {
+        fprintf(out, "(");
+    }
+    fprintf(out, kind == HEAP_REAL ? "$f64[(" : kind == HEAP_OBJECT ? "$r[(" : "$i32[(");
+    generateExpression(out, record);
+    fprintf(out, ")+%d>>%d]", heapOffsets[field->id], kind == HEAP_REAL ? 3 : 2);
+    if(wrapped) {
+        fprintf(out, kind == HEAP_BOOLEAN ? "!==0)" : "||null)");
+    }
+}
+
+/*
+    Adds bytes written for a symbol to its size, if sizes are being kept */
+static void recordSize(struct symbolNode* symbol, long bytes) {
+    if(symbolSizes == NULL) {
+        return;
+    }
+    struct sizeEntry* entry = &symbolSizes[symbol->id];
+    if(entry->name == NULL) {
+        entry->name = profile_functionName(symbol);
+        entry->kind = symbol->symbolType == SYMBOL_ENUM ? "enum" : symbol->symbolType == SYMBOL_STRUCT ? "struct" : 
+            symbol->symbolType == SYMBOL_VARIABLE ? "global" : "function";
+        entry->module = symbolModule(symbol)->name;
+    }
+    entry->bytes += bytes;
+}
+
+/*
+    Prints the bytes of output from each module, and from the symbols that 
+    take up the most, sorted with the biggest first. Every symbol is written 
+    to the --size-report file as JSON, sorted by name so that reports from two
+    builds can be diffed. Bytes not from any symbol, like headers, imports, and
+    runtime code, are counted as other. */
+static void reportSizes(long total) {
+    int numModules = program->children->size;
+    struct sizeEntry* modules = (struct sizeEntry*)calloc(numModules + 1, sizeof(struct sizeEntry));
+    struct sizeEntry* symbols = (struct sizeEntry*)calloc(numSizes + 1, sizeof(struct sizeEntry));
+
+    int i = 0;
+    struct listElem* elem;
+    for(elem = list_begin(program->children->keyList); elem != list_end(program->children->keyList); elem = list_next(elem), i++) {
+        modules[i].name = elem->data;
+        modules[i].kind = "module";
+    }
+    long other = total;
+    int numSymbols = 0;
+    for(int id = 0; id < numSizes; id++) {
+        if(symbolSizes[id].name == NULL) {
+            continue;
+        }
+        symbols[numSymbols] = symbolSizes[id];
+        for(i = 0; i < numModules; i++) {
+            if(!strcmp(modules[i].name, symbols[numSymbols].module)) {
+                modules[i].bytes += symbols[numSymbols].bytes;
+            }
+        }
+        other -= symbols[numSymbols].bytes;
+        numSymbols++;
+    }
+
+    FILE* json = fopen(options.sizeReport, "w");
+    if(json == NULL) {
+        perror(options.sizeReport);
+        exit(1);
+    }
+    fprintf(json, "{\n\t\"total\": %ld,\n\t\"other\": %ld,\n\t\"modules\": {", total, other);
+    for(i = 0; i < numModules; i++) {
+        fprintf(json, "%s\n\t\t\"%s\": %ld", i ? "," : "", modules[i].name, modules[i].bytes);
+    }
+    fprintf(json, "\n\t},\n\t\"symbols\": {");
+    qsort(symbols, numSymbols, sizeof(struct sizeEntry), compareNames);
+    for(i = 0; i < numSymbols; i++) {
+        fprintf(json, "%s\n\t\t\"%s\": {\"kind\": \"%s\", \"bytes\": %ld}", i ? "," : "", symbols[i].name, symbols[i].kind, symbols[i].bytes);
+    }
+    fprintf(json, "\n\t}\n}\n");
+    fclose(json);
+
+    qsort(modules, numModules, sizeof(struct sizeEntry), compareSizes);
+    qsort(symbols, numSymbols, sizeof(struct sizeEntry), compareSizes);
+    printf("%-40s %10s %6s\n", "module", "bytes", "%");
+    for(i = 0; i < numModules; i++) {
+        printf("%-40s %10ld %6.1f\n", modules[i].name, modules[i].bytes, 100.0 * modules[i].bytes / total);
+    }
+    printf("%-40s %10ld %6.1f\n\n", "other", other, 100.0 * other / total);
+    printf("%-40s %10s %6s\n", "symbol", "bytes", "%");
+    for(i = 0; i < numSymbols && i < 20; i++) {
+        printf("%-40s %10ld %6.1f  %s\n", symbols[i].name, symbols[i].bytes, 100.0 * symbols[i].bytes / total, symbols[i].kind);
+    }
+    if(numSymbols > 20) {
+        printf("%d more in %s\n", numSymbols - 20, options.sizeReport);
+    }
+    printf("%-40s %10ld\n", "total", total);
+
+    for(i = 0; i < numSymbols; i++) {
+        free(symbols[i].name);
+    }
+    free(symbols);
+    free(modules);
+    free(symbolSizes);
+    symbolSizes = NULL;
+}
+
+/*
+    Orders size entries from the most bytes to the least, and by name when
+    they are the same size */
+static int compareSizes(const void* a, const void* b) {
+    const struct sizeEntry* left = a;
+    const struct sizeEntry* right = b;
+    if(left->bytes != right->bytes) {
+        return left->bytes < right->bytes ? 1 : -1;
+    }
+    return compareNames(a, b);
+}
+
+/*
+    Orders size entries by name */
+static int compareNames(const void* a, const void* b) {
+    return strcmp(((const struct sizeEntry*)a)->name, ((const struct sizeEntry*)b)->name);
+}
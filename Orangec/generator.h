@@ -10,5 +10,6 @@
 #include <stdio.h>
 
 void generator_generate(FILE* out);
+void generator_generateSplit(const char* filename);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,926 @@
+/*  ir.c
+
+    The intermediate representation (IR) sits between the validator and the
+    backends. Functions are lowered from their AST into basic blocks of
+    instructions, where every value is defined exactly once (SSA form).
+
+    - Parameters and local variables are NOT SSA values, they are symbols that
+      are read and written with explicit load and store instructions. Every
+      other value, including temporaries from && and ||, is SSA.
+    - Calls, struct field accesses, and array indexes are explicit
+      instructions, rather than strings hidden inside of AST's.
+    - Values carry the type the validator resolved for them.
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./ir.h"
+#include "./main.h"
+
+#include "../util/debug.h"
+#include "../util/list.h"
+#include "../util/map.h"
+
+/*
+    Holds the state of lowering a single function. Instructions are always
+    added to the end of the current block */
+struct irBuilder {
+    struct irFunction* function;
+    struct irBlock* block;
+};
+
+static struct irBlock* createBlock(struct irFunction*);
+static struct irInstr* emit(struct irBuilder*, enum irOp, const char*);
+static void emitJump(struct irBuilder*, struct irBlock*);
+static void emitBranch(struct irBuilder*, struct irInstr*, struct irBlock*, struct irBlock*);
+static void lowerStatement(struct irBuilder*, struct astNode*);
+static struct irInstr* lowerExpression(struct irBuilder*, struct astNode*);
+static struct irInstr* lowerAssign(struct irBuilder*, struct astNode*);
+static struct irInstr* lowerCall(struct irBuilder*, struct astNode*);
+static struct irInstr* lowerShortCircuit(struct irBuilder*, struct astNode*);
+static enum irOp binaryOp(enum astType);
+static void removeUnreachable(struct irFunction*);
+static void markReachable(struct irBlock*, int*);
+static void computeDominators(struct irFunction*);
+static void postorder(struct irBlock*, struct irBlock**, int*, int*, int*);
+static int dominates(struct irBlock*, struct irBlock*);
+static void verifyBlock(struct irFunction*, struct irBlock*);
+static int producesValue(enum irOp);
+static void printOperand(FILE*, struct irInstr*);
+static void printInstr(FILE*, struct irInstr*);
+
+/*
+    Lowers the AST of a function into IR. The function must already have been
+    validated, since the types of values are taken from the validator. */
+struct irFunction* ir_lower(struct symbolNode* function) {
+    ASSERT(function != NULL);
+    ASSERT(function->code != NULL);
+    struct irFunction* retval = (struct irFunction*)calloc(1, sizeof(struct irFunction));
+    retval->symbol = function;
+    retval->blocks = list_create();
+
+    struct irBuilder builder;
+    builder.function = retval;
+    builder.block = createBlock(retval);
+    lowerStatement(&builder, function->code);
+    // Falling off the end of a function returns nothing
+    if(ir_terminator(builder.block) == NULL) {
+        emit(&builder, IR_RETURN, NULL);
+    }
+    removeUnreachable(retval);
+    return retval;
+}
+
+/*
+    Checks that a function's IR is well formed. Errors are internal compiler
+    errors, and so cause a panic rather than a user error.
+
+    - Every block ends in exactly one terminator
+    - Predecessor lists match the targets of terminators
+    - Phis are at the start of blocks, with one incoming value per predecessor
+    - Every use of a value is dominated by its definition */
+void ir_verify(struct irFunction* function) {
+    ASSERT(function != NULL);
+    struct irBlock* entry = (struct irBlock*)list_begin(function->blocks)->data;
+    if(!list_isEmpty(entry->preds)) {
+        PANIC("IR for %s: entry block b%d has predecessors", function->symbol->name, entry->id);
+    }
+    computeDominators(function);
+    struct listElem* elem;
+    for(elem = list_begin(function->blocks); elem != list_end(function->blocks); elem = list_next(elem)) {
+        verifyBlock(function, (struct irBlock*)elem->data);
+    }
+}
+
+/*
+    Writes out a human readable version of a function's IR */
+void ir_print(FILE* out, struct irFunction* function) {
+    fprintf(out, "function %s(", function->symbol->name);
+    struct list* params = function->symbol->children->keyList;
+    struct listElem* elem;
+    int first = 1;
+    for(elem = list_begin(params); elem != list_end(params); elem = list_next(elem)) {
+        struct symbolNode* param = map_get(function->symbol->children, elem->data);
+        if(param->symbolType == SYMBOL_BLOCK) {
+            continue;
+        }
+        fprintf(out, "%s%s %s", first ? "" : ", ", param->type, param->name);
+        first = 0;
+    }
+    fprintf(out, ") : %s\n", function->symbol->type);
+
+    struct listElem* blockElem;
+    for(blockElem = list_begin(function->blocks); blockElem != list_end(function->blocks); blockElem = list_next(blockElem)) {
+        struct irBlock* block = (struct irBlock*)blockElem->data;
+        fprintf(out, "b%d:", block->id);
+        if(!list_isEmpty(block->preds)) {
+            fprintf(out, "\t\t; preds");
+            for(elem = list_begin(block->preds); elem != list_end(block->preds); elem = list_next(elem)) {
+                fprintf(out, " b%d", ((struct irBlock*)elem->data)->id);
+            }
+        }
+        fprintf(out, "\n");
+        for(elem = list_begin(block->instrs); elem != list_end(block->instrs); elem = list_next(elem)) {
+            fprintf(out, "\t");
+            printInstr(out, (struct irInstr*)elem->data);
+            fprintf(out, "\n");
+        }
+    }
+    fprintf(out, "\n");
+}
+
+/*
+    Converts an IR operation to a string */
+char* ir_toString(enum irOp op) {
+    switch(op) {
+    case IR_INT:
+        return "int";
+    case IR_REAL:
+        return "real";
+    case IR_CHAR:
+        return "char";
+    case IR_STRING:
+        return "string";
+    case IR_BOOLEAN:
+        return "boolean";
+    case IR_NULL:
+        return "null";
+    case IR_UNDEFINED:
+        return "undefined";
+    case IR_SYMBOL:
+        return "symbol";
+    case IR_LOAD:
+        return "load";
+    case IR_STORE:
+        return "store";
+    case IR_ADD:
+        return "add";
+    case IR_SUBTRACT:
+        return "sub";
+    case IR_MULTIPLY:
+        return "mul";
+    case IR_DIVIDE:
+        return "div";
+    case IR_IS:
+        return "is";
+    case IR_ISNT:
+        return "isnt";
+    case IR_GREATER:
+        return "gt";
+    case IR_LESSER:
+        return "lt";
+    case IR_GREATEREQUAL:
+        return "ge";
+    case IR_LESSEREQUAL:
+        return "le";
+    case IR_CAST:
+        return "cast";
+    case IR_NEWSTRUCT:
+        return "newstruct";
+    case IR_NEWARRAY:
+        return "newarray";
+    case IR_ARRAYLITERAL:
+        return "arrayliteral";
+    case IR_CALL:
+        return "call";
+    case IR_VERBATIM:
+        return "verbatim";
+    case IR_GETFIELD:
+        return "getfield";
+    case IR_SETFIELD:
+        return "setfield";
+    case IR_GETINDEX:
+        return "getindex";
+    case IR_SETINDEX:
+        return "setindex";
+    case IR_PHI:
+        return "phi";
+    case IR_JUMP:
+        return "jump";
+    case IR_BRANCH:
+        return "br";
+    case IR_RETURN:
+        return "ret";
+    }
+    printf("Unknown irOp: %d\n", op);
+    NOT_REACHED();
+    return "";
+}
+
+/*
+    Returns whether or not an operation ends a basic block */
+int ir_isTerminator(enum irOp op) {
+    return op == IR_JUMP || op == IR_BRANCH || op == IR_RETURN;
+}
+
+/*
+    Returns the terminator of a block, or NULL if the block is still open */
+struct irInstr* ir_terminator(struct irBlock* block) {
+    if(list_isEmpty(block->instrs)) {
+        return NULL;
+    }
+    struct irInstr* last = (struct irInstr*)block->instrs->tail.prev->data;
+    return ir_isTerminator(last->op) ? last : NULL;
+}
+
+/*
+    Allocates a new, empty basic block and adds it to the end of a function */
+static struct irBlock* createBlock(struct irFunction* function) {
+    struct irBlock* retval = (struct irBlock*)calloc(1, sizeof(struct irBlock));
+    retval->id = function->numBlocks++;
+    retval->instrs = list_create();
+    retval->preds = list_create();
+    queue_push(function->blocks, retval);
+    return retval;
+}
+
+/*
+    Appends a new instruction to the current block.
+
+    Code that follows a return is unreachable, but still has to go somewhere.
+    If the current block is already terminated, a new block with no
+    predecessors is started, and later removed by removeUnreachable. */
+static struct irInstr* emit(struct irBuilder* builder, enum irOp op, const char* type) {
+    if(ir_terminator(builder->block) != NULL) {
+        builder->block = createBlock(builder->function);
+    }
+    struct irInstr* retval = (struct irInstr*)calloc(1, sizeof(struct irInstr));
+    retval->op = op;
+    retval->type = type;
+    retval->args = list_create();
+    retval->block = builder->block;
+    retval->id = producesValue(op) ? builder->function->numValues++ : -1;
+    queue_push(builder->block->instrs, retval);
+    return retval;
+}
+
+/*
+    Ends the current block with an unconditional jump */
+static void emitJump(struct irBuilder* builder, struct irBlock* target) {
+    struct irInstr* jump = emit(builder, IR_JUMP, NULL);
+    jump->targets[0] = target;
+    queue_push(target->preds, builder->block);
+}
+
+/*
+    Ends the current block with a two way branch on a boolean value */
+static void emitBranch(struct irBuilder* builder, struct irInstr* condition, struct irBlock* ifTrue, struct irBlock* ifFalse) {
+    struct irInstr* branch = emit(builder, IR_BRANCH, NULL);
+    queue_push(branch->args, condition);
+    branch->targets[0] = ifTrue;
+    branch->targets[1] = ifFalse;
+    queue_push(ifTrue->preds, builder->block);
+    queue_push(ifFalse->preds, builder->block);
+}
+
+/*
+    Lowers a statement AST into the current block, creating new blocks for
+    control flow as needed */
+static void lowerStatement(struct irBuilder* builder, struct astNode* node) {
+    if(node == NULL) return;
+    LOG("Lower statement %s", ast_toString(node->type));
+
+    switch(node->type) {
+    case AST_BLOCK: {
+        struct listElem* elem;
+        for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+            lowerStatement(builder, (struct astNode*)elem->data);
+        }
+    } break;
+    case AST_SYMBOLDEFINE: {
+        struct symbolNode* symbol = (struct symbolNode*)node->data;
+        if(symbol->symbolType != SYMBOL_VARIABLE) { // Functions, structs, and enums are lowered elsewhere
+            break;
+        }
+        struct irInstr* value;
+        if(symbol->code != NULL) {
+            value = lowerExpression(builder, symbol->code);
+        } else {
+            value = emit(builder, IR_UNDEFINED, symbol->type);
+        }
+        struct irInstr* store = emit(builder, IR_STORE, NULL);
+        store->symbol = symbol;
+        queue_push(store->args, value);
+    } break;
+    case AST_IF:
+    case AST_IFELSE: {
+        struct astNode* condition = node->children->head.next->data;
+        struct astNode* body = node->children->head.next->next->data;
+        struct irBlock* thenBlock = createBlock(builder->function);
+        struct irBlock* elseBlock = NULL;
+        struct irBlock* joinBlock = createBlock(builder->function);
+        if(node->type == AST_IFELSE) {
+            elseBlock = createBlock(builder->function);
+        }
+        emitBranch(builder, lowerExpression(builder, condition), thenBlock, elseBlock != NULL ? elseBlock : joinBlock);
+        builder->block = thenBlock;
+        lowerStatement(builder, body);
+        if(ir_terminator(builder->block) == NULL) {
+            emitJump(builder, joinBlock);
+        }
+        if(elseBlock != NULL) {
+            builder->block = elseBlock;
+            lowerStatement(builder, node->children->head.next->next->next->data);
+            if(ir_terminator(builder->block) == NULL) {
+                emitJump(builder, joinBlock);
+            }
+        }
+        builder->block = joinBlock;
+    } break;
+    case AST_WHILE:
+    case AST_PARALLEL: { // parallel loops are run on one thread when written from IR
+        struct astNode* condition = node->children->head.next->data;
+        struct astNode* body = node->children->head.next->next->data;
+        struct irBlock* headerBlock = createBlock(builder->function);
+        struct irBlock* bodyBlock = createBlock(builder->function);
+        struct irBlock* exitBlock = createBlock(builder->function);
+        emitJump(builder, headerBlock);
+        builder->block = headerBlock;
+        emitBranch(builder, lowerExpression(builder, condition), bodyBlock, exitBlock);
+        builder->block = bodyBlock;
+        lowerStatement(builder, body);
+        if(ir_terminator(builder->block) == NULL) {
+            emitJump(builder, headerBlock);
+        }
+        builder->block = exitBlock;
+    } break;
+    case AST_RETURN: {
+        struct irInstr* value = lowerExpression(builder, node->children->head.next->data);
+        struct irInstr* ret = emit(builder, IR_RETURN, NULL);
+        queue_push(ret->args, value);
+    } break;
+    default:
+        lowerExpression(builder, node);
+        break;
+    }
+}
+
+/*
+    Lowers an expression AST into instructions in the current block. Returns
+    the instruction that holds the value of the expression. */
+static struct irInstr* lowerExpression(struct irBuilder* builder, struct astNode* node) {
+    ASSERT(node != NULL);
+    LOG("Lower expression %s", ast_toString(node->type));
+    struct irInstr* retval = NULL;
+
+    switch(node->type) {
+    case AST_VAR: {
+        struct symbolNode* symbol = symbol_findVar(node);
+        if(symbol == NULL) { // Unresolved names are passed straight through to the backend
+            retval = emit(builder, IR_VERBATIM, node->valueType);
+            struct list* pieces = list_create();
+            queue_push(pieces, node->data);
+            retval->data = pieces;
+        } else if(symbol->symbolType == SYMBOL_VARIABLE || symbol->symbolType == SYMBOL_FUNCTIONPTR) {
+            retval = emit(builder, IR_LOAD, symbol->type);
+            retval->symbol = symbol;
+        } else {
+            retval = emit(builder, IR_SYMBOL, symbol->type);
+            retval->symbol = symbol;
+        }
+    } break;
+    case AST_INTLITERAL:
+        retval = emit(builder, IR_INT, "int");
+        retval->data = node->data;
+        break;
+    case AST_REALLITERAL:
+        retval = emit(builder, IR_REAL, "real");
+        retval->data = node->data;
+        break;
+    case AST_CHARLITERAL:
+        retval = emit(builder, IR_CHAR, "char");
+        retval->data = node->data;
+        break;
+    case AST_STRINGLITERAL:
+        retval = emit(builder, IR_STRING, "char array");
+        retval->data = node->data;
+        break;
+    case AST_TRUE:
+    case AST_FALSE: // The parser maps both true and false tokens to AST_FALSE, the data is what matters
+        retval = emit(builder, IR_BOOLEAN, "boolean");
+        retval->data = node->data;
+        break;
+    case AST_NULL:
+        retval = emit(builder, IR_NULL, "None");
+        break;
+    case AST_CALL:
+        retval = lowerCall(builder, node);
+        break;
+    case AST_VERBATIM: {
+        // String literals are pasted in as-is, other arguments become operands
+        struct list* pieces = list_create();
+        struct list* args = list_create();
+        struct listElem* elem;
+        for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+            struct astNode* child = (struct astNode*)elem->data;
+            if(child->type == AST_STRINGLITERAL) {
+                queue_push(pieces, child->data);
+            } else {
+                queue_push(pieces, NULL);
+                queue_push(args, lowerExpression(builder, child));
+            }
+        }
+        retval = emit(builder, IR_VERBATIM, "Any");
+        retval->data = pieces;
+        retval->args = args;
+    } break;
+    case AST_ADD:
+    case AST_SUBTRACT:
+    case AST_MULTIPLY:
+    case AST_DIVIDE:
+    case AST_IS:
+    case AST_ISNT:
+    case AST_GREATER:
+    case AST_LESSER:
+    case AST_GREATEREQUAL:
+    case AST_LESSEREQUAL: {
+        struct irInstr* left = lowerExpression(builder, node->children->head.next->next->data);
+        struct irInstr* right = lowerExpression(builder, node->children->head.next->data);
+        retval = emit(builder, binaryOp(node->type), node->valueType);
+        queue_push(retval->args, left);
+        queue_push(retval->args, right);
+    } break;
+    case AST_ASSIGN:
+        retval = lowerAssign(builder, node);
+        break;
+    case AST_AND:
+    case AST_OR:
+        retval = lowerShortCircuit(builder, node);
+        break;
+    case AST_CAST: {
+        struct irInstr* value = lowerExpression(builder, node->children->head.next->data);
+        retval = emit(builder, IR_CAST, node->data);
+        queue_push(retval->args, value);
+    } break;
+    case AST_NEW: {
+        struct astNode* rightAST = node->children->head.next->data;
+        if(rightAST->type == AST_MODULEACCESS) { // new Module:Struct(...)
+            rightAST = rightAST->children->head.next->data;
+        }
+        if(rightAST->type == AST_INDEX) {
+            struct irInstr* size = lowerExpression(builder, rightAST->children->head.next->data);
+            retval = emit(builder, IR_NEWARRAY, node->valueType);
+            queue_push(retval->args, size);
+        } else {
+            retval = lowerCall(builder, rightAST);
+        }
+    } break;
+    case AST_FREE:
+        retval = emit(builder, IR_UNDEFINED, "None");
+        break;
+    case AST_DOT: {
+        struct irInstr* object = lowerExpression(builder, node->children->head.next->next->data);
+        retval = emit(builder, IR_GETFIELD, node->valueType);
+        retval->data = ((struct astNode*)node->children->head.next->data)->data;
+        queue_push(retval->args, object);
+    } break;
+    case AST_INDEX: {
+        struct irInstr* array = lowerExpression(builder, node->children->head.next->next->data);
+        struct irInstr* index = lowerExpression(builder, node->children->head.next->data);
+        retval = emit(builder, IR_GETINDEX, node->valueType);
+        queue_push(retval->args, array);
+        queue_push(retval->args, index);
+    } break;
+    case AST_MODULEACCESS:
+        // The validator already moved the scope of the right side into the module
+        retval = lowerExpression(builder, node->children->head.next->data);
+        break;
+    default:
+        PANIC("AST \"%s\" cannot be lowered to IR", ast_toString(node->type));
+    }
+    return retval;
+}
+
+/*
+    Lowers an assignment into a store to a variable, a field, or an array
+    element. The value of the assignment is the value stored. */
+static struct irInstr* lowerAssign(struct irBuilder* builder, struct astNode* node) {
+    struct astNode* leftAST = node->children->head.next->next->data;
+    struct astNode* rightAST = node->children->head.next->data;
+    struct irInstr* value = NULL;
+    struct irInstr* store = NULL;
+
+    if(leftAST->type == AST_MODULEACCESS) {
+        leftAST = leftAST->children->head.next->data;
+    }
+    switch(leftAST->type) {
+    case AST_VAR: {
+        struct symbolNode* symbol = symbol_findVar(leftAST);
+        ASSERT(symbol != NULL);
+        value = lowerExpression(builder, rightAST);
+        store = emit(builder, IR_STORE, NULL);
+        store->symbol = symbol;
+        queue_push(store->args, value);
+    } break;
+    case AST_DOT: {
+        struct irInstr* object = lowerExpression(builder, leftAST->children->head.next->next->data);
+        value = lowerExpression(builder, rightAST);
+        store = emit(builder, IR_SETFIELD, NULL);
+        store->data = ((struct astNode*)leftAST->children->head.next->data)->data;
+        queue_push(store->args, object);
+        queue_push(store->args, value);
+    } break;
+    case AST_INDEX: {
+        struct irInstr* array = lowerExpression(builder, leftAST->children->head.next->next->data);
+        struct irInstr* index = lowerExpression(builder, leftAST->children->head.next->data);
+        value = lowerExpression(builder, rightAST);
+        store = emit(builder, IR_SETINDEX, NULL);
+        queue_push(store->args, array);
+        queue_push(store->args, index);
+        queue_push(store->args, value);
+    } break;
+    default:
+        PANIC("Cannot lower assignment to %s", ast_toString(leftAST->type));
+    }
+    return value;
+}
+
+/*
+    Lowers a call AST. Depending on what the name refers to, this is a
+    function call, a struct initialization, or an array literal. */
+static struct irInstr* lowerCall(struct irBuilder* builder, struct astNode* node) {
+    ASSERT(node->type == AST_CALL);
+    struct list* args = list_create();
+    struct listElem* elem;
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        queue_push(args, lowerExpression(builder, (struct astNode*)elem->data));
+    }
+
+    struct irInstr* retval;
+    if(strstr(node->data, " array")) {
+        retval = emit(builder, IR_ARRAYLITERAL, node->data);
+    } else {
+        struct symbolNode* symbol = symbol_findVar(node);
+        if(symbol == NULL) {
+            symbol = map_get(typeMap, node->data);
+        }
+        ASSERT(symbol != NULL);
+        retval = emit(builder, symbol->symbolType == SYMBOL_STRUCT ? IR_NEWSTRUCT : IR_CALL, symbol->type);
+        retval->symbol = symbol;
+    }
+    retval->args = args;
+    return retval;
+}
+
+/*
+    Lowers && and || so that the right side is only evaluated when it has to
+    be. The result is a phi of the left and right values.
+
+        left && right:      b0: br left, rhs, join
+                            rhs: jump join
+                            join: phi [left, b0], [right, rhs] */
+static struct irInstr* lowerShortCircuit(struct irBuilder* builder, struct astNode* node) {
+    struct irInstr* left = lowerExpression(builder, node->children->head.next->next->data);
+    struct irBlock* leftEnd = builder->block;
+    struct irBlock* rightBlock = createBlock(builder->function);
+    struct irBlock* joinBlock = createBlock(builder->function);
+    if(node->type == AST_AND) {
+        emitBranch(builder, left, rightBlock, joinBlock);
+    } else {
+        emitBranch(builder, left, joinBlock, rightBlock);
+    }
+
+    builder->block = rightBlock;
+    struct irInstr* right = lowerExpression(builder, node->children->head.next->data);
+    struct irBlock* rightEnd = builder->block;
+    emitJump(builder, joinBlock);
+
+    builder->block = joinBlock;
+    struct irInstr* phi = emit(builder, IR_PHI, "boolean");
+    phi->phiBlocks = list_create();
+    queue_push(phi->args, left);
+    queue_push(phi->phiBlocks, leftEnd);
+    queue_push(phi->args, right);
+    queue_push(phi->phiBlocks, rightEnd);
+    return phi;
+}
+
+/*
+    Converts a binary operator AST type to the IR operation for it */
+static enum irOp binaryOp(enum astType type) {
+    switch(type) {
+    case AST_ADD:
+        return IR_ADD;
+    case AST_SUBTRACT:
+        return IR_SUBTRACT;
+    case AST_MULTIPLY:
+        return IR_MULTIPLY;
+    case AST_DIVIDE:
+        return IR_DIVIDE;
+    case AST_IS:
+        return IR_IS;
+    case AST_ISNT:
+        return IR_ISNT;
+    case AST_GREATER:
+        return IR_GREATER;
+    case AST_LESSER:
+        return IR_LESSER;
+    case AST_GREATEREQUAL:
+        return IR_GREATEREQUAL;
+    case AST_LESSEREQUAL:
+        return IR_LESSEREQUAL;
+    default:
+        PANIC("%s is not a binary operator", ast_toString(type));
+    }
+}
+
+/*
+    Removes blocks that cannot be reached from the entry block, such as code
+    after a return. Their edges are removed from the predecessor lists of
+    reachable blocks as well. */
+static void removeUnreachable(struct irFunction* function) {
+    int* reachable = (int*)calloc(function->numBlocks, sizeof(int));
+    markReachable((struct irBlock*)list_begin(function->blocks)->data, reachable);
+
+    struct listElem* elem;
+    for(elem = list_begin(function->blocks); elem != list_end(function->blocks); elem = list_next(elem)) {
+        struct irBlock* block = (struct irBlock*)elem->data;
+        if(!reachable[block->id]) {
+            elem = elem->prev;
+            list_remove(function->blocks, list_next(elem));
+            continue;
+        }
+        struct listElem* predElem;
+        for(predElem = list_begin(block->preds); predElem != list_end(block->preds); predElem = list_next(predElem)) {
+            if(!reachable[((struct irBlock*)predElem->data)->id]) {
+                predElem = predElem->prev;
+                list_remove(block->preds, list_next(predElem));
+            }
+        }
+    }
+    free(reachable);
+}
+
+/*
+    Marks every block reachable from a block, indexed by block id */
+static void markReachable(struct irBlock* block, int* reachable) {
+    if(reachable[block->id]) {
+        return;
+    }
+    reachable[block->id] = 1;
+    struct irInstr* terminator = ir_terminator(block);
+    ASSERT(terminator != NULL);
+    for(int i = 0; i < 2; i++) {
+        if(terminator->targets[i] != NULL) {
+            markReachable(terminator->targets[i], reachable);
+        }
+    }
+}
+
+/*
+    Fills in the immediate dominator of every block.
+
+    Uses the iterative algorithm from "A Simple, Fast Dominance Algorithm" by
+    Cooper, Harvey and Kennedy. Blocks are visited in reverse postorder until
+    no immediate dominator changes. */
+static void computeDominators(struct irFunction* function) {
+    int n = function->numBlocks;
+    struct irBlock** order = (struct irBlock**)calloc(n, sizeof(struct irBlock*));
+    int* number = (int*)calloc(n, sizeof(int)); // postorder number of each block id, -1 if unvisited
+    int* visited = (int*)calloc(n, sizeof(int));
+    int count = 0;
+    struct irBlock* entry = (struct irBlock*)list_begin(function->blocks)->data;
+    postorder(entry, order, number, visited, &count);
+
+    struct listElem* elem;
+    for(elem = list_begin(function->blocks); elem != list_end(function->blocks); elem = list_next(elem)) {
+        ((struct irBlock*)elem->data)->idom = NULL;
+    }
+    entry->idom = entry;
+    int changed = 1;
+    while(changed) {
+        changed = 0;
+        for(int i = count - 2; i >= 0; i--) { // reverse postorder, skipping the entry
+            struct irBlock* block = order[i];
+            struct irBlock* newIdom = NULL;
+            struct listElem* predElem;
+            for(predElem = list_begin(block->preds); predElem != list_end(block->preds); predElem = list_next(predElem)) {
+                struct irBlock* pred = (struct irBlock*)predElem->data;
+                if(pred->idom == NULL) {
+                    continue;
+                } else if(newIdom == NULL) {
+                    newIdom = pred;
+                } else { // intersect
+                    struct irBlock* a = pred;
+                    struct irBlock* b = newIdom;
+                    while(a != b) {
+                        while(number[a->id] < number[b->id]) a = a->idom;
+                        while(number[b->id] < number[a->id]) b = b->idom;
+                    }
+                    newIdom = a;
+                }
+            }
+            if(block->idom != newIdom) {
+                block->idom = newIdom;
+                changed = 1;
+            }
+        }
+    }
+    free(order);
+    free(number);
+    free(visited);
+}
+
+/*
+    Numbers blocks in depth first postorder */
+static void postorder(struct irBlock* block, struct irBlock** order, int* number, int* visited, int* count) {
+    visited[block->id] = 1;
+    struct irInstr* terminator = ir_terminator(block);
+    for(int i = 0; terminator != NULL && i < 2; i++) {
+        struct irBlock* target = terminator->targets[i];
+        if(target != NULL && !visited[target->id]) {
+            postorder(target, order, number, visited, count);
+        }
+    }
+    number[block->id] = *count;
+    order[(*count)++] = block;
+}
+
+/*
+    Returns whether or not block a dominates block b */
+static int dominates(struct irBlock* a, struct irBlock* b) {
+    while(b != NULL) {
+        if(a == b) {
+            return 1;
+        } else if(b->idom == b) {
+            return 0;
+        }
+        b = b->idom;
+    }
+    return 0;
+}
+
+/*
+    Checks a single block of a function, see ir_verify */
+static void verifyBlock(struct irFunction* function, struct irBlock* block) {
+    const char* name = function->symbol->name;
+    if(block->idom == NULL) {
+        PANIC("IR for %s: block b%d is unreachable", name, block->id);
+    }
+    if(ir_terminator(block) == NULL) {
+        PANIC("IR for %s: block b%d does not end in a terminator", name, block->id);
+    }
+    int index = 0;
+    int seenNonPhi = 0;
+    struct listElem* elem;
+    for(elem = list_begin(block->instrs); elem != list_end(block->instrs); elem = list_next(elem), index++) {
+        struct irInstr* instr = (struct irInstr*)elem->data;
+        if(instr->block != block) {
+            PANIC("IR for %s: %%%d is in b%d but claims to be in b%d", name, instr->id, block->id, instr->block->id);
+        }
+        if(ir_isTerminator(instr->op) && elem->next != list_end(block->instrs)) {
+            PANIC("IR for %s: terminator in the middle of b%d", name, block->id);
+        }
+        if(producesValue(instr->op) != (instr->id >= 0)) {
+            PANIC("IR for %s: %s in b%d has the wrong kind of id", name, ir_toString(instr->op), block->id);
+        }
+
+        if(instr->op == IR_PHI) {
+            if(seenNonPhi) {
+                PANIC("IR for %s: phi %%%d is not at the start of b%d", name, instr->id, block->id);
+            }
+            if(instr->args->size != block->preds->size || instr->phiBlocks->size != block->preds->size) {
+                PANIC("IR for %s: phi %%%d has %d values for %d predecessors", name, instr->id, instr->args->size, block->preds->size);
+            }
+        } else {
+            seenNonPhi = 1;
+        }
+
+        // Every operand must be defined before it is used
+        struct listElem* argElem;
+        struct listElem* phiElem = instr->op == IR_PHI ? list_begin(instr->phiBlocks) : NULL;
+        for(argElem = list_begin(instr->args); argElem != list_end(instr->args); argElem = list_next(argElem)) {
+            struct irInstr* arg = (struct irInstr*)argElem->data;
+            if(arg == NULL || arg->id < 0) {
+                PANIC("IR for %s: %s in b%d uses an instruction that has no value", name, ir_toString(instr->op), block->id);
+            }
+            if(instr->op == IR_PHI) {
+                struct irBlock* incoming = (struct irBlock*)phiElem->data;
+                phiElem = list_next(phiElem);
+                if(!dominates(arg->block, incoming)) {
+                    PANIC("IR for %s: phi %%%d uses %%%d, which does not dominate b%d", name, instr->id, arg->id, incoming->id);
+                }
+            } else if(arg->block == block) {
+                struct listElem* before;
+                for(before = list_begin(block->instrs); before != elem && before->data != arg; before = list_next(before));
+                if(before == elem) {
+                    PANIC("IR for %s: %%%d is used before it is defined in b%d", name, arg->id, block->id);
+                }
+            } else if(!dominates(arg->block, block)) {
+                PANIC("IR for %s: %%%d is used in b%d, which it does not dominate", name, arg->id, block->id);
+            }
+        }
+
+        // Edges must show up in predecessor lists
+        for(int i = 0; i < 2; i++) {
+            struct irBlock* target = instr->targets[i];
+            if(target == NULL) continue;
+            struct listElem* predElem;
+            for(predElem = list_begin(target->preds); predElem != list_end(target->preds) && predElem->data != block; predElem = list_next(predElem));
+            if(predElem == list_end(target->preds)) {
+                PANIC("IR for %s: b%d jumps to b%d, but is not one of its predecessors", name, block->id, target->id);
+            }
+        }
+    }
+
+    // Predecessors must actually jump here
+    struct listElem* predElem;
+    for(predElem = list_begin(block->preds); predElem != list_end(block->preds); predElem = list_next(predElem)) {
+        struct irInstr* terminator = ir_terminator((struct irBlock*)predElem->data);
+        if(terminator == NULL || (terminator->targets[0] != block && terminator->targets[1] != block)) {
+            PANIC("IR for %s: b%d is a predecessor of b%d, but does not jump there", name, ((struct irBlock*)predElem->data)->id, block->id);
+        }
+    }
+}
+
+/*
+    Returns whether or not instructions with the given operation define an
+    SSA value */
+static int producesValue(enum irOp op) {
+    return !(op == IR_STORE || op == IR_SETFIELD || op == IR_SETINDEX || ir_isTerminator(op));
+}
+
+/*
+    Prints a reference to the value an instruction defines */
+static void printOperand(FILE* out, struct irInstr* instr) {
+    fprintf(out, "%%%d", instr->id);
+}
+
+/*
+    Prints a single instruction, in the form "%id : type = op operands" */
+static void printInstr(FILE* out, struct irInstr* instr) {
+    if(instr->id >= 0) {
+        printOperand(out, instr);
+        fprintf(out, " : %s = ", instr->type != NULL ? instr->type : "?");
+    }
+    fprintf(out, "%s", ir_toString(instr->op));
+
+    switch(instr->op) {
+    case IR_INT:
+        fprintf(out, " %d", *(int*)instr->data);
+        return;
+    case IR_REAL:
+        fprintf(out, " %f", *(float*)instr->data);
+        return;
+    case IR_CHAR:
+        fprintf(out, " '%s'", (char*)instr->data);
+        return;
+    case IR_STRING:
+        fprintf(out, " \"%s\"", (char*)instr->data);
+        return;
+    case IR_BOOLEAN:
+        fprintf(out, " %s", (char*)instr->data);
+        return;
+    case IR_VERBATIM: {
+        struct listElem* pieceElem;
+        struct listElem* argElem = list_begin(instr->args);
+        for(pieceElem = list_begin(instr->data); pieceElem != list_end(instr->data); pieceElem = list_next(pieceElem)) {
+            fprintf(out, pieceElem == list_begin(instr->data) ? " " : ", ");
+            if(pieceElem->data != NULL) {
+                fprintf(out, "\"%s\"", (char*)pieceElem->data);
+            } else {
+                printOperand(out, argElem->data);
+                argElem = list_next(argElem);
+            }
+        }
+        return;
+    }
+    default:
+        break;
+    }
+
+    int first = 1;
+    if(instr->symbol != NULL) {
+        fprintf(out, " @%s", instr->symbol->name);
+        first = 0;
+    }
+    if((instr->op == IR_GETFIELD || instr->op == IR_SETFIELD) && instr->data != NULL) {
+        fprintf(out, " .%s", (char*)instr->data);
+        first = 0;
+    }
+    struct listElem* elem;
+    struct listElem* phiElem = instr->phiBlocks != NULL ? list_begin(instr->phiBlocks) : NULL;
+    for(elem = list_begin(instr->args); elem != list_end(instr->args); elem = list_next(elem)) {
+        fprintf(out, first ? " " : ", ");
+        first = 0;
+        if(phiElem != NULL) {
+            fprintf(out, "[");
+            printOperand(out, elem->data);
+            fprintf(out, ", b%d]", ((struct irBlock*)phiElem->data)->id);
+            phiElem = list_next(phiElem);
+        } else {
+            printOperand(out, elem->data);
+        }
+    }
+    for(int i = 0; i < 2; i++) {
+        if(instr->targets[i] != NULL) {
+            fprintf(out, "%sb%d", first ? " " : ", ", instr->targets[i]->id);
+            first = 0;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/*  ir.h
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+
+#include "./ast.h"
+#include "./symbol.h"
+
+#include "../util/list.h"
+
+/*
+    IR instructions have operations that tell them apart. Every instruction
+    that is not a terminator or a store defines exactly one SSA value */
+enum irOp {
+    // Constants
+    IR_INT, IR_REAL, IR_CHAR, IR_STRING, IR_BOOLEAN, IR_NULL, IR_UNDEFINED,
+    // Symbols
+    IR_SYMBOL, IR_LOAD, IR_STORE,
+    // Math operators
+    IR_ADD, IR_SUBTRACT, IR_MULTIPLY, IR_DIVIDE,
+    // Branch operators
+    IR_IS, IR_ISNT, IR_GREATER, IR_LESSER, IR_GREATEREQUAL, IR_LESSEREQUAL,
+    // Type operators
+    IR_CAST, IR_NEWSTRUCT, IR_NEWARRAY, IR_ARRAYLITERAL,
+    // Calls and memory
+    IR_CALL, IR_VERBATIM, IR_GETFIELD, IR_SETFIELD, IR_GETINDEX, IR_SETINDEX,
+    // SSA merge
+    IR_PHI,
+    // Terminators
+    IR_JUMP, IR_BRANCH, IR_RETURN
+};
+
+/*
+    A single IR instruction. Operands are other instructions, so the use-def
+    chain is just a pointer. */
+struct irInstr {
+    enum irOp op;
+    int id;                     // SSA value number, unique within a function
+    const char* type;           // validated type of the value, NULL for none
+    struct list* args;          // operand irInstr's, in evaluation order
+    struct symbolNode* symbol;  // variable, function, or struct referenced
+    void* data;                 // constant value, field name, or verbatim pieces
+    struct list* phiBlocks;     // incoming block for each arg of a phi
+    struct irBlock* targets[2]; // jump/branch targets (true, false)
+    struct irBlock* block;
+};
+
+/*
+    A basic block is a straight line list of instructions that ends with
+    exactly one terminator */
+struct irBlock {
+    int id;
+    struct list* instrs;
+    struct list* preds;
+    struct irBlock* idom; // immediate dominator, filled in by the verifier
+};
+
+/*
+    A function lowered to IR. Parameters and local variables stay as
+    symbols that are read and written with load and store, every other value
+    is in SSA form. */
+struct irFunction {
+    struct symbolNode* symbol;
+    struct list* blocks; // entry block is first
+    int numValues;
+    int numBlocks;
+};
+
+struct irFunction* ir_lower(struct symbolNode*);
+void ir_verify(struct irFunction*);
+void ir_print(FILE*, struct irFunction*);
+char* ir_toString(enum irOp);
+int ir_isTerminator(enum irOp);
+struct irInstr* ir_terminator(struct irBlock*);
+
+#endif
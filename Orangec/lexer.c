@@ -7,7 +7,9 @@
     compilation. 
 
     - The lexer DOES NOT care if the tokens are in a proper order
-    - The lexer ONLY turns the text data into a token queue
+    - The lexer ONLY turns the text data into a stream of tokens
+    - Tokens are lexed as the parser asks for them, so lexing and parsing
+      go back and forth
 
     Author: Joseph Shimel
     Date: 2/3/21
@@ -20,6 +22,7 @@
 #include <string.h>
 
 #include "./lexer.h"
+#include "./main.h"
 #include "./token.h"
 
 #include "../util/debug.h"
@@ -30,6 +33,9 @@ static const char oneCharTokens[] = {'{', '}', '(', ')', ';', ',',
 static const char punctuationChars[] = {'<', '>', '=', '[', ']', '&', '|', '!', '/', '*'};
 
 // Private functions
+static int fill(struct tokenStream*);
+static struct token* nextUncommented(struct tokenStream*);
+static struct token* lexToken(struct tokenStream*);
 static int nextToken(const char*, int);
 static void copyToken(const char* src, char* dst, int start, int end);
 static bool numIsFloat(const char*);
@@ -85,142 +91,287 @@ char** lexer_getLines(char* filestring, int* numLines) {
 }
 
 /*
-    Takes in a file represented as a string, and creates a list of tokens */
-struct list* lexer_tokenize(const char *file, const char* filename) {
-    struct list* tokenQueue = list_create();
-    struct token* tempToken = NULL;
-    enum tokenType tempType;
-    int start = 0, end;
-    char tokenBuffer[64];
-    int fileLength = strlen(file);
-    int line = 0;
-
-    do {
-        end = nextToken(file, start);
-        copyToken(file, tokenBuffer, start, end);
-        tempType = -1;
+    Opens a stream of the tokens in a file represented as a string. Nothing is
+    lexed until tokens are asked for. */
+struct tokenStream* lexer_open(const char* file, const char* filename) {
+    return lexer_openAt(file, filename, 0, 0);
+}
+
+/*
+    Opens a stream of the tokens in a file, starting from a token that was 
+    lexed before, at the given position and line */
+struct tokenStream* lexer_openAt(const char* file, const char* filename, int position, int line) {
+    struct tokenStream* stream = lexer_createStream();
+    stream->file = file;
+    stream->filename = filename;
+    stream->position = position;
+    stream->line = line;
+    return stream;
+}
+
+/*
+    Creates an empty stream with no file, that tokens can be pushed onto */
+struct tokenStream* lexer_createStream() {
+    struct tokenStream* stream = (struct tokenStream*)calloc(1, sizeof(struct tokenStream));
+    stream->lookahead = deque_create();
+    return stream;
+}
+
+/*
+    Closes a stream. Tokens that were not taken are freed, the file is NOT */
+void lexer_close(struct tokenStream* stream) {
+    ASSERT(stream != NULL);
+    while(!deque_isEmpty(stream->lookahead)) {
+        token_destroy(deque_pop(stream->lookahead));
+    }
+    if(stream->pending != NULL) {
+        token_destroy(stream->pending);
+    }
+    deque_destroy(stream->lookahead);
+    free(stream);
+}
+
+/*
+    Takes the next token off of a stream. Returns NULL if there are no tokens
+    left */
+struct token* lexer_next(struct tokenStream* stream) {
+    if(lexer_peek(stream, 0) == NULL) {
+        return NULL;
+    }
+    return deque_pop(stream->lookahead);
+}
+
+/*
+    Returns the token that is a given number of tokens from the front of a 
+    stream, without taking it. Returns NULL if the stream ends before then */
+struct token* lexer_peek(struct tokenStream* stream, int index) {
+    ASSERT(stream != NULL);
+    while(stream->lookahead->size <= index) {
+        if(!fill(stream)) {
+            return NULL;
+        }
+    }
+    return deque_get(stream->lookahead, index);
+}
+
+/*
+    Adds a token to the end of a stream with no file */
+void lexer_push(struct tokenStream* stream, struct token* token) {
+    ASSERT(stream->file == NULL);
+    deque_push(stream->lookahead, token);
+}
+
+int lexer_isEmpty(struct tokenStream* stream) {
+    return lexer_peek(stream, 0) == NULL;
+}
+
+/*
+    Lexes the next token of a stream's file into its lookahead buffer. Array
+    brackets that follow an identifier are added to the identifier, so that 
+    the type of i in:
+        int[] i;
+    is "int array". The token after the brackets is kept as pending. 
+    
+    Returns whether a token was added */
+static int fill(struct tokenStream* stream) {
+    struct token* token = nextUncommented(stream);
+    if(token == NULL) {
+        return 0;
+    }
+    if(token->type == TOKEN_IDENTIFIER) {
+        struct token* next;
+        while((next = nextUncommented(stream)) != NULL && next->type == TOKEN_ARRAY) {
+            strncat(token->data, " array", 255);
+            token_destroy(next);
+        }
+        stream->pending = next;
+    }
+    deque_push(stream->lookahead, token);
+    return 1;
+}
+
+/*
+    Returns the next token in a stream's file that is not in a comment. Block
+    comments go until the closing token, line comments go until a token on a
+    different line. The EOF token is never left out. */
+static struct token* nextUncommented(struct tokenStream* stream) {
+    struct token* token;
+    if(stream->pending != NULL) {
+        token = stream->pending;
+        stream->pending = NULL;
+        return token;
+    }
+    token = lexToken(stream);
+    while(token != NULL && (token->type == TOKEN_LBLOCK || token->type == TOKEN_DSLASH)) {
+        enum tokenType commentType = token->type;
+        int commentLine = token->line;
+        token_destroy(token);
+        while((token = lexToken(stream)) != NULL && token->type != TOKEN_EOF) {
+            if(commentType == TOKEN_LBLOCK && token->type == TOKEN_RBLOCK) {
+                token_destroy(token);
+                token = lexToken(stream);
+                break;
+            } else if(commentType == TOKEN_DSLASH && token->line != commentLine) {
+                break;
+            }
+            token_destroy(token);
+        }
+    }
+    return token;
+}
+
+/*
+    Lexes the next token from a stream's file, skipping over new lines. Gives
+    an EOF token once the file is done, and NULL after that. Errors on tokens
+    too long to fit in the data of a token */
+static struct token* lexToken(struct tokenStream* stream) {
+    char tokenBuffer[255]; // as long as the data of a token
+    const char* file = stream->file;
+    if(file == NULL) {
+        return NULL;
+    }
+    while(!stream->atEnd) {
+        int start = stream->position;
+        int end = nextToken(file, stream->position);
+        if(end - stream->position >= (int)sizeof(tokenBuffer)) {
+            error(stream->filename, stream->line, "Token too long, tokens can be at most %d characters", (int)sizeof(tokenBuffer) - 1);
+        }
+        copyToken(file, tokenBuffer, stream->position, end);
+        enum tokenType type = -1;
         if(strcmp("\n", tokenBuffer) == 0) {
-            line++;
+            stream->line++;
         } else if(strcmp("(", tokenBuffer) == 0) {
-            tempType = TOKEN_LPAREN;
+            type = TOKEN_LPAREN;
         } else if(strcmp(")", tokenBuffer) == 0) {
-            tempType = TOKEN_RPAREN;
+            type = TOKEN_RPAREN;
         } else if(strcmp("[", tokenBuffer) == 0) {
-            tempType = TOKEN_LSQUARE;
+            type = TOKEN_LSQUARE;
         } else if(strcmp("]", tokenBuffer) == 0) {
-            tempType = TOKEN_RSQUARE;
+            type = TOKEN_RSQUARE;
         } else if(strcmp("{", tokenBuffer) == 0) {
-            tempType = TOKEN_LBRACE;
+            type = TOKEN_LBRACE;
         } else if(strcmp("}", tokenBuffer) == 0) {
-            tempType = TOKEN_RBRACE;
+            type = TOKEN_RBRACE;
         } else if(strcmp(",", tokenBuffer) == 0) {
-            tempType = TOKEN_COMMA;
+            type = TOKEN_COMMA;
         } else if(strcmp(".", tokenBuffer) == 0) {
-            tempType = TOKEN_DOT;
+            type = TOKEN_DOT;
+        } else if(strcmp("..", tokenBuffer) == 0) {
+            type = TOKEN_RANGE;
         } else if(strcmp(";", tokenBuffer) == 0) {
-            tempType = TOKEN_SEMICOLON;
+            type = TOKEN_SEMICOLON;
         } else if(strcmp(":", tokenBuffer) == 0) {
-            tempType = TOKEN_COLON;
+            type = TOKEN_COLON;
         } else if(isdigit(tokenBuffer[0])) {
             if(numIsFloat(tokenBuffer)) {
-                tempType = TOKEN_REALLITERAL;
+                type = TOKEN_REALLITERAL;
             } else {
-                tempType = TOKEN_INTLITERAL;
+                type = TOKEN_INTLITERAL;
             }
         } else if(tokenBuffer[0] == '\''){
-            tempType = TOKEN_CHARLITERAL;
+            type = TOKEN_CHARLITERAL;
             removeQuotes(tokenBuffer);
         } else if(tokenBuffer[0] == '"'){
-            tempType = TOKEN_STRINGLITERAL;
+            type = TOKEN_STRINGLITERAL;
             removeQuotes(tokenBuffer);
         } else if(strcmp("true", tokenBuffer) == 0) {
-            tempType = TOKEN_TRUE;
+            type = TOKEN_TRUE;
         } else if(strcmp("false", tokenBuffer) == 0) {
-            tempType = TOKEN_FALSE;
+            type = TOKEN_FALSE;
         } else if(strcmp("null", tokenBuffer) == 0) {
-            tempType = TOKEN_NULL;
+            type = TOKEN_NULL;
         } else if(strcmp("verbatim", tokenBuffer) == 0) {
-            tempType = TOKEN_VERBATIM;
+            type = TOKEN_VERBATIM;
         } else if(strcmp("+", tokenBuffer) == 0) {
-            tempType = TOKEN_PLUS;
+            type = TOKEN_PLUS;
         } else if(strcmp("-", tokenBuffer) == 0) {
-            tempType = TOKEN_MINUS;
+            type = TOKEN_MINUS;
         } else if(strcmp("*", tokenBuffer) == 0) {
-            tempType = TOKEN_STAR;
+            type = TOKEN_STAR;
         } else if(strcmp("/", tokenBuffer) == 0) {
-            tempType = TOKEN_SLASH;
+            type = TOKEN_SLASH;
         } else if(strcmp("=", tokenBuffer) == 0) {
-            tempType = TOKEN_EQUALS;
+            type = TOKEN_EQUALS;
         } else if(strcmp("==", tokenBuffer) == 0) {
-            tempType = TOKEN_IS;
+            type = TOKEN_IS;
         } else if(strcmp("!=", tokenBuffer) == 0) {
-            tempType = TOKEN_ISNT;
+            type = TOKEN_ISNT;
         } else if(strcmp(">", tokenBuffer) == 0) {
-            tempType = TOKEN_GREATER;
+            type = TOKEN_GREATER;
         } else if(strcmp("<", tokenBuffer) == 0) {
-            tempType = TOKEN_LESSER;
+            type = TOKEN_LESSER;
         } else if(strcmp(">=", tokenBuffer) == 0) {
-            tempType = TOKEN_GREATEREQUAL;
+            type = TOKEN_GREATEREQUAL;
         } else if(strcmp("<=", tokenBuffer) == 0) {
-            tempType = TOKEN_LESSEREQUAL;
+            type = TOKEN_LESSEREQUAL;
         } else if(strcmp("&&", tokenBuffer) == 0) {
-            tempType = TOKEN_AND;
+            type = TOKEN_AND;
         } else if(strcmp("||", tokenBuffer) == 0) {
-            tempType = TOKEN_OR;
+            type = TOKEN_OR;
         } else if(strcmp("cast", tokenBuffer) == 0) {
-            tempType = TOKEN_CAST;
+            type = TOKEN_CAST;
         } else if(strcmp("new", tokenBuffer) == 0) {
-            tempType = TOKEN_NEW;
+            type = TOKEN_NEW;
         } else if(strcmp("free", tokenBuffer) == 0) {
-            tempType = TOKEN_FREE;
+            type = TOKEN_FREE;
         } else if(strcmp("module", tokenBuffer) == 0) {
-            tempType = TOKEN_MODULE;
+            type = TOKEN_MODULE;
         } else if(strcmp("struct", tokenBuffer) == 0) {
-            tempType = TOKEN_STRUCT;
+            type = TOKEN_STRUCT;
         } else if(strcmp("enum", tokenBuffer) == 0) {
-            tempType = TOKEN_ENUM;
+            type = TOKEN_ENUM;
         } else if(strcmp("private", tokenBuffer) == 0) {
-            tempType = TOKEN_PRIVATE;
+            type = TOKEN_PRIVATE;
         } else if(strcmp("static", tokenBuffer) == 0) {
-            tempType = TOKEN_STATIC;
+            type = TOKEN_STATIC;
         } else if(strcmp("const", tokenBuffer) == 0) {
-            tempType = TOKEN_CONST;
+            type = TOKEN_CONST;
         } else if(strcmp("[]", tokenBuffer) == 0) {
-            tempType = TOKEN_ARRAY;
+            type = TOKEN_ARRAY;
         } else if(strcmp("if", tokenBuffer) == 0) {
-            tempType = TOKEN_IF;
+            type = TOKEN_IF;
         } else if(strcmp("else", tokenBuffer) == 0) {
-            tempType = TOKEN_ELSE;
+            type = TOKEN_ELSE;
         } else if(strcmp("while", tokenBuffer) == 0) {
-            tempType = TOKEN_WHILE;
+            type = TOKEN_WHILE;
+        } else if(strcmp("for", tokenBuffer) == 0) {
+            type = TOKEN_FOR;
+        } else if(strcmp("parallel", tokenBuffer) == 0) {
+            type = TOKEN_PARALLEL;
+        } else if(strcmp("in", tokenBuffer) == 0) {
+            type = TOKEN_IN;
         } else if(strcmp("return", tokenBuffer) == 0) {
-            tempType = TOKEN_RETURN;
+            type = TOKEN_RETURN;
         } else if(strcmp("/*", tokenBuffer) == 0) {
-            tempType = TOKEN_LBLOCK;
+            type = TOKEN_LBLOCK;
         } else if(strcmp("*/", tokenBuffer) == 0) {
-            tempType = TOKEN_RBLOCK;
+            type = TOKEN_RBLOCK;
         } else if(strcmp("//", tokenBuffer) == 0) {
-            tempType = TOKEN_DSLASH;
+            type = TOKEN_DSLASH;
         } else {
-            tempType = TOKEN_IDENTIFIER;
+            type = TOKEN_IDENTIFIER;
         }
 
-        if(tempType != -1) {
-            tempToken = token_create(tempType, tokenBuffer, filename, line);
-            queue_push(tokenQueue, tempToken);
-            LOG("Added token: %p %d %s \"%s\"", tempToken, line, token_toString(tempType), tokenBuffer);
+        stream->position = nextNonWhitespace(file, end);
+        stream->atEnd = file[end] == '\0';
+        if(type != -1) {
+            LOG("Added token: %d %s \"%s\"", stream->line, token_toString(type), tokenBuffer);
+            struct token* token = token_create(type, tokenBuffer, stream->filename, stream->line);
+            token->position = start;
+            return token;
         }
-        start = nextNonWhitespace(file, end);
-        tempToken = NULL;
-    } while(end < fileLength);
-    queue_push(tokenQueue, token_create(TOKEN_EOF, "EOF", filename, line));
-    return tokenQueue;
+    }
+    if(!stream->sentEOF) {
+        stream->sentEOF = 1;
+        return token_create(TOKEN_EOF, "EOF", stream->filename, stream->line);
+    }
+    return NULL;
 }
 
 /*
     Runs a basic state machine.
 
-    Symbols are one character long
+    Symbols are one character long, except for the .. of ranges
     Keywords/identifiers start with alpha, contain only alphanumeric
     Numbers contain only digits
     
@@ -231,13 +382,16 @@ static int nextToken(const char* file, int start) {
     };
 
     enum tokenState state = BEGIN;
-    char nextChar;
 
-    for( ; nextChar != '\0'; start++) {
-        nextChar = file[start];
+    for( ; file[start] != '\0'; start++) {
+        char nextChar = file[start];
         if(state == BEGIN) {
+            // Check range, the only token made of two dots
+            if(nextChar == '.' && file[start + 1] == '.') {
+                return start + 2;
+            }
             // Check one character tokens
-            if(charIsToken(nextChar)) {
+            else if(charIsToken(nextChar)) {
                 return start + 1;
             } 
             // Check keyword/identifier
@@ -266,8 +420,8 @@ static int nextToken(const char* file, int start) {
                 return start;
             }
         } else if (state == INTEGER) {
-            // Ends on non-numeric character
-            if(nextChar == '.') {
+            // Ends on non-numeric character. A dot followed by another dot is a range, not a decimal point
+            if(nextChar == '.' && file[start + 1] != '.') {
                 state = FLOAT;
             } else if(!isdigit(nextChar)) {
                 return start;
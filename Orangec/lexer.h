@@ -9,10 +9,42 @@
 
 #include <stdio.h>
 
-#include "../util/list.h"
+#include "./token.h"
+
+#include "../util/deque.h"
+
+/*
+    Tokens are lexed from a file as the parser asks for them. Tokens that have
+    been lexed but not taken yet are kept in a small ring buffer, so only as 
+    many tokens as the parser looks ahead are in memory at once.
+
+    Comments are left out, and array brackets after an identifier are added to
+    it as " array", before tokens are put in the buffer. 
+    
+    Streams with no file only give back the tokens pushed onto them, and are
+    used by the parser to hold the tokens of an expression. */
+struct tokenStream {
+    struct deque* lookahead;    // tokens lexed and not taken yet
+    struct token* pending;      // token lexed to check for brackets, not in lookahead yet
+    const char* file;           // NULL for streams of pushed tokens
+    const char* filename;
+    int position;
+    int line;
+    int atEnd;      // whether every character of the file has been lexed
+    int sentEOF;    // whether the EOF token has been lexed
+};
 
 char* lexer_readFile(FILE*);
 char** lexer_getLines(char*, int*);
-struct list* lexer_tokenize(const char*, const char*);
+
+// Token streams
+struct tokenStream* lexer_open(const char*, const char*);
+struct tokenStream* lexer_openAt(const char*, const char*, int, int);
+struct tokenStream* lexer_createStream();
+void lexer_close(struct tokenStream*);
+struct token* lexer_next(struct tokenStream*);
+struct token* lexer_peek(struct tokenStream*, int);
+void lexer_push(struct tokenStream*, struct token*);
+int lexer_isEmpty(struct tokenStream*);
 
 #endif
\ No newline at end of file
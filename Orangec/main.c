@@ -15,6 +15,7 @@
     Date: 2/2/21
 */
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,14 +23,53 @@
 #include "./main.h" // Each module, in order of execution
 #include "./lexer.h"
 #include "./parser.h"
+#include "./profile.h"
 #include "./validator.h"
 #include "./generator.h"
 
+#include "../util/alloc.h"
+#include "../util/compress.h"
 #include "../util/debug.h"
 #include "../util/list.h"
 #include "../util/map.h"
 
+struct symbolNode* program;
+struct options options;
+struct map* fileMap;
+
+/*
+    The command line, handed to the thread that compiles */
+struct arguments {
+    int argn;
+    char** argv;
+};
+
+static void* compile(void* arguments);
 static void readInputFile(char* filename);
+static void writeChanged(const char* filename, const unsigned char* data, int length);
+static void writeFile(const char* filename, const unsigned char* data, int length);
+static int sameContents(const char* filename, const unsigned char* data, int length);
+static char* hashFilename(const char* filename, const unsigned char* data, int length);
+static void printMapStats(const char* name, struct map* map);
+static void printScopeStats(struct symbolNode* scope, char* path);
+
+/*
+    Compiles on a thread of its own, with a stack deep enough for programs with
+    long expressions and deeply nested blocks, since they are validated and 
+    written recursively. */
+int main(int argn, char** argv) {
+    struct arguments arguments = {argn, argv};
+    pthread_attr_t attributes;
+    pthread_t thread;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, STACK_SIZE);
+    if(pthread_create(&thread, &attributes, compile, &arguments)) {
+        PANIC("Could not create compiler thread");
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attributes);
+    return 0;
+}
 
 /*
  * Takes in an array of files to compile
@@ -40,20 +80,26 @@ static void readInputFile(char* filename);
  * 4. Validation: Look through AST's, validate type, struct members, module members, state access, etc.
  * 5. Generate code (compile, release) or evaluate tree (interpret, debug)
  */
-int main(int argn, char** argv) {
+static void* compile(void* arguments) {
+    int argn = ((struct arguments*)arguments)->argn;
+    char** argv = ((struct arguments*)arguments)->argv;
     if(argn < 2) {
-        printf("Usage: orangec filename_1 filename_2 ... filename_n\n");
+        printf("Usage: orangec filename_1 filename_2 ... filename_n [-o output] [-t target] [-j jobs] [--ir] [--dump-ir] [--minify] [--split] [--stream] [--gzip] [--brotli] [--level 0-9] [--instrument] [--profile-use profile] [--heap] [--mem-report] [--time] [--map-stats] [--hash-name] [--size-report sizes.json]\n");
         exit(1);
     }
 
     enum argState {
-        NORMAL, TARGET, OUTPUT
+        NORMAL, TARGET, OUTPUT, LEVEL, JOBS, PROFILE, SIZE_REPORT
     };
     enum argState state = NORMAL;
+    alloc_phase("startup"); // starts the clock for --time
     program = symbol_create(SYMBOL_PROGRAM, NULL, NULL, -1);
     fileMap = map_create();
     typeMap = map_create();
+    options.level = 9;
 
+    // Files are read once every option is known, since options change how they are parsed
+    struct list* inputFiles = list_create();
     for(int i = 1; i < argn; i++) {
         switch(state) {
         case NORMAL:
@@ -61,8 +107,43 @@ int main(int argn, char** argv) {
                 state = OUTPUT;
             } else if(!strcmp(argv[i], "-t")) {
                 state = TARGET;
+            } else if(!strcmp(argv[i], "-j")) {
+                state = JOBS;
+            } else if(!strcmp(argv[i], "--ir")) {
+                options.emitIR = 1;
+            } else if(!strcmp(argv[i], "--dump-ir")) {
+                options.dumpIR = 1;
+            } else if(!strcmp(argv[i], "--minify")) {
+                options.minify = 1;
+            } else if(!strcmp(argv[i], "--split")) {
+                options.split = 1;
+            } else if(!strcmp(argv[i], "--stream")) {
+                options.stream = 1;
+            } else if(!strcmp(argv[i], "--gzip")) {
+                options.gzip = 1;
+            } else if(!strcmp(argv[i], "--brotli")) {
+                options.brotli = 1;
+            } else if(!strcmp(argv[i], "--level")) {
+                state = LEVEL;
+            } else if(!strcmp(argv[i], "--size-report")) {
+                state = SIZE_REPORT;
+            } else if(!strcmp(argv[i], "--hash-name")) {
+                options.hashName = 1;
+            } else if(!strcmp(argv[i], "--map-stats")) {
+                options.mapStats = 1;
+                map_countLookups(1);
+            } else if(!strcmp(argv[i], "--mem-report")) {
+                options.memReport = 1;
+            } else if(!strcmp(argv[i], "--time")) {
+                options.time = 1;
+            } else if(!strcmp(argv[i], "--heap")) {
+                options.heap = 1;
+            } else if(!strcmp(argv[i], "--instrument")) {
+                options.instrument = 1;
+            } else if(!strcmp(argv[i], "--profile-use")) {
+                state = PROFILE;
             } else {
-                readInputFile(argv[i]);
+                queue_push(inputFiles, argv[i]);
             }
             break;
         case TARGET:
@@ -73,29 +154,101 @@ int main(int argn, char** argv) {
             strncpy(program->name, argv[i], 255);
             state = NORMAL;
             break;
+        case LEVEL:
+            options.level = atoi(argv[i]);
+            if(options.level < 0 || options.level > 9) {
+                error(NULL, 0, "Compression level must be from 0 to 9\n");
+            }
+            state = NORMAL;
+            break;
+        case JOBS:
+            options.jobs = atoi(argv[i]);
+            if(options.jobs < 1) {
+                error(NULL, 0, "Number of jobs must be at least 1\n");
+            }
+            state = NORMAL;
+            break;
+        case PROFILE:
+            options.profileUse = argv[i];
+            state = NORMAL;
+            break;
+        case SIZE_REPORT:
+            options.sizeReport = argv[i];
+            state = NORMAL;
+            break;
         }
     }
+    if(options.profileUse != NULL) {
+        profile_read(options.profileUse);
+    }
+
+    if(options.heap && (options.split || options.stream || options.emitIR)) {
+        error(NULL, 0, "--heap cannot be used with --split, --stream, or --ir\n");
+    }
+    if(options.stream && (options.minify || options.split || options.jobs > 1)) {
+        error(NULL, 0, "--stream cannot be used with --minify, --split, or -j\n");
+    }
+
+    struct listElem* elem;
+    for(elem = list_begin(inputFiles); elem != list_end(inputFiles); elem = list_next(elem)) {
+        readInputFile(elem->data);
+    }
+    list_destroy(inputFiles);
 
     LOG("\nBegin Validating.");
+    alloc_phase("validate");
+    symbol_linkScopes(program);
     validator_updateStructType(program);
-    validator_validate(program);
+    if(options.stream) {
+        validator_validateDeclarations(program);
+    } else {
+        validator_validate(program);
+    }
     LOG("\nEnd Validating.\n");
 
     LOG("\nBegin Generation.");
-    FILE* out = fopen(program->name, "w");
-    if(out == NULL) {
-        perror(program->name);
-        exit(1);
-    }
-    generator_generate(out);
-    if(fclose(out) == EOF) {
-        perror(program->name);
-        exit(1);
+    alloc_phase("generate");
+    if(options.split) {
+        if(options.emitIR) {
+            error(NULL, 0, "--split cannot be used with --ir\n");
+        }
+        if(options.hashName) {
+            error(NULL, 0, "--hash-name cannot be used with --split\n");
+        }
+        generator_generateSplit(program->name);
+    } else {
+        char* data;
+        size_t length;
+        FILE* out = open_memstream(&data, &length);
+        generator_generate(out);
+        fclose(out);
+        if(options.hashName) {
+            char* filename = hashFilename(program->name, (unsigned char*)data, length);
+            writeOutput(filename, (unsigned char*)data, length);
+            printf("%s\n", filename);
+            free(filename);
+        } else {
+            writeOutput(program->name, (unsigned char*)data, length);
+        }
+        free(data);
     }
     LOG("\nEnd Generation.");
+    if(options.mapStats) {
+        printf("%-40s %8s %8s %6s %8s %10s %8s\n", "scope", "keys", "buckets", "load", "longest", "lookups", "probes");
+        printMapStats("files", fileMap);
+        printMapStats("types", typeMap);
+        char path[1024] = "";
+        printScopeStats(program, path);
+    }
+    if(options.memReport) {
+        alloc_report(stdout);
+    }
+    if(options.time) {
+        alloc_timeReport(stdout);
+    }
 
     printf("Done.\n");
-    return 0;
+    return NULL;
 }
 
 /*
@@ -103,6 +256,7 @@ int main(int argn, char** argv) {
     to the program structure. */
 static void readInputFile(char* filename) {
     LOG("Reading file %s", filename);
+    alloc_phase("read");
     FILE* file = fopen(filename, "r");
     if(file == NULL) {
         perror(filename);
@@ -121,14 +275,11 @@ static void readInputFile(char* filename) {
     map_put(fileMap, filename, fileStruct);
     LOG("End file reading");
 
-    LOG("\n\nBegin Tokenization.");
-    struct list* tokenQueue = lexer_tokenize(filestring, filename);
-    LOG("\nEnd Tokenization\n");
-
+    // Tokens are lexed as the parser takes them
     LOG("\n\nBegin Parsing.");
-    parser_removeComments(tokenQueue);
-    parser_condenseArrayIdentifiers(tokenQueue);
-    while(!list_isEmpty(tokenQueue)) {
+    alloc_phase("parse");
+    struct tokenStream* tokenQueue = lexer_open(filestring, filename);
+    while(!lexer_isEmpty(tokenQueue)) {
         struct symbolNode* node = parser_parseTokens(tokenQueue, program);
         if(node == NULL) break;
         LOG("%s", node->name);
@@ -136,9 +287,136 @@ static void readInputFile(char* filename) {
             error(node->filename, node->line, "Module %s already defined in program", node->name);
         }
     }
+    lexer_close(tokenQueue);
     LOG("\nEnd Parsing.\n");
 }
 
+/*
+    Writes an output file, and compressed copies of it named with .gz and .br
+    added on, for each compression format asked for. Servers can then send the
+    compressed copies as they are. 
+    
+    Files are only written if they would change, so that tools watching the
+    output do not rebuild, and browsers do not fetch it again, for nothing. 
+    Compressed copies are always made again, since the level they are made
+    with may have changed, and a copy left by a run that was stopped may be
+    cut short. They are only written if they come out different. */
+void writeOutput(const char* filename, const unsigned char* data, int length) {
+    writeChanged(filename, data, length);
+    if(!options.gzip && !options.brotli) {
+        return;
+    }
+    char* compressedName = (char*)malloc(strlen(filename) + 4);
+    int compressedLength;
+    unsigned char* compressed;
+    if(options.gzip) {
+        sprintf(compressedName, "%s.gz", filename);
+        compressed = compress_gzip(data, length, options.level, &compressedLength);
+        writeChanged(compressedName, compressed, compressedLength);
+        free(compressed);
+    }
+    if(options.brotli) {
+        sprintf(compressedName, "%s.br", filename);
+        compressed = compress_brotli(data, length, options.level, &compressedLength);
+        writeChanged(compressedName, compressed, compressedLength);
+        free(compressed);
+    }
+    free(compressedName);
+}
+
+/*
+    Writes a buffer to a file, unless the file already holds it */
+static void writeChanged(const char* filename, const unsigned char* data, int length) {
+    if(!sameContents(filename, data, length)) {
+        writeFile(filename, data, length);
+    }
+}
+
+/*
+    Writes a buffer to a file */
+static void writeFile(const char* filename, const unsigned char* data, int length) {
+    FILE* file = fopen(filename, "wb");
+    if(file == NULL) {
+        perror(filename);
+        exit(1);
+    }
+    fwrite(data, 1, length, file);
+    if(fclose(file) == EOF) {
+        perror(filename);
+        exit(1);
+    }
+}
+
+/*
+    Returns whether a file already holds exactly what is in a buffer. Files 
+    that are a different length are not read */
+static int sameContents(const char* filename, const unsigned char* data, int length) {
+    FILE* file = fopen(filename, "rb");
+    if(file == NULL) {
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    int same = ftell(file) == length;
+    fseek(file, 0, SEEK_SET);
+    unsigned char block[65536];
+    int start = 0;
+    while(same && start < length) {
+        int size = length - start < (int)sizeof(block) ? length - start : (int)sizeof(block);
+        same = fread(block, 1, size, file) == (size_t)size && !memcmp(block, data + start, size);
+        start += size;
+    }
+    fclose(file);
+    return same;
+}
+
+/*
+    Puts a hash of the output into a filename, before its extension, so that
+    "out.js" becomes "out.1b2c3d4e.js". The hash is 32 bit FNV-1a. */
+static char* hashFilename(const char* filename, const unsigned char* data, int length) {
+    unsigned int hash = 2166136261u;
+    for(int i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    char* retval = (char*)malloc(strlen(filename) + 10);
+    const char* extension = strrchr(filename, '.');
+    const char* slash = strrchr(filename, '/');
+    if(extension == NULL || (slash != NULL && extension < slash)) {
+        extension = filename + strlen(filename);
+    }
+    sprintf(retval, "%.*s.%08x%s", (int)(extension - filename), filename, hash, extension);
+    return retval;
+}
+
+/*
+    Prints one row of the --map-stats table. Probes are the average number of
+    keys compared for each lookup */
+static void printMapStats(const char* name, struct map* map) {
+    struct mapStats stats;
+    map_stats(map, &stats);
+    double probes = stats.lookups > 0 ? (double)stats.probes / stats.lookups : 0;
+    printf("%-40s %8d %8d %6.2f %8d %10ld %8.2f\n", name, stats.size, stats.capacity, 
+        (double)stats.size / stats.capacity, stats.maxChain, stats.lookups, probes);
+}
+
+/*
+    Prints the map stats of a scope and each scope in it, named by the path of
+    names from the program down to them */
+static void printScopeStats(struct symbolNode* scope, char* path) {
+    int length = strlen(path);
+    if(scope != program) {
+        snprintf(path + length, 1024 - length, "%s%s", length > 0 ? "." : "", scope->name);
+    }
+    if(scope->children->size > 0 || scope->children->lookups > 0) {
+        printMapStats(scope == program ? "program" : path, scope->children);
+    }
+    struct list* children = scope->children->keyList;
+    struct listElem* elem;
+    for(elem = list_begin(children); elem != list_end(children); elem = list_next(elem)) {
+        printScopeStats(map_get(scope->children, elem->data), path);
+    }
+    path[length] = '\0';
+}
+
 /*
     Takes a pointer to a character, prints characters out until reaches new 
     line or end of string */
@@ -7,6 +7,9 @@
 #ifndef MAIN_H
 #define MAIN_H
 
+// Bytes of stack given to each thread that validates or generates code
+#define STACK_SIZE (256L * 1024 * 1024)
+
 /*
     Represents a file, holds an array of lines, and the number of lines.
     
@@ -18,9 +21,34 @@ struct file {
     int nLines;
 };
 
-struct symbolNode* program;
-struct map* fileMap;
+/*
+    Flags given on the command line that change how a program is compiled.
+    Set by main before any files are read, read by later stages. */
+struct options {
+    int emitIR; // generate functions from their IR rather than their AST
+    int dumpIR; // print the IR of every function to stdout
+    int minify; // shorten names and leave out optional whitespace and semicolons
+    int split;  // write each module to its own ES module chunk
+    int stream; // validate and free the code of functions one at a time as they are written
+    int jobs;   // number of threads to generate code with
+    int gzip;   // also write a gzip compressed copy of each output file
+    int brotli; // also write a brotli compressed copy of each output file
+    int level;  // how hard to compress, from 0 to 9
+    int instrument;     // count calls and time functions in the generated code
+    char* profileUse;   // profile to order and inline functions by, NULL for none
+    int heap;   // keep structs as records in one ArrayBuffer rather than as objects
+    int memReport;  // print the memory used by each phase of the compiler
+    int time;   // print the seconds spent in each phase of the compiler
+    int mapStats;   // print how well the map of each scope spreads its keys
+    int hashName;   // put a hash of the output in its filename, so browsers fetch it again when it changes
+    char* sizeReport;   // file to write the bytes of output from each symbol to as JSON, NULL for none
+};
+
+extern struct symbolNode* program;
+extern struct options options;
+extern struct map* fileMap;
 
 void error(const char* filename, int line, const char* msg, ...);
+void writeOutput(const char* filename, const unsigned char* data, int length);
 
 #endif
\ No newline at end of file
@@ -18,12 +18,14 @@
 #include <string.h>
 
 #include "./ast.h"
+#include "./lexer.h"
 #include "./main.h"
 #include "./parser.h"
 #include "./token.h"
 
 #include "../util/debug.h"
 #include "../util/map.h"
+#include "../util/vector.h"
 
 // Higher level token signatures
 static const enum tokenType MODULE[] = {TOKEN_IDENTIFIER, TOKEN_LBRACE};
@@ -46,99 +48,41 @@ static const enum tokenType EXTERN_FUNCTION[] = {TOKEN_IDENTIFIER, TOKEN_COLON,
 static const enum tokenType CALL[] = {TOKEN_IDENTIFIER, TOKEN_LPAREN};
 static const enum tokenType VERBATIM[] = {TOKEN_VERBATIM, TOKEN_LPAREN};
 
-static bool topMatches(struct list*, enum tokenType);
-static bool matchTokens(struct list*, const enum tokenType[], int);
-static const char* getTopFilename(struct list*);
-static int getTopLine(struct list*);
-static void copyNextTokenString(struct list*, char*);
-static void parseParams(struct list*, struct symbolNode*);
-static void parseEnums(struct list*, struct symbolNode*);
-static void expectType(struct list*, char*);
-static struct astNode* parseAST(struct list*, struct symbolNode*, struct astNode*);
-static struct astNode* parseExpression(struct list*, struct symbolNode*);
-static struct list* nextExpression(struct list*);
-static struct list* simplifyTokens(struct list*, struct symbolNode*);
-static struct list* infixToPostfix(struct list*);
-static void assertRemove(struct list*, enum tokenType);
-static void assertPeek(struct list*, enum tokenType);
+static bool topMatches(struct tokenStream*, enum tokenType);
+static bool matchTokens(struct tokenStream*, const enum tokenType[], int);
+static const char* getTopFilename(struct tokenStream*);
+static int getTopLine(struct tokenStream*);
+static void copyNextTokenString(struct tokenStream*, char*);
+static void parseParams(struct tokenStream*, struct symbolNode*);
+static void parseEnums(struct tokenStream*, struct symbolNode*);
+static void expectType(struct tokenStream*, char*);
+static void skipBody(struct tokenStream*, struct symbolNode*);
+static struct astNode* parseAST(struct tokenStream*, struct symbolNode*, struct astNode*);
+static struct astNode* parseFor(struct tokenStream*, struct symbolNode*, struct astNode*);
+static struct astNode* createBlock(const char*, int, struct symbolNode*, struct astNode*);
+static struct symbolNode* enclosingFunction(struct symbolNode*);
+static void defineLocal(struct astNode*, const char*, struct astNode*);
+static struct astNode* createVar(const char*, struct symbolNode*, struct astNode*);
+static struct astNode* createOperator(enum astType, const char*, struct astNode*, struct astNode*);
+static struct astNode* parseExpression(struct tokenStream*, struct symbolNode*);
+static struct tokenStream* nextExpression(struct tokenStream*);
+static struct tokenStream* simplifyTokens(struct tokenStream*, struct symbolNode*);
+static struct tokenStream* infixToPostfix(struct tokenStream*);
+static void assertRemove(struct tokenStream*, enum tokenType);
+static void assertPeek(struct tokenStream*, enum tokenType);
 static void assertOperator(enum astType, const char*, int);
 
-/*
-    Removes tokens from a list that are within comments */
-void parser_removeComments(struct list* tokenQueue) {
-    struct listElem* elem;
-    int withinComment = 0;
-    int tokenLine = -1;
-
-    for(elem=list_begin(tokenQueue);elem!=list_end(tokenQueue);elem=list_next(elem)) {
-        if(withinComment == 1) {
-            if(((struct token*)elem->data)->type == TOKEN_RBLOCK) {
-                withinComment = 0;
-                elem = elem->prev;
-                free(list_remove(tokenQueue, list_next(elem)));
-            } else {
-                elem = elem->prev;
-                free(list_remove(tokenQueue, list_next(elem)));
-            }
-        } else if(withinComment == 2) {
-            if(((struct token*)elem->data)->line != tokenLine) {
-                withinComment = 0;
-                tokenLine = -1;
-                elem = elem->prev;
-            } else {
-                elem = elem->prev;
-                free(list_remove(tokenQueue, list_next(elem)));
-            }
-        } else {
-            if(((struct token*)elem->data)->type == TOKEN_LBLOCK) {
-                withinComment = 1;
-                elem = elem->prev; // iterated at end of for loop
-                free(list_remove(tokenQueue, list_next(elem)));
-            } else if(((struct token*)elem->data)->type == TOKEN_DSLASH) {
-                withinComment = 2;
-                tokenLine = ((struct token*)elem->data)->line;
-                elem = elem->prev; // iterated at end of for loop
-                free(list_remove(tokenQueue, list_next(elem)));
-            }
-        }
-    }
-}
-
-/*
-    Goes through the token queue as a list, checks for array type 
-    modifiers "[]". Once found, concatonates the array modifier with 
-    a space and the token before it. The space is used because a legal identiier
-    cannot contain spaces, thus avoiding name collisions.
-    
-    This is used to make array type parsing easier. For example, the type the
-    variable i:
-        int[] i;
-    would be "int array". The brackets can be detected by the validator, and
-    reasoned with. */
-void parser_condenseArrayIdentifiers(struct list* tokenQueue) {
-    struct listElem* elem;
-    for(elem = list_begin(tokenQueue); elem != list_end(tokenQueue); elem = list_next(elem)) {
-        if(list_next(elem) != list_end(tokenQueue) &&
-        ((struct token*)elem->data)->type == TOKEN_IDENTIFIER &&
-        ((struct token*)(list_next(elem)->data))->type == TOKEN_ARRAY ) {
-            free(list_remove(tokenQueue, list_next(elem)));
-            strncat(((struct token*)elem->data)->data, " array", 255);
-            elem = elem->prev;
-        }
-    }
-}
-
 /*
     Goes through a token queue, parses out the first symbol off the front of 
     the queue, and assigns its parent to the given parent */
-struct symbolNode* parser_parseTokens(struct list* tokenQueue, struct symbolNode* parent) {
+struct symbolNode* parser_parseTokens(struct tokenStream* tokenQueue, struct symbolNode* parent) {
     struct symbolNode* symbolNode;
     int isPrivate = topMatches(tokenQueue, TOKEN_PRIVATE);
-    if(isPrivate) free(queue_pop(tokenQueue));
+    if(isPrivate) token_destroy(lexer_next(tokenQueue));
     int isStatic = topMatches(tokenQueue, TOKEN_STATIC);
-    if(isStatic) free(queue_pop(tokenQueue));
+    if(isStatic) token_destroy(lexer_next(tokenQueue));
     int isConstant = topMatches(tokenQueue, TOKEN_CONST);
-    if(isConstant) free(queue_pop(tokenQueue));
+    if(isConstant) token_destroy(lexer_next(tokenQueue));
 
     // END OF MODULE, RETURN
     if(topMatches(tokenQueue, TOKEN_RBRACE)) {
@@ -249,7 +193,11 @@ struct symbolNode* parser_parseTokens(struct list* tokenQueue, struct symbolNode
             assertRemove(tokenQueue, TOKEN_SEMICOLON);
         } else if(topMatches(tokenQueue, TOKEN_LBRACE)) {
             symbolNode->isDeclared = 1;
-            symbolNode->code = parseAST(tokenQueue, symbolNode, NULL);
+            if(options.stream && parent->symbolType == SYMBOL_MODULE) {
+                skipBody(tokenQueue, symbolNode);
+            } else {
+                symbolNode->code = parseAST(tokenQueue, symbolNode, NULL);
+            }
         } else {
             symbolNode->symbolType = SYMBOL_FUNCTIONPTR;
             struct symbolNode* anon = symbol_create(SYMBOL_BLOCK, parent, getTopFilename(tokenQueue), getTopLine(tokenQueue));
@@ -260,16 +208,64 @@ struct symbolNode* parser_parseTokens(struct list* tokenQueue, struct symbolNode
     } else if(topMatches(tokenQueue, TOKEN_EOF)){
         return NULL;
     } else {
-        error(getTopFilename(tokenQueue), getTopLine(tokenQueue), "Unexpected tokens %s", token_toString(((struct token*) queue_peek(tokenQueue))->type));
+        error(getTopFilename(tokenQueue), getTopLine(tokenQueue), "Unexpected tokens %s", token_toString(((struct token*) lexer_peek(tokenQueue, 0))->type));
     }
     return symbolNode;
 }
 
+/*
+    Parses the body of a function that was skipped over when streaming. Does
+    nothing if the function's body has already been parsed */
+void parser_parseBody(struct symbolNode* function) {
+    if(function->body == NULL) {
+        return;
+    }
+    struct tokenStream* tokenQueue = lexer_openAt(function->body, function->filename, function->bodyPosition, function->bodyLine);
+    function->hasParallelLoop = 0;
+    function->code = parseAST(tokenQueue, function, NULL);
+    function->body = NULL;
+    lexer_close(tokenQueue);
+}
+
+/*
+    Skips over the body of a module's function when streaming, keeping where
+    it starts so that it is only parsed right before the function is written.
+    
+    Bodies that define functions, structs, or enums are parsed right away, 
+    since those are written out with the rest of the program. */
+static void skipBody(struct tokenStream* tokenQueue, struct symbolNode* function) {
+    struct token* brace = lexer_peek(tokenQueue, 0);
+    function->body = tokenQueue->file;
+    function->bodyPosition = brace->position;
+    function->bodyLine = brace->line;
+    int depth = 0;
+    int definesSymbols = 0;
+    do {
+        if(topMatches(tokenQueue, TOKEN_EOF)) {
+            assertRemove(tokenQueue, TOKEN_RBRACE);
+        }
+        definesSymbols |= matchTokens(tokenQueue, FUNCTION, 3) || matchTokens(tokenQueue, EXTERN_FUNCTION, 5) ||
+            topMatches(tokenQueue, TOKEN_STRUCT) || topMatches(tokenQueue, TOKEN_ENUM);
+        struct token* token = lexer_next(tokenQueue);
+        if(token->type == TOKEN_LBRACE) {
+            depth++;
+        } else if(token->type == TOKEN_RBRACE) {
+            depth--;
+        } else if(token->type == TOKEN_PARALLEL) {
+            function->hasParallelLoop = 1;
+        }
+        token_destroy(token);
+    } while(depth > 0);
+    if(definesSymbols) {
+        parser_parseBody(function);
+    }
+}
+
 /*
     Returns whether or not the top of the tokenQueue has the specified type. */
-static bool topMatches(struct list* tokenQueue, enum tokenType type) {
-    ASSERT(!list_isEmpty(tokenQueue));
-    return ((struct token*)queue_peek(tokenQueue))->type == type;
+static bool topMatches(struct tokenStream* tokenQueue, enum tokenType type) {
+    ASSERT(!lexer_isEmpty(tokenQueue));
+    return ((struct token*)lexer_peek(tokenQueue, 0))->type == type;
 }
 
 /*
@@ -277,40 +273,38 @@ static bool topMatches(struct list* tokenQueue, enum tokenType type) {
     tokenQueue.
     
     Does NOT overrun off edge of tokenQueue, instead returns false. */
-static bool matchTokens(struct list* tokenQueue, const enum tokenType sig[], int nTokens) {
-    int i = 0;
-    struct listElem* elem;
-    for(elem = list_begin(tokenQueue); elem != list_end(tokenQueue) && i < nTokens; elem = list_next(elem), i++) {
-        struct token* token = (struct token*) (elem->data);
-        if(token->type != sig[i]) {
+static bool matchTokens(struct tokenStream* tokenQueue, const enum tokenType sig[], int nTokens) {
+    for(int i = 0; i < nTokens; i++) {
+        struct token* token = lexer_peek(tokenQueue, i);
+        if(token == NULL || token->type != sig[i]) {
             return false;
         }
     }
-    return i == nTokens;
+    return true;
 }
 
 /*
     Returns the filename of token at the front of the tokenQueue */
-static const char* getTopFilename(struct list* tokenQueue) {
-    ASSERT(!list_isEmpty(tokenQueue));
-    return ((struct token*)queue_peek(tokenQueue))->filename;
+static const char* getTopFilename(struct tokenStream* tokenQueue) {
+    ASSERT(!lexer_isEmpty(tokenQueue));
+    return ((struct token*)lexer_peek(tokenQueue, 0))->filename;
 }
 
 /*
     Returns the line number of the token at the front of the tokenQueue */
-static int getTopLine(struct list* tokenQueue) {
-    ASSERT(!list_isEmpty(tokenQueue));
-    return ((struct token*)queue_peek(tokenQueue))->line;
+static int getTopLine(struct tokenStream* tokenQueue) {
+    ASSERT(!lexer_isEmpty(tokenQueue));
+    return ((struct token*)lexer_peek(tokenQueue, 0))->line;
 }
 
 /*
     Pops a token off from the front of a queue, copies the string data of that
     token into a given string. Max size is 255 characters, including null term. */
-static void copyNextTokenString(struct list* tokenQueue, char* dest) {
+static void copyNextTokenString(struct tokenStream* tokenQueue, char* dest) {
     assertPeek(tokenQueue, TOKEN_IDENTIFIER);
-    struct token* nextToken = (struct token*) queue_pop(tokenQueue);
+    struct token* nextToken = (struct token*) lexer_next(tokenQueue);
     strncat(dest, nextToken->data, 254);
-    free(nextToken);
+    token_destroy(nextToken);
 }
 
 /*
@@ -330,7 +324,7 @@ char* itoa(int val) {
     to a parent symbol. Used for function parameters and struct fields.
     
     Parenthesis are removed in this function as well.*/
-static void parseParams(struct list* tokenQueue, struct symbolNode* parent) {
+static void parseParams(struct tokenStream* tokenQueue, struct symbolNode* parent) {
     assertRemove(tokenQueue, TOKEN_LPAREN);
     // Parse parameters of function
     while(!topMatches(tokenQueue, TOKEN_RPAREN)) {
@@ -341,9 +335,9 @@ static void parseParams(struct list* tokenQueue, struct symbolNode* parent) {
         param->isDeclared = 1;
     
         if(topMatches(tokenQueue, TOKEN_COMMA)) {
-            free(queue_pop(tokenQueue));
+            token_destroy(lexer_next(tokenQueue));
         } else if(!topMatches(tokenQueue, TOKEN_RPAREN)){
-            error(getTopFilename(tokenQueue), getTopLine(tokenQueue), "Unexpected token %s in parameter list", ((struct token*)queue_peek(tokenQueue))->data);
+            error(getTopFilename(tokenQueue), getTopLine(tokenQueue), "Unexpected token %s in parameter list", ((struct token*)lexer_peek(tokenQueue, 0))->data);
         }
         LOG("New arg: %s %s", param->type, param->name);
     }
@@ -353,7 +347,7 @@ static void parseParams(struct list* tokenQueue, struct symbolNode* parent) {
 /*
     Takes in a token queue, reads in a list of enumerations, and adds them as
     children symbols to a parent symbol. */
-static void parseEnums(struct list* tokenQueue, struct symbolNode* parent) {
+static void parseEnums(struct tokenStream* tokenQueue, struct symbolNode* parent) {
     assertRemove(tokenQueue, TOKEN_LPAREN);
     // Parse enum names for enums
     while(!topMatches(tokenQueue, TOKEN_RPAREN)) {
@@ -367,9 +361,9 @@ static void parseEnums(struct list* tokenQueue, struct symbolNode* parent) {
         num->isDeclared = 1;
     
         if(topMatches(tokenQueue, TOKEN_COMMA)) {
-            free(queue_pop(tokenQueue));
+            token_destroy(lexer_next(tokenQueue));
         } else if(!topMatches(tokenQueue, TOKEN_RPAREN)){
-            error(getTopFilename(tokenQueue), getTopLine(tokenQueue), "Unexpected token %s in enum", ((struct token*)queue_peek(tokenQueue))->data);
+            error(getTopFilename(tokenQueue), getTopLine(tokenQueue), "Unexpected token %s in enum", ((struct token*)lexer_peek(tokenQueue, 0))->data);
         }
     }
     assertRemove(tokenQueue, TOKEN_RPAREN);
@@ -380,23 +374,16 @@ static void parseEnums(struct list* tokenQueue, struct symbolNode* parent) {
     instruction per call. 
     
     Will return NULL on empty semicolon statements */
-static struct astNode* parseAST(struct list* tokenQueue, struct symbolNode* scope, struct astNode* parent) {
+static struct astNode* parseAST(struct tokenStream* tokenQueue, struct symbolNode* scope, struct astNode* parent) {
     ASSERT(tokenQueue != NULL);
     ASSERT(scope != NULL);
     struct astNode* retval = NULL;
 
     // BLOCK
     if(topMatches(tokenQueue, TOKEN_LBRACE)) {
-        retval = ast_create(AST_BLOCK, getTopFilename(tokenQueue), getTopLine(tokenQueue), scope, parent);
-        struct symbolNode* symbolNode = symbol_create(SYMBOL_BLOCK, scope, getTopFilename(tokenQueue), getTopLine(tokenQueue));
-        retval->data = symbolNode;
-        symbolNode->isStatic = scope->isStatic;
-        strcpy(symbolNode->name, "_block");
-        strcat(symbolNode->name, itoa(symbolNode->id)); // done to prevent collisions with other blocks in scope
-        strcpy(symbolNode->type, scope->type); // blocks have same type as parent, to aid in validating return values
-        ASSERT(!map_put(scope->children, symbolNode->name, symbolNode));
+        retval = createBlock(getTopFilename(tokenQueue), getTopLine(tokenQueue), scope, parent);
         assertRemove(tokenQueue, TOKEN_LBRACE);
-        while(!list_isEmpty(tokenQueue) && !topMatches(tokenQueue, TOKEN_RBRACE)) {
+        while(!lexer_isEmpty(tokenQueue) && !topMatches(tokenQueue, TOKEN_RBRACE)) {
             struct astNode* child = parseAST(tokenQueue, retval->data, retval); // Can sometimes be NULL from semicolon statements, gaurd against
             if(child != NULL) {
                 queue_push(retval->children, child);
@@ -452,6 +439,10 @@ static struct astNode* parseAST(struct list* tokenQueue, struct symbolNode* scop
         queue_push(retval->children, expression);
         queue_push(retval->children, body);
     }
+    // FOR
+    else if (topMatches(tokenQueue, TOKEN_FOR) || topMatches(tokenQueue, TOKEN_PARALLEL)) {
+        retval = parseFor(tokenQueue, scope, parent);
+    }
     // RETURN
     else if (topMatches(tokenQueue, TOKEN_RETURN)) {
         retval = ast_create(AST_RETURN, getTopFilename(tokenQueue), getTopLine(tokenQueue), scope, parent);
@@ -469,11 +460,138 @@ static struct astNode* parseAST(struct list* tokenQueue, struct symbolNode* scop
     return retval;
 }
 
+/*
+    Parses a counted loop, which counts an int up from the start of a range to
+    just before its end:
+
+        for i in a..b { ... }
+
+    There is no AST type for counted loops. They are parsed into the while 
+    loop they stand for, in a block of their own:
+
+        { int i = a; int _end = b; while i < _end { ...; i = i + 1; } }
+
+    The end is only kept in a variable when it is not an int literal, so that
+    it is worked out once. Names starting with _ cannot be written in Orange,
+    so _end does not hide any of the program's own. The generator finds loops
+    of this shape, whether they came from a for loop or were written out by 
+    hand, and writes them as counted Javascript loops.
+
+    Parallel loops are parsed the same way, except that the while loop is a 
+    parallel loop, whose trips may be run on more than one thread:
+
+        parallel i in a..b { ... } */
+static struct astNode* parseFor(struct tokenStream* tokenQueue, struct symbolNode* scope, struct astNode* parent) {
+    const char* filename = getTopFilename(tokenQueue);
+    int line = getTopLine(tokenQueue);
+    struct astNode* retval = createBlock(filename, line, scope, parent);
+    struct symbolNode* block = retval->data;
+    int parallel = topMatches(tokenQueue, TOKEN_PARALLEL);
+    assertRemove(tokenQueue, parallel ? TOKEN_PARALLEL : TOKEN_FOR);
+
+    char counter[255] = "";
+    copyNextTokenString(tokenQueue, counter);
+    assertRemove(tokenQueue, TOKEN_IN);
+    defineLocal(retval, counter, parseExpression(tokenQueue, block));
+    assertRemove(tokenQueue, TOKEN_RANGE);
+    struct astNode* end = parseExpression(tokenQueue, block);
+    if(end->type != AST_INTLITERAL) {
+        defineLocal(retval, "_end", end);
+        end = createVar("_end", block, NULL);
+    }
+
+    struct astNode* loop = ast_create(parallel ? AST_PARALLEL : AST_WHILE, filename, line, block, retval);
+    if(parallel && enclosingFunction(block) != NULL) {
+        enclosingFunction(block)->hasParallelLoop = 1;
+    }
+    struct astNode* body = parseAST(tokenQueue, block, loop);
+    if(body == NULL || body->type != AST_BLOCK) {
+        error(filename, line, "%s loops must be followed by block statements", parallel ? "Parallel" : "For");
+    }
+    struct astNode* one = ast_create(AST_INTLITERAL, filename, line, body->data, NULL);
+    one->data = malloc(sizeof(int));
+    *(int*)one->data = 1;
+    struct astNode* increment = createOperator(AST_ADD, "+", createVar(counter, body->data, NULL), one);
+    struct astNode* step = createOperator(AST_ASSIGN, "=", createVar(counter, body->data, NULL), increment);
+    step->parent = body;
+    queue_push(body->children, step);
+
+    queue_push(loop->children, createOperator(AST_LESSER, "<", createVar(counter, block, NULL), end));
+    queue_push(loop->children, body);
+    queue_push(retval->children, loop);
+    return retval;
+}
+
+/*
+    Returns the function that a scope is in, or NULL if it is not in one */
+static struct symbolNode* enclosingFunction(struct symbolNode* scope) {
+    while(scope != NULL && scope->symbolType == SYMBOL_BLOCK) {
+        scope = scope->parent;
+    }
+    return scope != NULL && scope->symbolType == SYMBOL_FUNCTION ? scope : NULL;
+}
+
+/*
+    Creates an empty block AST, along with the symbol that holds its local
+    variables */
+static struct astNode* createBlock(const char* filename, int line, struct symbolNode* scope, struct astNode* parent) {
+    struct astNode* retval = ast_create(AST_BLOCK, filename, line, scope, parent);
+    struct symbolNode* symbolNode = symbol_create(SYMBOL_BLOCK, scope, filename, line);
+    retval->data = symbolNode;
+    symbolNode->isStatic = scope->isStatic;
+    strcpy(symbolNode->name, "_block");
+    strcat(symbolNode->name, itoa(symbolNode->id)); // done to prevent collisions with other blocks in scope
+    strcpy(symbolNode->type, scope->type); // blocks have same type as parent, to aid in validating return values
+    ASSERT(!map_put(scope->children, symbolNode->name, symbolNode));
+    return retval;
+}
+
+/*
+    Adds the definition of an int variable to the end of a block, as if
+    "int name = code;" had been written there */
+static void defineLocal(struct astNode* block, const char* name, struct astNode* code) {
+    struct symbolNode* scope = block->data;
+    struct symbolNode* symbolNode = symbol_create(SYMBOL_VARIABLE, scope, block->filename, block->line);
+    symbolNode->isStatic = scope->isStatic;
+    strcpy(symbolNode->type, "int");
+    strcpy(symbolNode->name, name);
+    symbolNode->code = code;
+    if(map_put(scope->children, symbolNode->name, symbolNode)) {
+        error(symbolNode->filename, symbolNode->line, "Symbol %s already defined in this scope", symbolNode->name);
+    }
+    struct astNode* define = ast_create(AST_SYMBOLDEFINE, block->filename, block->line, scope, block);
+    define->data = symbolNode;
+    queue_push(block->children, define);
+}
+
+/*
+    Creates an AST for a variable, which is found in the given scope */
+static struct astNode* createVar(const char* name, struct symbolNode* scope, struct astNode* parent) {
+    struct astNode* retval = ast_create(AST_VAR, scope->filename, scope->line, scope, parent);
+    retval->data = malloc(sizeof(char) * 255);
+    strncpy(retval->data, name, 254);
+    return retval;
+}
+
+/*
+    Creates an AST for a binary operator. Children are kept right first, like
+    parseExpression does. */
+static struct astNode* createOperator(enum astType type, const char* op, struct astNode* left, struct astNode* right) {
+    struct astNode* retval = ast_create(type, left->filename, left->line, left->scope, NULL);
+    retval->data = malloc(sizeof(char) * 255);
+    strncpy(retval->data, op, 254);
+    right->parent = retval;
+    queue_push(retval->children, right);
+    left->parent = retval;
+    queue_push(retval->children, left);
+    return retval;
+}
+
 /*
     Copies the type at the front of the tokenQueue to a given string. If the 
     type is external (IE contains the : operator), the type will have the 
     form module$type. */
-static void expectType(struct list* tokenQueue, char* dst) {
+static void expectType(struct tokenStream* tokenQueue, char* dst) {
     copyNextTokenString(tokenQueue, dst);
     if(topMatches(tokenQueue, TOKEN_COLON)) {
         assertRemove(tokenQueue, TOKEN_COLON);
@@ -486,22 +604,25 @@ static void expectType(struct list* tokenQueue, char* dst) {
 /*
     Given a token queue, extracts the front expression, parses it into an
     Abstract Syntax Tree. */
-static struct astNode* parseExpression(struct list* tokenQueue, struct symbolNode* scope) {
+static struct astNode* parseExpression(struct tokenStream* tokenQueue, struct symbolNode* scope) {
     LOG("Create Expression AST");
     ASSERT(tokenQueue != NULL);
     struct astNode* astNode = NULL;
     struct token* token = NULL;
-    struct list* rawExpression = nextExpression(tokenQueue);
-    if(list_isEmpty(rawExpression)) {
+    struct tokenStream* rawExpression = nextExpression(tokenQueue);
+    if(lexer_isEmpty(rawExpression)) {
         error(getTopFilename(tokenQueue), getTopLine(tokenQueue), "Expected expression");
     }
 
-    struct list* expression = infixToPostfix(simplifyTokens(rawExpression, scope));
-    struct list* argStack = list_create();
+    struct tokenStream* simplified = simplifyTokens(rawExpression, scope);
+    struct tokenStream* expression = infixToPostfix(simplified);
+    struct vector* argStack = vector_create();
+    lexer_close(rawExpression);
+    lexer_close(simplified);
     
-    while (!list_isEmpty(expression)) {
+    while (!lexer_isEmpty(expression)) {
         struct listElem* elem = NULL;
-        token = (struct token*)queue_pop(expression);
+        token = (struct token*)lexer_next(expression);
         astNode = ast_create(AST_NOP, token->filename, token->line, scope, NULL);
         int* intData;
         float* realData;
@@ -513,13 +634,13 @@ static struct astNode* parseExpression(struct list* tokenQueue, struct symbolNod
             intData = (int*)malloc(sizeof(int));
             *intData = atoi(token->data);
             astNode->data = intData;
-            stack_push(argStack, astNode);
+            vector_push(argStack, astNode);
             break;
         case TOKEN_REALLITERAL:
             realData = (float*)malloc(sizeof(float));
             *realData = atof(token->data);
             astNode->data = realData;
-            stack_push(argStack, astNode);
+            vector_push(argStack, astNode);
             break;
         case TOKEN_CALL:
         case TOKEN_VERBATIM:
@@ -536,46 +657,49 @@ static struct astNode* parseExpression(struct list* tokenQueue, struct symbolNod
             charData = (char*)malloc(sizeof(char) * 255);
             strncpy(charData, token->data, 254);
             astNode->data = charData;
-            stack_push(argStack, astNode);
+            vector_push(argStack, astNode);
             break;
         default: // Assume operator
             assertOperator(astNode->type, token->filename, token->line);
             charData = (char*)malloc(sizeof(char) * 255);
             strncpy(charData, token->data, 254);
             astNode->data = charData;
-            ASSERT(!list_isEmpty(argStack)); // if fails, can indicate token was not put onto argstack
-            struct astNode* rightAST = stack_pop(argStack);
+            ASSERT(!vector_isEmpty(argStack)); // if fails, can indicate token was not put onto argstack
+            struct astNode* rightAST = vector_pop(argStack);
             rightAST->parent = astNode;
             queue_push(astNode->children, rightAST); // Right
             if(astNode->type != AST_CAST && astNode->type != AST_NEW && astNode->type != AST_FREE) { // Don't do left side for unary operators
-                struct astNode* leftAST = stack_pop(argStack);
+                struct astNode* leftAST = vector_pop(argStack);
                 leftAST->parent = astNode;
                 queue_push(astNode->children, leftAST); // left
             }
-            stack_push(argStack, astNode);
+            vector_push(argStack, astNode);
             break;
         }
-        free(token);
+        token_destroy(token);
     }
     LOG("end Create Expression AST");
-    return stack_peek(argStack);
+    astNode = vector_peek(argStack);
+    lexer_close(expression);
+    vector_destroy(argStack);
+    return astNode;
 }
 
 /*
     Takes a queue of tokens, pops off the first expression and returns as a new
     queue. */
-static struct list* nextExpression(struct list* tokenQueue) {
+static struct tokenStream* nextExpression(struct tokenStream* tokenQueue) {
     LOG("Next expression");
     ASSERT(tokenQueue != NULL);
 
-    struct list* retval = list_create();
+    struct tokenStream* retval = lexer_createStream();
     int depth = 0;
     enum tokenType nextType;
 
     // Go through tokens, pick out the first expression. Stop when state determines expression is over
-    while(!list_isEmpty(tokenQueue)) {
-        ASSERT(!list_isEmpty(tokenQueue));
-        nextType = ((struct token*)queue_peek(tokenQueue))->type;
+    while(!lexer_isEmpty(tokenQueue)) {
+        ASSERT(!lexer_isEmpty(tokenQueue));
+        nextType = ((struct token*)lexer_peek(tokenQueue, 0))->type;
         if(nextType == TOKEN_LPAREN || nextType == TOKEN_LSQUARE) {
             depth++;
         } else if(nextType == TOKEN_RPAREN || nextType == TOKEN_RSQUARE) {
@@ -593,6 +717,10 @@ static struct list* nextExpression(struct list* tokenQueue) {
         if(nextType == TOKEN_LBRACE) {
             break;
         }
+        // RANGE EXIT
+        if(depth == 0 && nextType == TOKEN_RANGE) {
+            break;
+        }
         // END OF FILE EXIT
         if(nextType == TOKEN_EOF) {
             break;
@@ -601,9 +729,9 @@ static struct list* nextExpression(struct list* tokenQueue) {
         if(depth < 0) {
             break;
         }
-        ASSERT(!list_isEmpty(tokenQueue));
-        LOG("%s %s", token_toString(nextType), ((struct token*)queue_peek(tokenQueue))->data);
-        queue_push(retval, queue_pop(tokenQueue));
+        ASSERT(!lexer_isEmpty(tokenQueue));
+        LOG("%s %s", token_toString(nextType), ((struct token*)lexer_peek(tokenQueue, 0))->data);
+        lexer_push(retval, lexer_next(tokenQueue));
     }
     LOG("end Next Expression");
     return retval;
@@ -625,84 +753,88 @@ static struct list* nextExpression(struct list* tokenQueue) {
 
     Other tokens are just added to the retval queue
     */
-static struct list* simplifyTokens(struct list* tokenQueue, struct symbolNode* scope) {
+static struct tokenStream* simplifyTokens(struct tokenStream* tokenQueue, struct symbolNode* scope) {
     LOG("Simplify Tokens");
-    struct list* retval = list_create();
+    struct tokenStream* retval = lexer_createStream();
 
     // Go through each token in given expression token queue, add/reject/parse to retval
-    while(!list_isEmpty(tokenQueue)) {
+    while(!lexer_isEmpty(tokenQueue)) {
         // CALL
         if(matchTokens(tokenQueue, CALL, 2)) {
-            struct token* callName = ((struct token*)queue_pop(tokenQueue));
+            struct token* callName = ((struct token*)lexer_next(tokenQueue));
             struct token* call = token_create(TOKEN_CALL, callName->data, callName->filename, callName->line);
             call->line = callName->line;
-            free(callName);
+            token_destroy(callName);
 
             assertRemove(tokenQueue, TOKEN_LPAREN);
             
             // Go through each argument, create AST representing it
-            while(!list_isEmpty(tokenQueue) && !topMatches(tokenQueue, TOKEN_RPAREN)) {
+            while(!lexer_isEmpty(tokenQueue) && !topMatches(tokenQueue, TOKEN_RPAREN)) {
                 struct astNode* argAST = parseExpression(tokenQueue, scope);
                 queue_push(call->list, argAST);
 
                 if(topMatches(tokenQueue, TOKEN_COMMA)) {
-                    free(queue_pop(tokenQueue));
+                    token_destroy(lexer_next(tokenQueue));
                 }
             }
             assertRemove(tokenQueue, TOKEN_RPAREN);
 
-            queue_push(retval, call);
+            lexer_push(retval, call);
         // VERBATIM
         } else if(matchTokens(tokenQueue, VERBATIM, 2)) {
-            struct token* verbatim = ((struct token*)queue_pop(tokenQueue));
+            struct token* verbatim = ((struct token*)lexer_next(tokenQueue));
 
             assertRemove(tokenQueue, TOKEN_LPAREN);
             
             // Go through each argument, create AST representing it
-            while(!list_isEmpty(tokenQueue) && !topMatches(tokenQueue, TOKEN_RPAREN)) {
+            while(!lexer_isEmpty(tokenQueue) && !topMatches(tokenQueue, TOKEN_RPAREN)) {
                 struct astNode* argAST = parseExpression(tokenQueue, scope);
                 queue_push(verbatim->list, argAST);
 
                 if(topMatches(tokenQueue, TOKEN_COMMA)) {
-                    free(queue_pop(tokenQueue));
+                    token_destroy(lexer_next(tokenQueue));
                 }
             }
             assertRemove(tokenQueue, TOKEN_RPAREN);
 
-            queue_push(retval, verbatim);
+            lexer_push(retval, verbatim);
         } 
         // INDEX
         else if(topMatches(tokenQueue, TOKEN_LSQUARE)) {
-        ASSERT(!list_isEmpty(tokenQueue));
-            queue_push(retval, token_create(TOKEN_INDEX, "", getTopFilename(tokenQueue), getTopLine(tokenQueue)));
-            queue_push(retval, token_create(TOKEN_LPAREN, "(", getTopFilename(tokenQueue), getTopLine(tokenQueue)));
+        ASSERT(!lexer_isEmpty(tokenQueue));
+            lexer_push(retval, token_create(TOKEN_INDEX, "", getTopFilename(tokenQueue), getTopLine(tokenQueue)));
+            lexer_push(retval, token_create(TOKEN_LPAREN, "(", getTopFilename(tokenQueue), getTopLine(tokenQueue)));
             assertRemove(tokenQueue, TOKEN_LSQUARE);
 
             // extract expression for index, add to retval list, between anonymous parens
-            struct list* innerExpression = infixToPostfix(simplifyTokens(nextExpression(tokenQueue), scope));
-            struct listElem* elem;
-            for(elem = list_begin(innerExpression); elem != list_end(innerExpression); elem=list_next(elem)) {
-                queue_push(retval, elem->data);
+            struct tokenStream* rawInner = nextExpression(tokenQueue);
+            struct tokenStream* simplifiedInner = simplifyTokens(rawInner, scope);
+            struct tokenStream* innerExpression = infixToPostfix(simplifiedInner);
+            while(!lexer_isEmpty(innerExpression)) {
+                lexer_push(retval, lexer_next(innerExpression));
             }
+            lexer_close(rawInner);
+            lexer_close(simplifiedInner);
+            lexer_close(innerExpression);
 
             assertPeek(tokenQueue, TOKEN_RSQUARE);
-            struct token* rsquare = queue_pop(tokenQueue); // don't use topFilename/topLine here, expression could be empty, would crash
-            queue_push(retval, token_create(TOKEN_RPAREN, ")", rsquare->filename, rsquare->line));
-            free(rsquare);
+            struct token* rsquare = lexer_next(tokenQueue); // don't use topFilename/topLine here, expression could be empty, would crash
+            lexer_push(retval, token_create(TOKEN_RPAREN, ")", rsquare->filename, rsquare->line));
+            token_destroy(rsquare);
         }
         // CAST
         else if(topMatches(tokenQueue, TOKEN_CAST)) {
-            struct token* cast = queue_pop(tokenQueue);
+            struct token* cast = lexer_next(tokenQueue);
             assertRemove(tokenQueue, TOKEN_LPAREN);
-            struct token* type = queue_pop(tokenQueue);
+            struct token* type = lexer_next(tokenQueue);
             strcpy(cast->data, type->data);
             assertRemove(tokenQueue, TOKEN_RPAREN);
-            free(type);
-            queue_push(retval, cast);
+            token_destroy(type);
+            lexer_push(retval, cast);
         }
         // OTHER (just add to queue)
         else {
-            queue_push(retval, queue_pop(tokenQueue));
+            lexer_push(retval, lexer_next(tokenQueue));
         }
     }
     LOG("end Simplify Tokens");
@@ -721,51 +853,52 @@ static struct list* simplifyTokens(struct list* tokenQueue, struct symbolNode* s
         Infix:   4 * 5 + (3 - 9) 
         Postfix: 3 9 - 4 5 * +
     */
-static struct list* infixToPostfix(struct list* tokenQueue) {
+static struct tokenStream* infixToPostfix(struct tokenStream* tokenQueue) {
     LOG("Infix to Postfix");
-    struct list* retval = list_create();
-    struct list* opStack = list_create();
+    struct tokenStream* retval = lexer_createStream();
+    struct vector* opStack = vector_create();
     struct token* token = NULL;
 
     // Go through each token in expression token queue, rearrange to form postfix expression token queue
-    while(!list_isEmpty(tokenQueue)) {
-        token = ((struct token*) queue_pop(tokenQueue));
+    while(!lexer_isEmpty(tokenQueue)) {
+        token = ((struct token*) lexer_next(tokenQueue));
         // VALUE
         if(token->type == TOKEN_IDENTIFIER || token->type == TOKEN_INTLITERAL  
             || token->type == TOKEN_REALLITERAL || token->type == TOKEN_CALL 
             || token->type == TOKEN_CHARLITERAL 
             || token->type == TOKEN_STRINGLITERAL || token->type == TOKEN_FALSE
             || token->type == TOKEN_TRUE || token->type == TOKEN_VERBATIM) {
-            queue_push(retval, token);
+            lexer_push(retval, token);
         } 
         // OPEN PARENTHESIS
         else if (token->type == TOKEN_LPAREN) {
-            stack_push(opStack, token);
+            vector_push(opStack, token);
         } 
         // CLOSE PARENTHESIS
         else if (token->type == TOKEN_RPAREN) {
             // Pop all operations from opstack to retval until original ( paren is found
-            while(!list_isEmpty(opStack) && ((struct token*)stack_peek(opStack))->type != TOKEN_LPAREN) {
-                queue_push(retval, stack_pop(opStack));
+            while(!vector_isEmpty(opStack) && ((struct token*)vector_peek(opStack))->type != TOKEN_LPAREN) {
+                lexer_push(retval, vector_pop(opStack));
             }
-            ASSERT(!list_isEmpty(opStack));
-            stack_pop(opStack); // Remove (
+            ASSERT(!vector_isEmpty(opStack));
+            vector_pop(opStack); // Remove (
         } 
         // OPERATOR
         else {
             // Pop all operations from opstack until an operation of lower precedence is found
-            while(!list_isEmpty(opStack) && 
-            token_precedence(token->type) <= token_precedence(((struct token*)stack_peek(opStack))->type)) {
-                queue_push(retval, stack_pop(opStack));
+            while(!vector_isEmpty(opStack) && 
+            token_precedence(token->type) <= token_precedence(((struct token*)vector_peek(opStack))->type)) {
+                lexer_push(retval, vector_pop(opStack));
             }
-            stack_push(opStack, token);
+            vector_push(opStack, token);
         }
     }
 
     // Push all remaining operators to queue
-    while(!list_isEmpty(opStack)) {
-        queue_push(retval, stack_pop(opStack));
+    while(!vector_isEmpty(opStack)) {
+        lexer_push(retval, vector_pop(opStack));
     }
+    vector_destroy(opStack);
     LOG("end Infix to Postfix");
     return retval;
 }
@@ -773,12 +906,12 @@ static struct list* infixToPostfix(struct list* tokenQueue) {
 /*
     Verifies that the next token is what is expected, and removes it. Errors
     otherwise */
-static void assertRemove(struct list* tokenQueue, enum tokenType expected) {
-    ASSERT(!list_isEmpty(tokenQueue));
-    struct token* topToken = (struct token*) queue_peek(tokenQueue);
+static void assertRemove(struct tokenStream* tokenQueue, enum tokenType expected) {
+    ASSERT(!lexer_isEmpty(tokenQueue));
+    struct token* topToken = (struct token*) lexer_peek(tokenQueue, 0);
     enum tokenType actual = topToken->type;
     if(actual == expected) {
-        free(queue_pop(tokenQueue));
+        token_destroy(lexer_next(tokenQueue));
     } else {
         error(topToken->filename, topToken->line, "Unexpected token %s, expected %s", token_toString(actual), token_toString(expected));
     }
@@ -786,9 +919,9 @@ static void assertRemove(struct list* tokenQueue, enum tokenType expected) {
 
 /*
     Verifies that the next token is what is expected. Errors otherwise */
-static void assertPeek(struct list* tokenQueue, enum tokenType expected) {
-    ASSERT(!list_isEmpty(tokenQueue));
-    struct token* topToken = (struct token*) queue_peek(tokenQueue);
+static void assertPeek(struct tokenStream* tokenQueue, enum tokenType expected) {
+    ASSERT(!lexer_isEmpty(tokenQueue));
+    struct token* topToken = (struct token*) lexer_peek(tokenQueue, 0);
     enum tokenType actual = topToken->type;
     if(actual != expected) {
         error(topToken->filename, topToken->line, "Unexpected token %s, expected %s", token_toString(actual), token_toString(expected));
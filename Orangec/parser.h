@@ -7,12 +7,10 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include "./lexer.h"
 #include "./symbol.h"
 
-#include "../util/list.h"
-
-void parser_removeComments(struct list*);
-void parser_condenseArrayIdentifiers(struct list*);
-struct symbolNode* parser_parseTokens(struct list*, struct symbolNode*);
+struct symbolNode* parser_parseTokens(struct tokenStream*, struct symbolNode*);
+void parser_parseBody(struct symbolNode*);
 
 #endif
\ No newline at end of file
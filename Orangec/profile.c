@@ -0,0 +1,228 @@
+/*  profile.c
+
+    Programs compiled with --instrument count how often each function is 
+    called, and time how long each function runs for. The profile table can be
+    dumped as JSON from the program with orangeProfile.dump(), which gives an
+    object with an entry for each function that was called:
+
+        {"Module.function":{"calls":123,"time":4.56}, ...}
+
+    Functions are named after the modules and functions they are in, rather
+    than their UID, so that a profile still lines up with a program after it 
+    has been changed.
+
+    Compiling with --profile-use reads a profile back in. Functions that were 
+    called are written out first, most called first, and small functions that
+    were called often are inlined where they are called.
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./main.h"
+#include "./profile.h"
+
+#include "../util/debug.h"
+#include "../util/map.h"
+
+/*
+    A function, and where it goes when functions are ordered by a profile */
+struct rankedFunction {
+    struct symbolNode* function;
+    double calls;
+    int index; // position before ordering, keeps the sort stable
+};
+
+static struct map* entries = NULL; // qualified function name -> struct profileEntry*
+
+static const char* skipSpace(const char*);
+static const char* expectChar(const char*, char, const char*);
+static const char* readString(const char*, char*, int, const char*);
+static int compareCalls(const void*, const void*);
+
+/*
+    Reads a profile written by orangeProfile.dump(). Errors if the file cannot
+    be read, or is not in the form that dump() writes */
+void profile_read(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if(file == NULL) {
+        perror(filename);
+        exit(1);
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = (char*)malloc(length + 1);
+    text[fread(text, 1, length, file)] = '\0';
+    fclose(file);
+
+    entries = map_create();
+    const char* c = expectChar(text, '{', filename);
+    c = skipSpace(c);
+    while(*c != '}') {
+        char name[255];
+        struct profileEntry* entry = (struct profileEntry*)calloc(1, sizeof(struct profileEntry));
+        c = readString(c, name, sizeof(name), filename);
+        c = expectChar(c, ':', filename);
+        c = expectChar(c, '{', filename);
+        c = skipSpace(c);
+        while(*c != '}') {
+            char field[32];
+            char* end;
+            c = readString(c, field, sizeof(field), filename);
+            c = skipSpace(expectChar(c, ':', filename));
+            double value = strtod(c, &end);
+            if(end == c) {
+                error(NULL, 0, "Expected a number in profile %s\n", filename);
+            }
+            if(!strcmp(field, "calls")) {
+                entry->calls = value;
+            } else if(!strcmp(field, "time")) {
+                entry->time = value;
+            }
+            c = skipSpace(end);
+            if(*c == ',') {
+                c = skipSpace(c + 1);
+            }
+        }
+        c = skipSpace(c + 1);
+        if(*c == ',') {
+            c = skipSpace(c + 1);
+        }
+        char* key = (char*)malloc(strlen(name) + 1);
+        strcpy(key, name);
+        if(map_put(entries, key, entry)) {
+            free(key);
+            free(entry);
+        }
+        if(*c == '\0') {
+            error(NULL, 0, "Unexpected end of profile %s\n", filename);
+        }
+    }
+    free(text);
+}
+
+/*
+    Gives the profile entry for a function, or NULL if no profile was read or 
+    the function was never called in it */
+struct profileEntry* profile_get(struct symbolNode* function) {
+    if(entries == NULL) {
+        return NULL;
+    }
+    char* name = profile_functionName(function);
+    struct profileEntry* entry = map_get(entries, name);
+    free(name);
+    return entry;
+}
+
+/*
+    Gives the name a function has in a profile: the modules and functions it 
+    is in, and then its own name, with a dot between each. Other symbols are
+    named the same way in size reports. Returns a new string. */
+char* profile_functionName(struct symbolNode* function) {
+    char* name = (char*)calloc(1, 1);
+    int length = 0;
+    struct symbolNode* symbol;
+    for(symbol = function; symbol != NULL && symbol->symbolType != SYMBOL_PROGRAM; symbol = symbol->parent) {
+        if(symbol != function && symbol->symbolType != SYMBOL_MODULE && symbol->symbolType != SYMBOL_FUNCTION) {
+            continue;
+        }
+        int nameLength = strlen(symbol->name);
+        char* longer = (char*)malloc(length + nameLength + 2);
+        strcpy(longer, symbol->name);
+        if(length > 0) {
+            longer[nameLength] = '.';
+            strcpy(longer + nameLength + 1, name);
+        }
+        free(name);
+        name = longer;
+        length = strlen(name);
+    }
+    return name;
+}
+
+/*
+    Reorders a list of functions so that functions called in the profile come
+    first, most called first. Functions that were not called keep their order
+    after them. Nested functions follow the function they are in in the list, 
+    and are kept right after it, since --stream frees the code of a function
+    once the functions after it are not nested in it. */
+void profile_order(struct list* functionList) {
+    if(entries == NULL || list_isEmpty(functionList)) {
+        return;
+    }
+    int numFunctions = functionList->size;
+    struct rankedFunction* ranks = (struct rankedFunction*)malloc(sizeof(struct rankedFunction) * numFunctions);
+    int i = 0;
+    int outer = 0; // last function that is not nested in another
+    struct listElem* elem;
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem), i++) {
+        struct symbolNode* function = elem->data;
+        ranks[i].function = function;
+        ranks[i].index = i;
+        if(function->parent->symbolType != SYMBOL_BLOCK) {
+            struct profileEntry* entry = profile_get(function);
+            ranks[i].calls = entry != NULL ? entry->calls : 0;
+            outer = i;
+        } else {
+            ranks[i].calls = ranks[outer].calls;
+        }
+    }
+    qsort(ranks, numFunctions, sizeof(struct rankedFunction), compareCalls);
+    i = 0;
+    for(elem = list_begin(functionList); elem != list_end(functionList); elem = list_next(elem), i++) {
+        elem->data = ranks[i].function;
+    }
+    free(ranks);
+}
+
+static const char* skipSpace(const char* c) {
+    while(isspace(*c)) {
+        c++;
+    }
+    return c;
+}
+
+static const char* expectChar(const char* c, char expected, const char* filename) {
+    c = skipSpace(c);
+    if(*c != expected) {
+        error(NULL, 0, "Expected '%c' in profile %s\n", expected, filename);
+    }
+    return c + 1;
+}
+
+/*
+    Reads a string in quotes into dest, and gives where the string ends */
+static const char* readString(const char* c, char* dest, int size, const char* filename) {
+    c = expectChar(c, '"', filename);
+    int i = 0;
+    while(*c != '"') {
+        if(*c == '\0') {
+            error(NULL, 0, "Unexpected end of profile %s\n", filename);
+        }
+        if(i < size - 1) {
+            dest[i++] = *c;
+        }
+        c++;
+    }
+    dest[i] = '\0';
+    return c + 1;
+}
+
+/*
+    Orders functions by how often they were called, or the function they are
+    nested in was, most called first. Ties keep the order the functions were 
+    in. */
+static int compareCalls(const void* a, const void* b) {
+    const struct rankedFunction* rankA = (const struct rankedFunction*)a;
+    const struct rankedFunction* rankB = (const struct rankedFunction*)b;
+    if(rankA->calls != rankB->calls) {
+        return rankA->calls > rankB->calls ? -1 : 1;
+    }
+    return rankA->index - rankB->index;
+}
@@ -0,0 +1,27 @@
+/*  profile.h
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "./symbol.h"
+
+#include "../util/list.h"
+
+/*
+    How often a function was called in a profiled run, and how long it ran
+    for, including the functions it called */
+struct profileEntry {
+    double calls;
+    double time; // milliseconds
+};
+
+void profile_read(const char*);
+struct profileEntry* profile_get(struct symbolNode*);
+char* profile_functionName(struct symbolNode*);
+void profile_order(struct list*);
+
+#endif
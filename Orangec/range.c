@@ -0,0 +1,590 @@
+/*  range.c
+
+    Ints are 32 bit integers in the generated code. Int arithmetic is written
+    so that it wraps around the way 32 bit arithmetic does:
+
+        a + b  ->  (a+b|0)      a * b  ->  Math.imul(a,b)      a / b  ->  (a/b|0)
+
+    Most ints never get near 2^31 though, and the coercions get in the way of
+    reading hot loops. The range analysis works out the smallest and largest
+    values each int expression can have, so that the generator can leave the
+    coercion out wherever the result cannot leave the range of an int.
+
+    Ranges are worked out for the int locals of one function at a time, right
+    before the function is written. Each local's range is made to hold every
+    value it is given, by going over the assignments to it until no range
+    changes. A pass only needs to be made again if it changed the range of a
+    local after reading it, since otherwise going over the assignments again
+    gives each local the same values. Ranges that keep growing are widened to
+    the range of an int, so that this always ends. Constants hold the int they
+    are defined as, while parameters, fields, globals, and locals of other
+    functions can hold any int.
+
+    Locals start out with an empty range, or a full range if they are only
+    declared or are parameters. Each range is started the first time it is
+    used in the analysis of its function, rather than by going over the
+    function beforehand, since large functions take longer to go over than
+    anything else the analysis does.
+
+    Comparisons narrow the range of a local inside the body of the while or
+    if they are the condition of, as long as the body does not assign to the
+    local before its last statement. Both the analysis and the generator say
+    which bodies they are in with range_enter and range_leave, so that the
+    narrower ranges are used there. Ranges are also narrowed by casts from
+    enums, which are between 0 and the number of values in the enum, and by
+    array lengths, which are never negative. Lengths are taken to fit in an
+    int, since ints are what index arrays.
+
+    The range of each piece of int arithmetic is kept in its AST node, so
+    that long expressions are not gone over again for each operator in them.
+    Kept ranges are stamped, and the stamp is changed whenever a fact or the
+    range of a local changes, which makes every range kept before it stale.
+    Expressions inlined from other functions may be written by several 
+    threads at once, so no ranges are kept in them, see range_share.
+
+    Each thread writes its own functions, so each thread keeps its own state.
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <limits.h>
+#include <string.h>
+
+#include "./range.h"
+
+#include "../util/debug.h"
+#include "../util/list.h"
+#include "../util/map.h"
+
+/*
+    A comparison that is known to hold in the bodies that have been entered */
+struct fact {
+    struct symbolNode* var;
+    struct range range;
+    int depth; // number of bodies entered when the fact was found
+};
+
+// Comparisons are only remembered this many at a time, the rest are left out
+#define MAX_FACTS 256
+// Ranges are widened if they still grow after this many passes
+static const int WIDEN_PASSES = 3;
+
+static const struct range FULL = {INT_MIN, INT_MAX};
+static const struct range EMPTY = {1, 0};
+
+static __thread struct symbolNode* function = NULL;  // function whose locals have ranges
+static __thread long analysis = 0;   // stamp of the analysis being made, kept in locals whose range it started
+static __thread struct fact facts[MAX_FACTS];
+static __thread int numFacts = 0;
+static __thread int firstFact = 0;   // facts before this are from outside the nested function being looked at
+static __thread int depth = 0;
+static __thread int changed = 0;     // whether a range has grown in this pass after being read
+static __thread long pass = 0;       // stamp of the pass being made, kept in locals whose range it reads
+static __thread int widening = 0;    // whether ranges that grow go straight to FULL
+static __thread long stamp = 0;      // stamp of ranges kept in AST nodes that are still current
+static long lastStamp = 0;           // stamps are taken from here, so no two threads share one
+static __thread int sharing = 0;     // whether the AST being written may be written by other threads too
+
+static int isLocal(struct symbolNode*);
+static void startRange(struct symbolNode*);
+static void solve(struct astNode*);
+static void give(struct symbolNode*, struct range);
+static void addFacts(struct astNode*, struct astNode*, int);
+static void addFact(struct astNode*, enum astType, struct astNode*, struct astNode*);
+static enum astType opposite(enum astType);
+static enum astType mirror(enum astType);
+static int factHolds(struct symbolNode*, struct astNode*);
+static int assigns(struct astNode*, struct symbolNode*);
+static struct symbolNode* assignedLocal(struct astNode*);
+static struct range exact(struct astNode*);
+static struct range arithmetic(struct astNode*);
+static void restamp();
+static int isEmpty(struct range);
+static struct range join(struct range, struct range);
+static struct range meet(struct range, struct range);
+static int fitsInt(struct range);
+
+/*
+    Works out the range of each int local of a function. Given NULL, forgets
+    the ranges of the last function, so that every variable can hold any int. */
+void range_analyze(struct symbolNode* symbol) {
+    function = symbol;
+    restamp();
+    numFacts = 0;
+    firstFact = 0;
+    depth = 0;
+    if(function == NULL || function->code == NULL) {
+        function = NULL;
+        return;
+    }
+    analysis = stamp;
+
+    int passes;
+    widening = 0;
+    for(passes = 0, changed = 1; changed; passes++) {
+        widening = passes >= WIDEN_PASSES;
+        changed = 0;
+        restamp();
+        pass = stamp;
+        solve(function->code);
+        ASSERT(depth == 0);
+    }
+    LOG("Ranges of %s found in %d passes", function->name, passes);
+}
+
+/*
+    Narrows ranges to what is known inside one of the bodies of a while or an
+    if. Branch 0 is the body that runs when the condition holds, branch 1 is
+    the else body. Must be matched by a call to range_leave. */
+void range_enter(struct astNode* statement, int branch) {
+    depth++;
+    struct astNode* condition = statement->children->head.next->data;
+    struct astNode* body = branch == 0 ? statement->children->head.next->next->data : statement->children->head.next->next->next->data;
+    addFacts(condition, body, branch == 0);
+}
+
+/*
+    Forgets what was known inside the body that was entered last */
+void range_leave() {
+    depth--;
+    while(numFacts > 0 && facts[numFacts - 1].depth > depth) {
+        numFacts--;
+        restamp();
+    }
+}
+
+/*
+    Says whether the AST about to be written may be written by other threads
+    at the same time, as expressions inlined from other functions are. Ranges
+    of arithmetic in it are worked out without being kept in it. */
+void range_share(int on) {
+    sharing = on;
+}
+
+/*
+    Gives the range of values an int expression can have, after any coercion
+    it is written with */
+struct range range_get(struct astNode* node) {
+    switch(node->type) {
+    case AST_INTLITERAL: {
+        struct range retval = {*(int*)node->data, *(int*)node->data};
+        return retval;
+    }
+    case AST_VAR: {
+        struct symbolNode* var = symbol_findVar(node);
+        if(var != NULL && var->isConstant && var->code != NULL && var->code->type == AST_INTLITERAL) {
+            return range_get(var->code);
+        } else if(!isLocal(var)) {
+            return FULL;
+        }
+        startRange(var);
+        var->rangeRead = pass;
+        struct range retval = {var->minValue, var->maxValue};
+        for(int i = firstFact; i < numFacts; i++) {
+            if(facts[i].var == var) {
+                retval = meet(retval, facts[i].range);
+            }
+        }
+        return retval;
+    }
+    case AST_ADD:
+    case AST_SUBTRACT:
+    case AST_MULTIPLY:
+    case AST_DIVIDE: {
+        struct range retval = exact(node);
+        return fitsInt(retval) ? retval : FULL;
+    }
+    case AST_CAST: {
+        struct astNode* operand = node->children->head.next->data;
+        struct symbolNode* type = map_get(typeMap, operand->valueType);
+        if(!strcmp(operand->valueType, "int")) {
+            return range_get(operand);
+        } else if(type != NULL && type->symbolType == SYMBOL_ENUM) {
+            struct range retval = {0, type->children->size - 1};
+            return retval;
+        }
+        return FULL;
+    }
+    case AST_DOT: {
+        struct astNode* left = node->children->head.next->next->data;
+        struct astNode* right = node->children->head.next->data;
+        int length = strlen(left->valueType);
+        if(right->type == AST_VAR && !strcmp(right->data, "length") && length >= 6 && !strcmp(left->valueType + length - 6, " array")) {
+            struct range retval = {0, INT_MAX};
+            return retval;
+        }
+        return FULL;
+    }
+    default:
+        return FULL;
+    }
+}
+
+/*
+    Whether int arithmetic can be written as plain Javascript arithmetic,
+    because its result is always an int. Division only can if it divides by 1. */
+int range_fits(struct astNode* node) {
+    if(node->type == AST_DIVIDE) {
+        struct range divisor = range_get(node->children->head.next->data);
+        return divisor.min == 1 && divisor.max == 1;
+    }
+    return fitsInt(exact(node));
+}
+
+/*
+    Whether a variable is an int local of the function being analyzed */
+static int isLocal(struct symbolNode* var) {
+    if(var == NULL || function == NULL || var->symbolType != SYMBOL_VARIABLE || strcmp(var->type, "int")) {
+        return 0;
+    }
+    struct symbolNode* owner = var->parent;
+    while(owner != NULL && owner->symbolType == SYMBOL_BLOCK) {
+        owner = owner->parent;
+    }
+    return owner == function;
+}
+
+/*
+    Starts a local out with an empty range, or a full range if it is only 
+    declared or is a parameter, unless it was already started in this analysis */
+static void startRange(struct symbolNode* var) {
+    if(var->rangeAnalysis != analysis) {
+        int full = var->code == NULL || var->parent == function;
+        var->minValue = full ? FULL.min : EMPTY.min;
+        var->maxValue = full ? FULL.max : EMPTY.max;
+        var->rangeAnalysis = analysis;
+    }
+}
+
+/*
+    Goes over an AST once, giving each local the values assigned to it. Nested
+    functions may run at any time, so nothing that is known where they are
+    defined is used inside of them. */
+static void solve(struct astNode* node) {
+    if(node == NULL) {
+        return;
+    }
+    switch(node->type) {
+    case AST_SYMBOLDEFINE: {
+        struct symbolNode* symbol = node->data;
+        if(symbol->symbolType == SYMBOL_FUNCTION) {
+            int oldFirst = firstFact;
+            firstFact = numFacts;
+            restamp();
+            solve(symbol->code);
+            firstFact = oldFirst;
+            restamp();
+        } else if(symbol->code != NULL) {
+            solve(symbol->code);
+            if(isLocal(symbol)) {
+                give(symbol, range_get(symbol->code));
+            }
+        }
+    } break;
+    case AST_IF:
+    case AST_IFELSE:
+    case AST_WHILE:
+    case AST_PARALLEL:
+        solve(node->children->head.next->data);
+        range_enter(node, 0);
+        solve(node->children->head.next->next->data);
+        range_leave();
+        if(node->type == AST_IFELSE) {
+            range_enter(node, 1);
+            solve(node->children->head.next->next->next->data);
+            range_leave();
+        }
+        break;
+    default: {
+        struct listElem* elem;
+        for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+            solve(elem->data);
+        }
+        struct symbolNode* var = assignedLocal(node);
+        if(var != NULL) {
+            give(var, range_get(node->children->head.next->data));
+        }
+    }
+    }
+}
+
+/*
+    Grows the range of a local to hold a range of values given to it */
+static void give(struct symbolNode* var, struct range values) {
+    startRange(var);
+    struct range old = {var->minValue, var->maxValue};
+    struct range new = join(old, values);
+    if(new.min == old.min && new.max == old.max) {
+        return;
+    }
+    if(widening && !isEmpty(old)) {
+        new.min = new.min < old.min ? FULL.min : new.min;
+        new.max = new.max > old.max ? FULL.max : new.max;
+    }
+    var->minValue = new.min;
+    var->maxValue = new.max;
+    changed |= var->rangeRead == pass;
+    restamp();
+}
+
+/*
+    Remembers what a condition says about locals inside a body. Holds is
+    whether the condition is true in the body, rather than false. */
+static void addFacts(struct astNode* condition, struct astNode* body, int holds) {
+    enum astType type = condition->type;
+    if(type != AST_AND && type != AST_OR && type != AST_LESSER && type != AST_LESSEREQUAL && 
+            type != AST_GREATER && type != AST_GREATEREQUAL && type != AST_IS && type != AST_ISNT) {
+        return;
+    }
+    struct astNode* right = condition->children->head.next->data;
+    struct astNode* left = condition->children->head.next->next->data;
+    if(type == AST_AND || type == AST_OR) {
+        // Both sides of an && hold in its body, neither side of an || holds in its else body
+        if((type == AST_AND) == holds) {
+            addFacts(left, body, holds);
+            addFacts(right, body, holds);
+        }
+        return;
+    } else if(strcmp(left->valueType, "int") || strcmp(right->valueType, "int")) {
+        return;
+    }
+    if(!holds) {
+        type = opposite(type);
+    }
+    addFact(left, type, right, body);
+    addFact(right, mirror(type), left, body);
+}
+
+/*
+    Gives the comparison that holds when a comparison does not */
+static enum astType opposite(enum astType type) {
+    switch(type) {
+    case AST_IS:            return AST_ISNT;
+    case AST_ISNT:          return AST_IS;
+    case AST_LESSER:        return AST_GREATEREQUAL;
+    case AST_LESSEREQUAL:   return AST_GREATER;
+    case AST_GREATER:       return AST_LESSEREQUAL;
+    default:                return AST_LESSER;
+    }
+}
+
+/*
+    Gives the comparison that holds with its sides swapped */
+static enum astType mirror(enum astType type) {
+    switch(type) {
+    case AST_LESSER:        return AST_GREATER;
+    case AST_LESSEREQUAL:   return AST_GREATEREQUAL;
+    case AST_GREATER:       return AST_LESSER;
+    case AST_GREATEREQUAL:  return AST_LESSEREQUAL;
+    default:                return type;
+    }
+}
+
+/*
+    Remembers that "var type bound" holds in a body, if var is a local */
+static void addFact(struct astNode* var, enum astType type, struct astNode* bound, struct astNode* body) {
+    if(var->type != AST_VAR || numFacts == MAX_FACTS) {
+        return;
+    }
+    struct symbolNode* symbol = symbol_findVar(var);
+    if(!isLocal(symbol) || !factHolds(symbol, body)) {
+        return;
+    }
+    struct range range = range_get(bound);
+    struct range retval = FULL;
+    switch(type) {
+    case AST_IS:
+        retval = range;
+        break;
+    case AST_LESSER:
+        retval.max = range.max - 1;
+        break;
+    case AST_LESSEREQUAL:
+        retval.max = range.max;
+        break;
+    case AST_GREATER:
+        retval.min = range.min + 1;
+        break;
+    case AST_GREATEREQUAL:
+        retval.min = range.min;
+        break;
+    default:
+        return;
+    }
+    facts[numFacts].var = symbol;
+    facts[numFacts].range = retval;
+    facts[numFacts].depth = depth;
+    numFacts++;
+    restamp();
+}
+
+/*
+    Whether what is known about a local when a body starts still holds all
+    through the body. It does if nothing in the body assigns to the local,
+    other than the last statement of the body when that statement is itself
+    an assignment to the local, since it is run after everything else in the
+    body. An assignment nested in a last statement that is an if or a block 
+    may run before other statements nested with it, so it counts. */
+static int factHolds(struct symbolNode* var, struct astNode* body) {
+    struct listElem* elem;
+    struct astNode* last = list_isEmpty(body->children) ? NULL : body->children->tail.prev->data;
+    if(last != NULL && assignedLocal(last) != var) {
+        last = NULL;
+    }
+    for(elem = list_begin(body->children); elem != list_end(body->children); elem = list_next(elem)) {
+        if(elem->data != last && assigns(elem->data, var)) {
+            return 0;
+        }
+    }
+    // What the last statement assigns is still looked through
+    if(last != NULL) {
+        for(elem = list_begin(last->children); elem != list_end(last->children); elem = list_next(elem)) {
+            if(assigns(elem->data, var)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/*
+    Whether anything in an AST assigns to a variable. Each if and while asks
+    this of the bodies nested in it, so the answer is kept in the AST, for the
+    variable it was last asked about. */
+static int assigns(struct astNode* node, struct symbolNode* var) {
+    if(node == NULL) {
+        return 0;
+    } else if(node->assigned == var) {
+        return node->assignsLocal;
+    }
+    int retval = 0;
+    if(assignedLocal(node) == var) {
+        retval = 1;
+    } else if(node->type == AST_SYMBOLDEFINE) {
+        retval = assigns(((struct symbolNode*)node->data)->code, var);
+    } else {
+        struct listElem* elem;
+        for(elem = list_begin(node->children); elem != list_end(node->children) && !retval; elem = list_next(elem)) {
+            retval = assigns(elem->data, var);
+        }
+    }
+    node->assigned = var;
+    node->assignsLocal = retval;
+    return retval;
+}
+
+/*
+    Gives the local that an AST assigns to, or NULL if it is not an assignment
+    to a local */
+static struct symbolNode* assignedLocal(struct astNode* node) {
+    if(node->type != AST_ASSIGN) {
+        return NULL;
+    }
+    struct astNode* left = node->children->head.next->next->data;
+    if(left->type != AST_VAR) {
+        return NULL;
+    }
+    struct symbolNode* var = symbol_findVar(left);
+    return isLocal(var) ? var : NULL;
+}
+
+/*
+    Gives the range of the result of int arithmetic, before it is coerced. 
+    Uses the range kept in the node if it is still current, and the node is
+    not shared with other threads */
+static struct range exact(struct astNode* node) {
+    if(sharing) {
+        return arithmetic(node);
+    } else if(stamp == 0 || node->rangeStamp != stamp) {
+        struct range range = arithmetic(node);
+        node->minValue = range.min;
+        node->maxValue = range.max;
+        node->rangeStamp = stamp;
+        return range;
+    }
+    struct range retval = {node->minValue, node->maxValue};
+    return retval;
+}
+
+/*
+    Works out the range of the result of int arithmetic from the ranges of its
+    operands */
+static struct range arithmetic(struct astNode* node) {
+    struct range right = range_get(node->children->head.next->data);
+    struct range left = range_get(node->children->head.next->next->data);
+    if(isEmpty(left) || isEmpty(right)) {
+        return EMPTY;
+    }
+    struct range retval;
+    switch(node->type) {
+    case AST_ADD:
+        retval.min = left.min + right.min;
+        retval.max = left.max + right.max;
+        break;
+    case AST_SUBTRACT:
+        retval.min = left.min - right.max;
+        retval.max = left.max - right.min;
+        break;
+    case AST_MULTIPLY: {
+        long corners[] = {left.min * right.min, left.min * right.max, left.max * right.min, left.max * right.max};
+        retval.min = retval.max = corners[0];
+        for(int i = 1; i < 4; i++) {
+            retval.min = corners[i] < retval.min ? corners[i] : retval.min;
+            retval.max = corners[i] > retval.max ? corners[i] : retval.max;
+        }
+    } break;
+    case AST_DIVIDE:
+        if(right.min <= 0 && right.max >= 0) {
+            // Dividing by 0 gives 0 once coerced, anything else gives a smaller magnitude
+            long most = left.max > -left.min ? left.max : -left.min;
+            retval.min = -most;
+            retval.max = most;
+        } else {
+            // C division rounds towards zero too
+            long corners[] = {left.min / right.min, left.min / right.max, left.max / right.min, left.max / right.max};
+            retval.min = retval.max = corners[0];
+            for(int i = 1; i < 4; i++) {
+                retval.min = corners[i] < retval.min ? corners[i] : retval.min;
+                retval.max = corners[i] > retval.max ? corners[i] : retval.max;
+            }
+        }
+        break;
+    default:
+        PANIC("%s is not arithmetic", ast_toString(node->type));
+    }
+    return retval;
+}
+
+/*
+    Makes every range kept in AST nodes stale */
+static void restamp() {
+    stamp = __atomic_add_fetch(&lastStamp, 1, __ATOMIC_RELAXED);
+}
+
+static int isEmpty(struct range range) {
+    return range.min > range.max;
+}
+
+/*
+    Gives the smallest range that holds both ranges */
+static struct range join(struct range a, struct range b) {
+    if(isEmpty(a)) {
+        return b;
+    } else if(isEmpty(b)) {
+        return a;
+    }
+    struct range retval = {a.min < b.min ? a.min : b.min, a.max > b.max ? a.max : b.max};
+    return retval;
+}
+
+/*
+    Gives the range of values that are in both ranges */
+static struct range meet(struct range a, struct range b) {
+    struct range retval = {a.min > b.min ? a.min : b.min, a.max < b.max ? a.max : b.max};
+    return retval;
+}
+
+static int fitsInt(struct range range) {
+    return range.min >= INT_MIN && range.max <= INT_MAX;
+}
@@ -0,0 +1,29 @@
+/*  range.h
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#ifndef RANGE_H
+#define RANGE_H
+
+#include "./ast.h"
+#include "./symbol.h"
+
+/*
+    The smallest and largest values an int expression can have. Kept as longs,
+    so that the result of arithmetic on two ints can be held before it wraps
+    around. A range with its min above its max is empty. */
+struct range {
+    long min;
+    long max;
+};
+
+void range_analyze(struct symbolNode*);
+void range_enter(struct astNode*, int);
+void range_leave();
+void range_share(int);
+struct range range_get(struct astNode*);
+int range_fits(struct astNode*);
+
+#endif
@@ -19,15 +19,18 @@
 #include "./main.h"
 #include "./symbol.h"
 
+#include "../util/alloc.h"
 #include "../util/list.h"
 #include "../util/debug.h"
 
+struct map* typeMap;
+
 static int num_ids = 0;
 
 /*
     Allocates and initializes the program struct */
 struct symbolNode* symbol_create(enum symbolType symbolType, struct symbolNode* parent, const char* filename, int line) {
-    struct symbolNode* retval = (struct symbolNode*)calloc(1, sizeof(struct symbolNode));
+    struct symbolNode* retval = (struct symbolNode*)alloc_calloc(ALLOC_SYMBOL, 1, sizeof(struct symbolNode));
 
     retval->symbolType = symbolType;
     retval->parent = parent;
@@ -39,12 +42,29 @@ struct symbolNode* symbol_create(enum symbolType symbolType, struct symbolNode*
     return retval;
 }
 
+/*
+    Frees a symbol, its code, and all of its children. Does not remove the 
+    symbol from its parent. */
+void symbol_destroy(struct symbolNode* symbol) {
+    ast_destroy(symbol->code);
+    struct list* children = symbol->children->keyList;
+    struct listElem* elem;
+    for(elem = list_begin(children); elem != list_end(children); elem = list_next(elem)) {
+        symbol_destroy(map_get(symbol->children, elem->data));
+    }
+    map_destroy(symbol->children);
+    alloc_free(ALLOC_SYMBOL, symbol, sizeof(struct symbolNode));
+}
+
 /*
     Returns the symbol with the given name relative to a given starting scope.
     
     Will return NULL if no symbol with the name is found in any direct ancestor
     scopes. */
 struct symbolNode* symbol_find(const char* symbolName, const struct symbolNode* scope) {
+    if(scope->lookup != NULL) {
+        scope = scope->lookup;
+    }
     struct symbolNode* symbol = map_get(scope->children, symbolName);
     if(symbol != NULL) {
         return symbol;
@@ -55,6 +75,44 @@ struct symbolNode* symbol_find(const char* symbolName, const struct symbolNode*
     }
 }
 
+/*
+    Returns the symbol that a variable in an AST names, or NULL if there is 
+    none. Finding a name from deep inside nested blocks goes through every 
+    block around it, so the symbol is kept in the AST once it has been found. 
+    Scopes do not change after parsing, so a kept symbol stays right. */
+struct symbolNode* symbol_findVar(struct astNode* node) {
+    if(node->symbol == NULL) {
+        node->symbol = symbol_find(node->data, node->scope);
+    }
+    return node->symbol;
+}
+
+/*
+    Links each scope to the scope that symbol_find starts looking for names in
+    from it. That is the scope itself, unless it only holds blocks, like the 
+    block of an if that declares nothing, which is passed over for the scope 
+    around it. Finding a name then takes as long as the number of scopes 
+    around it that declare something, rather than how deep it is nested. 
+    
+    Called once the program is parsed, since scopes do not change after. */
+void symbol_linkScopes(struct symbolNode* symbol) {
+    struct list* children = symbol->children->keyList;
+    struct listElem* elem;
+    int onlyBlocks = 1;
+    for(elem = list_begin(children); elem != list_end(children) && onlyBlocks; elem = list_next(elem)) {
+        struct symbolNode* child = map_get(symbol->children, elem->data);
+        onlyBlocks = child->symbolType == SYMBOL_BLOCK;
+    }
+    if(onlyBlocks && symbol->parent != NULL && symbol->parent->lookup != NULL) {
+        symbol->lookup = symbol->parent->lookup;
+    } else {
+        symbol->lookup = symbol;
+    }
+    for(elem = list_begin(children); elem != list_end(children); elem = list_next(elem)) {
+        symbol_linkScopes(map_get(symbol->children, elem->data));
+    }
+}
+
 /*
     Searches a given module for a given member.
     
@@ -11,8 +11,8 @@
 
 #include "../util/map.h"
 
-struct map* typeMap;      // maps: struct#id -> symbolNode* struct  // @fix maybe this isn't holistic. 
-                                                                    //      Was done for struct_type->struct_symbol
+extern struct map* typeMap;      // maps: struct#id -> symbolNode* struct  // @fix maybe this isn't holistic. 
+                                                                           //      Was done for struct_type->struct_symbol
 
 enum symbolType {
     SYMBOL_PROGRAM,
@@ -42,10 +42,15 @@ struct symbolNode {
     char name[255];
     int id;
     struct astNode* code;
+    const char* body; // file of a function body left to be parsed when it is written, NULL otherwise
+    int bodyPosition;
+    int bodyLine;
 
     // Parse tree
     struct symbolNode* parent;
     struct map* children; // name -> other symbolNodes
+    struct symbolNode* lookup; // where names used here are looked for first, set by symbol_linkScopes
+    struct symbolNode* function; // function a variable is a local or parameter of, set when it is validated
 
     // Flags
     int isPrivate;  // only accessed by direct descendants (ie not root access operator ":")
@@ -53,6 +58,13 @@ struct symbolNode {
     int isConstant; // value cannot change
     int isDefined; // has value been given
     int isDeclared; // has value been stated
+    int hasParallelLoop; // function has a parallel loop in its code, not counting nested functions
+
+    // Range analysis, only kept for the int locals of the function being written
+    long minValue;  // smallest value the variable is ever given
+    long maxValue;  // largest value the variable is ever given
+    long rangeAnalysis; // analysis that started the range
+    long rangeRead; // pass of the analysis that last read the range
 
     // Metadata
     const char* filename;
@@ -60,7 +72,10 @@ struct symbolNode {
 };
 
 struct symbolNode* symbol_create(enum symbolType, struct symbolNode*, const char*, int);
+void symbol_destroy(struct symbolNode*);
 struct symbolNode* symbol_findExplicit(char*, char*, const struct symbolNode*, const char*, int);
 struct symbolNode* symbol_find(const char*, const struct symbolNode*);
+struct symbolNode* symbol_findVar(struct astNode*);
+void symbol_linkScopes(struct symbolNode*);
 
 #endif
\ No newline at end of file
@@ -13,20 +13,30 @@
 
 #include "./token.h"
 
+#include "../util/alloc.h"
 #include "../util/debug.h"
 
 /*
     Creates a token with a given type and data */
 struct token* token_create(enum tokenType type, char data[], const char* filename, int line) {
-    struct token* retval = (struct token*) malloc(sizeof(struct token));
+    struct token* retval = (struct token*)alloc_malloc(ALLOC_TOKEN, sizeof(struct token));
     retval->type = type;
     retval->list = list_create();
     retval->filename = filename;
     retval->line = line;
+    retval->position = 0;
     strncpy(retval->data, data, 254);
     return retval;
 }
 
+/*
+    Frees a token and its list. Anything in the list is NOT freed, since the 
+    ASTs in it are moved into the AST made from the token */
+void token_destroy(struct token* token) {
+    list_destroy(token->list);
+    alloc_free(ALLOC_TOKEN, token, sizeof(struct token));
+}
+
 /* Returns the precedence a token operator has */
 int token_precedence(enum tokenType type) {
     switch(type) {
@@ -88,6 +98,8 @@ char* token_toString(enum tokenType type) {
         return "token:SEMICOLON";
     case TOKEN_COLON:
         return "token:COLON";
+    case TOKEN_RANGE:
+        return "token:RANGE";
     case TOKEN_IDENTIFIER:
         return "token:IDENTFIER";
     case TOKEN_INTLITERAL:
@@ -158,6 +170,12 @@ char* token_toString(enum tokenType type) {
         return "token:ELSE";
     case TOKEN_WHILE:
         return "token:WHILE";
+    case TOKEN_FOR:
+        return "token:FOR";
+    case TOKEN_PARALLEL:
+        return "token:PARALLEL";
+    case TOKEN_IN:
+        return "token:IN";
     case TOKEN_RETURN:
         return "token:RETURN";
     case TOKEN_EOF:
@@ -16,7 +16,7 @@ enum tokenType {
     TOKEN_LPAREN, TOKEN_RPAREN, TOKEN_LSQUARE, TOKEN_RSQUARE, TOKEN_LBRACE,
 	TOKEN_RBRACE,
 	// Punctuation
-	TOKEN_COMMA, TOKEN_DOT, TOKEN_SEMICOLON, TOKEN_COLON,
+	TOKEN_COMMA, TOKEN_DOT, TOKEN_SEMICOLON, TOKEN_COLON, TOKEN_RANGE,
 	// Literals
 	TOKEN_IDENTIFIER, TOKEN_INTLITERAL, TOKEN_REALLITERAL, TOKEN_CHARLITERAL, 
 	TOKEN_STRINGLITERAL, TOKEN_TRUE, TOKEN_FALSE, TOKEN_NULL, TOKEN_VERBATIM,
@@ -34,7 +34,7 @@ enum tokenType {
 	// Modifiers
 	TOKEN_PRIVATE, TOKEN_STATIC, TOKEN_CONST, TOKEN_ARRAY,
 	// Control flow structures
-	TOKEN_IF, TOKEN_ELSE, TOKEN_WHILE, TOKEN_RETURN,
+	TOKEN_IF, TOKEN_ELSE, TOKEN_WHILE, TOKEN_FOR, TOKEN_PARALLEL, TOKEN_IN, TOKEN_RETURN,
 	// Anonymous tokens (added by parser)
 	TOKEN_EOF, TOKEN_CALL, TOKEN_INDEX,
 	// Comment tokens
@@ -51,9 +51,11 @@ struct token {
 	
 	const char* filename;
 	int line;
+	int position; // where the token starts in its file
 };
 
 struct token* token_create(enum tokenType, char[], const char*, int);
+void token_destroy(struct token*);
 int token_precedence(enum tokenType);
 char* token_toString(enum tokenType);
 
@@ -23,7 +23,12 @@
 static void updateType(struct symbolNode*);
 static void updateStruct(struct symbolNode*);
 static void validateAST(struct astNode*);
+static void validateParallel(struct astNode*, struct symbolNode*, struct symbolNode*, struct list*);
+static void findWrittenArrays(struct astNode*, struct list*);
+static struct symbolNode* arrayVar(struct astNode*);
+static bool isInside(struct symbolNode*, struct symbolNode*);
 static char* validateExpressionAST(struct astNode*);
+static char* expressionType(struct astNode*);
 static void validateBinaryOp(struct list*, char*, char*);
 static int findTypeEnd(const char*);
 static bool isPrimitive(const char*);
@@ -33,8 +38,11 @@ static bool validateType(const char*, const struct symbolNode*);
 static int validateFunctionTypesMatch(struct map*, struct map*, struct symbolNode*, const char*, int);
 static bool validateArrayType(struct list*, char*, struct symbolNode*, const char*, int);
 static int validateParamType(struct list*, struct map*, struct symbolNode*, const char*, int);
+static int countParams(struct map*);
 static char* validateStructField(char*, char*, const char*, int);
 
+static struct symbolNode* function = NULL; // function whose code is being validated
+
 /*
     Goes through the symbol tree, updates the types of symbols from the 
     written plain type to a "true" type, that is relates specifically to a type.
@@ -61,24 +69,31 @@ void validator_updateStructType(struct symbolNode* symbolNode) {
     ASSERT(symbolNode != NULL);
     struct list* children = symbolNode->children->keyList;
     struct listElem* elem = list_begin(children);
+    struct symbolNode* parent = symbolNode->parent;
     // Correct struct type, if exists
     switch(symbolNode->symbolType) {
+    case SYMBOL_BLOCK:
+        if(parent->symbolType == SYMBOL_FUNCTION || parent->symbolType == SYMBOL_BLOCK) {
+            // Blocks have the type of what they are in, which is updated before them
+            strcpy(symbolNode->type, parent->type);
+            break;
+        } // rollover ->
     case SYMBOL_VARIABLE:
     case SYMBOL_FUNCTIONPTR:
     case SYMBOL_FUNCTION:
-    case SYMBOL_BLOCK:
         if(strstr(symbolNode->type, "$")) {
             updateType(symbolNode);
         } else {
             updateStruct(symbolNode);
-        } // rollover to default ->
-    default: {
-        for(;elem != list_end(children); elem = list_next(elem)) {
-            struct symbolNode* child = (struct symbolNode*)map_get(symbolNode->children, (char*)elem->data);
-            ASSERT(child != NULL);
-            validator_updateStructType(child);
         }
-    } break;
+        break;
+    default:
+        break;
+    }
+    for(;elem != list_end(children); elem = list_next(elem)) {
+        struct symbolNode* child = (struct symbolNode*)map_get(symbolNode->children, (char*)elem->data);
+        ASSERT(child != NULL);
+        validator_updateStructType(child);
     }
 }
 
@@ -123,6 +138,7 @@ void validator_validate(struct symbolNode* symbolNode) {
     } break;
     case SYMBOL_FUNCTIONPTR:
     case SYMBOL_VARIABLE: {
+        symbolNode->function = function;
         // Valid type
         if(!validateType(symbolNode->type, symbolNode->parent)) {
             error(symbolNode->filename, symbolNode->line, "Unknown type %s", symbolNode->type);
@@ -145,26 +161,60 @@ void validator_validate(struct symbolNode* symbolNode) {
         if(!validateType(symbolNode->type, symbolNode->parent)) {
             error(symbolNode->filename, symbolNode->line, "Unknown type %s", symbolNode->type);
         }
+        struct symbolNode* outer = function;
+        function = symbolNode;
         // All children must be valid- done before AST validation so as to allow SYMBOL_BLOCK's to update their struct type
         for(;elem != list_end(children); elem = list_next(elem)) {
             validator_validate((struct symbolNode*)map_get(symbolNode->children, (char*)elem->data));
         }
         // Valid AST
         validateAST(symbolNode->code);
+        function = outer;
     } break;
     case SYMBOL_ENUM:
-    case SYMBOL_STRUCT:
-    case SYMBOL_BLOCK: {
+    case SYMBOL_STRUCT: {
         // All children must be valid
         for(;elem != list_end(children); elem = list_next(elem)) {
             validator_validate((struct symbolNode*)map_get(symbolNode->children, (char*)elem->data));
         }
     } break;
+    case SYMBOL_BLOCK:
+        // Symbols in a block are validated when their definition is reached in
+        // the block's code, after the symbols defined before them are declared
+        break;
     default:
         error("", 1, "Bad symbol\n");
     }
 }
 
+/*
+    Validates a program like validator_validate, except for functions, which 
+    are left to be validated one at a time with validator_validate right 
+    before they are generated. */
+void validator_validateDeclarations(struct symbolNode* program) {
+    ASSERT(program != NULL);
+    struct list* modules = program->children->keyList;
+    struct listElem* moduleElem = list_begin(modules);
+    for(;moduleElem != list_end(modules); moduleElem = list_next(moduleElem)) {
+        struct symbolNode* module = (struct symbolNode*)map_get(program->children, (char*)moduleElem->data);
+        ASSERT(module != NULL);
+        if(module->symbolType != SYMBOL_MODULE) {
+            error(module->filename, module->line, "Must be defined inside a module\n");
+        }
+        struct list* children = module->children->keyList;
+        struct listElem* elem = list_begin(children);
+        for(;elem != list_end(children); elem = list_next(elem)) {
+            struct symbolNode* child = (struct symbolNode*)map_get(module->children, (char*)elem->data);
+            ASSERT(child != NULL);
+            if(child->symbolType == SYMBOL_BLOCK) {
+                error(child->filename, child->line, "Module members must be structs, variables, or functions\n");
+            } else if(child->symbolType != SYMBOL_FUNCTION) {
+                validator_validate(child);
+            }
+        }
+    }
+}
+
 /*
     This function is called before validation when a function or variable has 
     a $ character as part of its type. The $ symbol indicate that the type is
@@ -246,7 +296,8 @@ static void validateAST(struct astNode* node) {
         validateAST(elseBlock);
         break;
     }
-    case AST_WHILE: {
+    case AST_WHILE:
+    case AST_PARALLEL: {
         struct astNode* condition = node->children->head.next->data;
         struct astNode* block = node->children->head.next->next->data;
         char *conditionType = validateExpressionAST(condition);
@@ -254,6 +305,18 @@ static void validateAST(struct astNode* node) {
             error(condition->filename, condition->line,"While expected boolean type, actual type was \"%s\" ", conditionType);
         }
         validateAST(block);
+        if(node->type == AST_PARALLEL) {
+            struct astNode* counter = condition->children->head.next->next->data;
+            struct list* written = list_create();
+            struct listElem* elem;
+            for(elem = list_begin(block->children); elem != block->children->tail.prev; elem = list_next(elem)) {
+                findWrittenArrays(elem->data, written);
+            }
+            for(elem = list_begin(block->children); elem != block->children->tail.prev; elem = list_next(elem)) {
+                validateParallel(elem->data, block->data, symbol_findVar(counter), written);
+            }
+            list_destroy(written);
+        }
         break;
     }
     case AST_RETURN: {
@@ -275,10 +338,152 @@ static void validateAST(struct astNode* node) {
     }
 }
 
+/*
+    Checks that a statement in the body of a parallel loop can be run on any
+    thread, in any order with the other trips of the loop. Each thread has its
+    own copy of the values the loop uses, other than arrays, so the body 
+    cannot call functions or use structs, and can only assign to its own 
+    locals, and to arrays at the loop's counter, which no other trip does. 
+    Arrays that are written, listed in written, can only be read at the 
+    loop's counter too, since other trips may be writing the rest. */
+static void validateParallel(struct astNode* node, struct symbolNode* body, struct symbolNode* counter, struct list* written) {
+    const char* cannot = NULL;
+    switch(node->type) {
+    case AST_CALL:
+    case AST_VERBATIM:
+        cannot = "call functions or verbatim code";
+        break;
+    case AST_NEW:
+    case AST_FREE:
+        cannot = "create or free structs and arrays";
+        break;
+    case AST_RETURN:
+        cannot = "return";
+        break;
+    case AST_MODULEACCESS:
+        cannot = "use members of modules";
+        break;
+    case AST_PARALLEL:
+        cannot = "have parallel loops in them";
+        break;
+    case AST_DOT: {
+        struct astNode* field = node->children->head.next->data;
+        if(field->type != AST_VAR || strcmp(field->data, "length")) {
+            cannot = "use the fields of structs";
+            break;
+        }
+        validateParallel(node->children->head.next->next->data, body, counter, written);
+        return;
+    }
+    case AST_INDEX: {
+        struct astNode* index = node->children->head.next->data;
+        struct symbolNode* array = arrayVar(node->children->head.next->next->data);
+        if(array != NULL && (index->type != AST_VAR || symbol_findVar(index) != counter)) {
+            struct listElem* elem;
+            for(elem = list_begin(written); elem != list_end(written); elem = list_next(elem)) {
+                if(elem->data == array) {
+                    error(node->filename, node->line, "Parallel loops can only read arrays they assign to at the loop's counter");
+                }
+            }
+        }
+    } break;
+    case AST_ASSIGN: {
+        struct astNode* left = node->children->head.next->next->data;
+        if(left->type == AST_INDEX) {
+            struct astNode* index = left->children->head.next->data;
+            if(index->type != AST_VAR || symbol_findVar(index) != counter) {
+                error(left->filename, left->line, "Parallel loops can only assign to arrays at the loop's counter");
+            }
+            validateParallel(left->children->head.next->next->data, body, counter, written);
+        } else if(left->type != AST_VAR || !isInside(symbol_findVar(left), body)) {
+            error(left->filename, left->line, "Parallel loops can only assign to their own locals, and to arrays at the loop's counter");
+        }
+        validateParallel(node->children->head.next->data, body, counter, written);
+        return;
+    }
+    case AST_BLOCK: {
+        struct symbolNode* block = node->data;
+        struct listElem* elem;
+        for(elem = list_begin(block->children->keyList); elem != list_end(block->children->keyList); elem = list_next(elem)) {
+            struct symbolNode* child = map_get(block->children, elem->data);
+            if(child->symbolType == SYMBOL_FUNCTION) {
+                error(child->filename, child->line, "Parallel loops cannot define functions");
+            }
+        }
+    } break;
+    case AST_SYMBOLDEFINE: {
+        struct symbolNode* var = node->data;
+        if(var->code != NULL) {
+            validateParallel(var->code, body, counter, written);
+        }
+    } break;
+    default:
+        break;
+    }
+    if(cannot != NULL) {
+        error(node->filename, node->line, "Parallel loops cannot %s", cannot);
+    }
+    struct listElem* elem;
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        validateParallel(elem->data, body, counter, written);
+    }
+}
+
+/*
+    Adds the variables of the arrays that an AST in the body of a parallel 
+    loop assigns to an element of to a list */
+static void findWrittenArrays(struct astNode* node, struct list* written) {
+    if(node == NULL) {
+        return;
+    } else if(node->type == AST_SYMBOLDEFINE) {
+        findWrittenArrays(((struct symbolNode*)node->data)->code, written);
+        return;
+    } else if(node->type == AST_ASSIGN) {
+        struct astNode* left = node->children->head.next->next->data;
+        struct symbolNode* array = left->type == AST_INDEX ? arrayVar(left->children->head.next->next->data) : NULL;
+        if(array != NULL) {
+            queue_push(written, array);
+        }
+    }
+    struct listElem* elem;
+    for(elem = list_begin(node->children); elem != list_end(node->children); elem = list_next(elem)) {
+        findWrittenArrays(elem->data, written);
+    }
+}
+
+/*
+    Returns the variable that an array is indexed from, going through the 
+    indexes of arrays of arrays, or NULL if it is not in a variable */
+static struct symbolNode* arrayVar(struct astNode* array) {
+    while(array->type == AST_INDEX) {
+        array = array->children->head.next->next->data;
+    }
+    return array->type == AST_VAR ? symbol_findVar(array) : NULL;
+}
+
+/*
+    Returns whether a symbol is defined in a scope, or in a scope in it */
+static bool isInside(struct symbolNode* symbol, struct symbolNode* scope) {
+    for(; symbol != NULL; symbol = symbol->parent) {
+        if(symbol == scope) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+    Validates an expression, and remembers its type in the AST so that later
+    stages do not have to work the type out again */
+static char* validateExpressionAST(struct astNode* node) {
+    node->valueType = expressionType(node);
+    return node->valueType;
+}
+
 /*
     Recursively goes through expression, checks to make sure that the type of 
     the inputs is correct, returns output type based on input */
-char* validateExpressionAST(struct astNode* node) {
+static char* expressionType(struct astNode* node) {
     char left[255], right[255];
     char* retval = (char*)malloc(sizeof(char) * 255);
 
@@ -286,10 +491,11 @@ char* validateExpressionAST(struct astNode* node) {
     switch(node->type){
     // BASE CASES
     case AST_VAR: {
-        struct symbolNode* var = symbol_find(node->data, node->scope);
+        struct symbolNode* var = symbol_findVar(node);
         if(var == NULL) {
             error(node->filename, node->line, "Unknown symbol %s", node->data);
-        } else if(!var->isDeclared) {
+        } else if(!var->isDeclared || (var->function != NULL && var->function != function)) {
+            // Nested functions are written outside the function they are in, so they cannot use its locals
             error(node->filename, node->line, "Symbol %s is undeclared", node->data);
         } else {
             strcpy(retval, var->type);
@@ -331,7 +537,7 @@ char* validateExpressionAST(struct astNode* node) {
             return retval;
         }
         
-        struct symbolNode* symbol = symbol_find(node->data, node->scope);
+        struct symbolNode* symbol = symbol_findVar(node);
         if(symbol == NULL) {
             error(node->filename, node->line, "Unknown symbol %s", node->data);
         // STRUCT INIT
@@ -359,12 +565,12 @@ char* validateExpressionAST(struct astNode* node) {
             }
             int err = validateParamType(node->children, symbol->children, node->scope, node->filename, node->line);
             
-            if(err == -1) {
+            if(err == 0) {
                 strcpy(retval, symbol->type);
                 return retval;
-            } else if(err > -1){
+            } else if(err > 0){
                 error(node->filename, node->line, "Too many arguments for function call");
-            } else if(err < -1){
+            } else if(err < 0){
                 error(node->filename, node->line, "Too few arguments for function call");
             }
         }
@@ -402,7 +608,7 @@ char* validateExpressionAST(struct astNode* node) {
         }
         // Constant assignment validation- find variable associated with assignment
         if(leftAST->type == AST_VAR) {
-            var = symbol_find(leftAST->data, leftAST->scope);
+            var = symbol_findVar(leftAST);
             if(var == NULL) {
                 error(node->filename, node->line, "Unknown symbol %s", node->data);
             }
@@ -545,10 +751,12 @@ char* validateExpressionAST(struct astNode* node) {
 
         struct symbolNode* symbol = symbol_findExplicit(leftAST->data, rightAST->data, node->scope, node->filename, node->line); // findExplicit throws errors itself, no need to check for NULL
         rightAST->scope = map_get(program->children, leftAST->data);
+        rightAST->symbol = NULL; // found again from its new scope
         if (rightAST->type == AST_CALL) { // Validate that the call is well formed
             validateExpressionAST(rightAST);
         }
-        return symbol->type;
+        strcpy(retval, symbol->type);
+        return retval;
     }
     default:
         PANIC("AST \"%s\" validation is not implemented yet", ast_toString(node->type));
@@ -690,7 +898,7 @@ static int validateFunctionTypesMatch(struct map* paramMap1, struct map* paramMa
             error(filename, line, "Type mismatch between function parameters #%d, Expected \"%s\", actual type was \"%s\" ", i, type1, type2);
         }
     }
-    return paramMap1->size - paramMap2->size;
+    return countParams(paramMap1) - countParams(paramMap2);
 }
 
 /*
@@ -710,8 +918,8 @@ static bool validateArrayType(struct list* args, char* expected, struct symbolNo
     Takes in a list of AST's representing expressions for arguments, checks each of their types against a map of given
     parameters, represented as symbolNodes.
     
-    Returns: 1 when too many args, 
-            -1 when too few args,
+    Returns: more than 0 when too many args, 
+             less than 0 when too few args,
              0 when okay args. */
 static int validateParamType(struct list* args, struct map* paramMap, struct symbolNode* scope, const char* filename, int line) {
     struct list* params = map_getKeyList(paramMap);
@@ -731,7 +939,7 @@ static int validateParamType(struct list* args, struct map* paramMap, struct sym
         }
         if(symbol->symbolType == SYMBOL_FUNCTIONPTR) {
             struct astNode* node = (struct astNode*)argElem->data;
-            struct symbolNode* fnptr = symbol_find(node->data, node->scope);
+            struct symbolNode* fnptr = symbol_findVar(node);
             if(fnptr == NULL) {
                 LOG("Here");
             }
@@ -744,7 +952,23 @@ static int validateParamType(struct list* args, struct map* paramMap, struct sym
         }
     }
     // count the parameters, arguments. Check that sizes match excluding function's block
-    return args->size - paramMap->size;
+    return args->size - countParams(paramMap);
+}
+
+/*
+    Counts the parameters of a function or function pointer. The function's
+    block is left out, since it is not there once a function's code has been
+    freed. */
+static int countParams(struct map* paramMap) {
+    int numParams = 0;
+    struct listElem* elem;
+    for(elem = list_begin(paramMap->keyList); elem != list_end(paramMap->keyList); elem = list_next(elem)) {
+        struct symbolNode* symbol = (struct symbolNode*)map_get(paramMap, ((char*)elem->data));
+        if(symbol->symbolType != SYMBOL_BLOCK) {
+            numParams++;
+        }
+    }
+    return numParams;
 }
 
 /*
@@ -11,5 +11,6 @@
 
 void validator_updateStructType(struct symbolNode*);
 void validator_validate(struct symbolNode*);
+void validator_validateDeclarations(struct symbolNode*);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,686 @@
+/*  fuzz.c
+
+    Searches for Orange programs that take the compiler a long time to compile
+    for their size. Programs are written from a shape, which says how many of
+    each part of the grammar the program has: statements in a block, blocks
+    inside blocks, operands in an expression, locals, functions, modules, and
+    how long names, lines, comments and strings are. One part of the shape is
+    the part that grows, and is multiplied by the scale the program is written
+    at.
+
+    Each shape is compiled at a scale big enough to take a while, and again at
+    four times that scale. How much longer the bigger program takes, against
+    how much bigger it is, gives the exponent of the compile time. Linear
+    compiles have an exponent near 1, anything well above is reported as
+    superlinear.
+
+    The search keeps the shapes that cost the most time per byte, and makes
+    new shapes by changing the kept ones a little at a time. The worst shape
+    found for each growing part is kept in bench/corpus, if it is worse than
+    the one already there. Each corpus file starts with the shape it was
+    written from, so that "fuzz --corpus" can write and time it again at both
+    scales, to see whether a fix made it linear or a change made it worse.
+
+    "fuzz --corpus" exits with 1 if a program in the corpus does not compile,
+    or compiles superlinearly.
+
+    Run with "make fuzz", or "make fuzz-corpus" to time the corpus.
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <dirent.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define COMPILER "./orangec"
+#define CORPUS "bench/corpus"
+#define INPUT "/tmp/orangec_fuzz.orng"
+#define OUTPUT "/tmp/orangec_fuzz.js"
+
+#define POPULATION 12 // shapes kept by the search, starting with one for each part
+#define ROUNDS 40
+#define REPEATS 3 // each compile is timed this many times, the fastest is kept
+#define MIN_SECONDS 0.02 // scales are doubled until a compile takes this long
+#define MAX_BYTES 4000000 // or until the program is this big
+#define MAX_SCALE 4096 // or until the scale is this big, for parts that do not make programs bigger
+#define TIMEOUT 20 // compiles that take longer than this many seconds are stopped
+#define SUPERLINEAR 1.4 // exponents above this are reported
+#define TOO_BIG 1000 // given instead of an exit status for programs over MAX_BYTES, which are not compiled
+#define MAX_LETTERS 240 // letters in a name or string, so that each is shorter than the longest token the lexer takes
+
+/*
+    The parts of the grammar that a shape says how many of */
+enum part {
+    STATEMENTS, // statements in each block
+    NESTING, // blocks inside blocks
+    OPERANDS, // operands in each expression
+    PARENS, // parentheses around each operand
+    LOCALS, // locals declared in each function
+    FUNCTIONS, // functions in each module
+    MODULES,
+    GLOBALS, // globals in each module
+    NAME_LENGTH, // letters added to each name
+    LINE_LENGTH, // statements written on one line
+    COMMENT_LENGTH, // words in the comment before each function
+    STRING_LENGTH, // letters in a string local in each function
+    PARTS
+};
+
+static const char* partNames[PARTS] = {
+    "statements", "nesting", "operands", "parens", "locals", "functions",
+    "modules", "globals", "name-length", "line-length", "comment-length",
+    "string-length"
+};
+
+// Smallest and largest amounts of each part before the scale is applied
+static const int minAmounts[PARTS] = {1, 0, 1, 0, 1, 1, 1, 0, 0, 1, 0, 0};
+static const int maxAmounts[PARTS] = {64, 16, 64, 16, 64, 64, 16, 64, 64, 64, 256, 1024};
+
+struct shape {
+    int amounts[PARTS];
+    enum part grow; // the part multiplied by the scale
+    unsigned int seed; // picks the statements and operands of the program
+};
+
+struct result {
+    struct shape shape;
+    int scale; // the smaller of the two scales compiled
+    long bytes[2];
+    double seconds[2];
+    int failed; // exit status of a compile that failed, the signal that stopped it, or TOO_BIG
+    double exponent;
+    double nsPerByte; // of the bigger program
+};
+
+/*
+    Things needed while writing one program */
+struct writer {
+    FILE* out;
+    struct shape* shape;
+    int scale;
+    unsigned int random;
+    int module;
+    int onLine; // statements written on the current line
+};
+
+static unsigned int nextRandom(unsigned int*);
+static int amount(struct writer*, enum part);
+static void writeName(struct writer*, char, int);
+static void writeNewLine(struct writer*, int);
+static void writeOperand(struct writer*, int);
+static void writeExpression(struct writer*, int);
+static void writeStatement(struct writer*, int, int);
+static void writeBlock(struct writer*, int);
+static void writeFunction(struct writer*, int);
+static void writeModule(struct writer*);
+static long writeProgram(struct shape*, int, const char*);
+static double now();
+static int compile(const char*, double*);
+static int measure(struct shape*, int, long*, double*);
+static void evaluate(struct shape*, struct result*);
+static void mutate(struct shape*, struct shape*, unsigned int*);
+static void printResult(const char*, struct result*);
+static void keep(struct result*);
+static int readShape(const char*, struct shape*, int*, double*);
+static void search(unsigned int, int);
+static int timeCorpus();
+
+int main(int argc, char** argv) {
+    unsigned int seed = (unsigned int)time(NULL);
+    int rounds = ROUNDS;
+    setvbuf(stdout, NULL, _IOLBF, 0); // each shape is printed once it is timed
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "--corpus")) {
+            return timeCorpus();
+        } else if(!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = (unsigned int)atol(argv[++i]);
+        } else if(!strcmp(argv[i], "--rounds") && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: fuzz [--seed N] [--rounds N] [--corpus]\n");
+            return 1;
+        }
+    }
+    search(seed, rounds);
+    return 0;
+}
+
+static unsigned int nextRandom(unsigned int* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/*
+    Gives how many of a part the program being written has */
+static int amount(struct writer* writer, enum part part) {
+    int n = writer->shape->amounts[part];
+    if(part == writer->shape->grow) {
+        n *= writer->scale;
+    }
+    return n;
+}
+
+/*
+    Names are a letter, then as many letters as the shape says, up to 
+    MAX_LETTERS, then a number, so that longer names do not change which names
+    there are */
+static void writeName(struct writer* writer, char kind, int index) {
+    fputc(kind, writer->out);
+    for(int i = 0; i < amount(writer, NAME_LENGTH) && i < MAX_LETTERS; i++) {
+        fputc('a' + i % 26, writer->out);
+    }
+    fprintf(writer->out, "%d", index);
+}
+
+/*
+    Ends a statement, starting a new line once the line has as many statements
+    as the shape says */
+static void writeNewLine(struct writer* writer, int depth) {
+    writer->onLine++;
+    if(writer->onLine < amount(writer, LINE_LENGTH)) {
+        fputc(' ', writer->out);
+        return;
+    }
+    writer->onLine = 0;
+    fputc('\n', writer->out);
+    for(int i = 0; i < depth + 2; i++) {
+        fputs("    ", writer->out);
+    }
+}
+
+/*
+    Writes a literal, parameter, local, global, or a call to a function in
+    this module or the next one */
+static void writeOperand(struct writer* writer, int depth) {
+    int parens = amount(writer, PARENS);
+    for(int i = 0; i < parens; i++) {
+        fputc('(', writer->out);
+    }
+    switch(nextRandom(&writer->random) % 6) {
+    case 0:
+        fprintf(writer->out, "%u", nextRandom(&writer->random) % 100);
+        break;
+    case 1:
+        fputs(nextRandom(&writer->random) % 2 ? "a" : "b", writer->out);
+        break;
+    case 2:
+    case 3:
+        writeName(writer, 'v', nextRandom(&writer->random) % amount(writer, LOCALS));
+        break;
+    case 4:
+        if(amount(writer, GLOBALS) > 0) {
+            writeName(writer, 'g', nextRandom(&writer->random) % amount(writer, GLOBALS));
+        } else {
+            fputc('a', writer->out);
+        }
+        break;
+    case 5:
+        if(nextRandom(&writer->random) % 2) {
+            writeName(writer, 'f', nextRandom(&writer->random) % amount(writer, FUNCTIONS));
+        } else {
+            fprintf(writer->out, "Fuzz%d:", (writer->module + 1) % amount(writer, MODULES));
+            writeName(writer, 'f', 0);
+        }
+        fputs("(a, b)", writer->out);
+        break;
+    }
+    for(int i = 0; i < parens; i++) {
+        fputc(')', writer->out);
+    }
+}
+
+static void writeExpression(struct writer* writer, int depth) {
+    static const char* operators[] = {" + ", " - ", " * ", " / "};
+    writeOperand(writer, depth);
+    for(int i = 1; i < amount(writer, OPERANDS); i++) {
+        fputs(operators[nextRandom(&writer->random) % 4], writer->out);
+        writeOperand(writer, depth);
+    }
+}
+
+/*
+    Writes an assignment, or if nested is set, an if, while or for around a
+    block one deeper */
+static void writeStatement(struct writer* writer, int depth, int nested) {
+    if(!nested) {
+        writeName(writer, 'v', nextRandom(&writer->random) % amount(writer, LOCALS));
+        fputs(" = ", writer->out);
+        writeExpression(writer, depth);
+        fputc(';', writer->out);
+        return;
+    }
+    switch(nextRandom(&writer->random) % 3) {
+    case 0:
+        fputs("if ", writer->out);
+        writeExpression(writer, depth);
+        fputs(" > 0 {", writer->out);
+        break;
+    case 1:
+        fputs("while ", writer->out);
+        writeExpression(writer, depth);
+        fputs(" < 0 {", writer->out);
+        break;
+    case 2:
+        fprintf(writer->out, "for i%d in 0..", depth);
+        writeExpression(writer, depth);
+        fputs(" {", writer->out);
+        break;
+    }
+    writeBlock(writer, depth + 1);
+    fputc('}', writer->out);
+}
+
+/*
+    Only the first statement of a block has a block in it, so that programs
+    get deeper without getting exponentially bigger */
+static void writeBlock(struct writer* writer, int depth) {
+    writeNewLine(writer, depth);
+    for(int i = 0; i < amount(writer, STATEMENTS); i++) {
+        writeStatement(writer, depth, i == 0 && depth < amount(writer, NESTING));
+        writeNewLine(writer, depth);
+    }
+}
+
+static void writeFunction(struct writer* writer, int index) {
+    if(amount(writer, COMMENT_LENGTH) > 0) {
+        fputs("    //", writer->out);
+        for(int i = 0; i < amount(writer, COMMENT_LENGTH); i++) {
+            fputs(" word", writer->out);
+        }
+        fputc('\n', writer->out);
+    }
+    fputs("    int ", writer->out);
+    writeName(writer, 'f', index);
+    fputs("(int a, int b) {", writer->out);
+    writer->onLine = 0;
+    for(int i = 0; i < amount(writer, LOCALS); i++) {
+        fputs("\n        int ", writer->out);
+        writeName(writer, 'v', i);
+        fputs(" = a;", writer->out);
+    }
+    if(amount(writer, STRING_LENGTH) > 0) {
+        fputs("\n        char[] s = \"", writer->out);
+        for(int i = 0; i < amount(writer, STRING_LENGTH) && i < MAX_LETTERS; i++) {
+            fputc('a' + i % 26, writer->out);
+        }
+        fputs("\";", writer->out);
+    }
+    writeBlock(writer, 0);
+    fputs("return ", writer->out);
+    writeName(writer, 'v', 0);
+    fputs(";\n    }\n", writer->out);
+}
+
+static void writeModule(struct writer* writer) {
+    fprintf(writer->out, "Fuzz%d {\n", writer->module);
+    for(int i = 0; i < amount(writer, GLOBALS); i++) {
+        fputs("    int ", writer->out);
+        writeName(writer, 'g', i);
+        fprintf(writer->out, " = %d;\n", i);
+    }
+    for(int i = 0; i < amount(writer, FUNCTIONS) && ftell(writer->out) <= MAX_BYTES; i++) {
+        writeFunction(writer, i);
+    }
+    fputs("}\n", writer->out);
+}
+
+/*
+    Writes the program for a shape at a scale to a file, after a comment with
+    the shape, and gives the number of bytes written. Programs written from
+    the same shape pick the same statements and operands at every scale.
+    Writing stops at the end of the function that goes over MAX_BYTES. */
+static long writeProgram(struct shape* shape, int scale, const char* filename) {
+    FILE* out = fopen(filename, "w");
+    if(!out) {
+        perror(filename);
+        exit(1);
+    }
+    fprintf(out, "// fuzz shape");
+    for(int i = 0; i < PARTS; i++) {
+        fprintf(out, " %d", shape->amounts[i]);
+    }
+    fprintf(out, " grow %d seed %u scale %d\n", shape->grow, shape->seed, scale);
+
+    struct writer writer = {out, shape, scale, shape->seed | 1, 0, 0};
+    for(writer.module = 0; writer.module < amount(&writer, MODULES) && ftell(out) <= MAX_BYTES; writer.module++) {
+        writeModule(&writer);
+    }
+    long bytes = ftell(out);
+    fclose(out);
+    return bytes;
+}
+
+static double now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/*
+    Compiles a file and gives how long it took. Returns 0 if it compiled, the
+    exit status if it did not, or the signal that stopped it as a negative
+    number */
+static int compile(const char* filename, double* seconds) {
+    double start = now();
+    pid_t pid = fork();
+    if(pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        alarm(TIMEOUT);
+        execl(COMPILER, COMPILER, filename, "-o", OUTPUT, (char*)NULL);
+        _exit(127);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    *seconds = now() - start;
+    if(WIFSIGNALED(status)) {
+        return -WTERMSIG(status);
+    }
+    return WEXITSTATUS(status);
+}
+
+/*
+    Writes and compiles a shape at a scale, keeping the fastest of a few
+    compiles */
+static int measure(struct shape* shape, int scale, long* bytes, double* seconds) {
+    *bytes = writeProgram(shape, scale, INPUT);
+    *seconds = TIMEOUT;
+    if(*bytes > MAX_BYTES) {
+        return TOO_BIG;
+    }
+    for(int i = 0; i < REPEATS; i++) {
+        double time;
+        int failed = compile(INPUT, &time);
+        if(failed) {
+            *seconds = time;
+            return failed;
+        }
+        if(time < *seconds) {
+            *seconds = time;
+        }
+        if(time > 1.0) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/*
+    Finds a scale that takes a while to compile, then compiles four times that
+    scale to work out the exponent */
+static void evaluate(struct shape* shape, struct result* result) {
+    memset(result, 0, sizeof(struct result));
+    result->shape = *shape;
+    result->scale = 1;
+    while(1) {
+        result->failed = measure(shape, result->scale, &result->bytes[0], &result->seconds[0]);
+        if(result->failed || result->seconds[0] >= MIN_SECONDS || result->bytes[0] * 4 >= MAX_BYTES
+            || result->scale >= MAX_SCALE) {
+            break;
+        }
+        result->scale *= 2;
+    }
+    if(!result->failed) {
+        result->failed = measure(shape, result->scale * 4, &result->bytes[1], &result->seconds[1]);
+        if(result->failed) {
+            // The program kept for a failed compile is the one that failed
+            result->scale *= 4;
+        }
+    }
+    if(result->failed) {
+        return;
+    }
+
+    // Parts that stop making programs bigger, and compiles too short to time, are left at 0
+    if(result->bytes[1] < result->bytes[0] * 2 || result->seconds[0] < MIN_SECONDS) {
+        return;
+    }
+    result->exponent = log(result->seconds[1] / result->seconds[0]) / log((double)result->bytes[1] / result->bytes[0]);
+    result->nsPerByte = result->seconds[1] * 1e9 / result->bytes[1];
+}
+
+/*
+    Makes a new shape by doubling, halving or nudging one or two amounts,
+    sometimes changing which part grows */
+static void mutate(struct shape* shape, struct shape* parent, unsigned int* random) {
+    *shape = *parent;
+    shape->seed = nextRandom(random);
+    int changes = 1 + nextRandom(random) % 2;
+    for(int i = 0; i < changes; i++) {
+        int part = nextRandom(random) % PARTS;
+        switch(nextRandom(random) % 4) {
+        case 0:
+            shape->amounts[part] *= 2;
+            break;
+        case 1:
+            shape->amounts[part] /= 2;
+            break;
+        case 2:
+            shape->amounts[part] += 1;
+            break;
+        case 3:
+            shape->grow = part;
+            break;
+        }
+        if(shape->amounts[part] < minAmounts[part]) {
+            shape->amounts[part] = minAmounts[part];
+        } else if(shape->amounts[part] > maxAmounts[part]) {
+            shape->amounts[part] = maxAmounts[part];
+        }
+    }
+    if(shape->amounts[shape->grow] == 0) {
+        shape->amounts[shape->grow] = 1;
+    }
+}
+
+static void printResult(const char* label, struct result* result) {
+    printf("%-8s %-15s %6d %9ld %9.1f %9.1f", label, partNames[result->shape.grow],
+        result->scale, result->bytes[1], result->seconds[0] * 1e3, result->seconds[1] * 1e3);
+    if(result->failed == TOO_BIG) {
+        printf("    too big to compile\n");
+    } else if(result->failed > 0) {
+        printf("    compile failed with exit status %d\n", result->failed);
+    } else if(result->failed == -SIGALRM) {
+        printf("    compile took over %d seconds\n", TIMEOUT);
+    } else if(result->failed < 0) {
+        printf("    compiler stopped by signal %d\n", -result->failed);
+    } else {
+        printf(" %9.1f %8.2f%s\n", result->nsPerByte, result->exponent,
+            result->exponent > SUPERLINEAR ? "  superlinear" : "");
+    }
+}
+
+/*
+    Puts the program for a result in the corpus, at the smaller scale, if it
+    is worse than the one kept for the same growing part. Failed compiles are
+    kept at the scale that failed, under a name of their own ending in 
+    -failed. Programs that compile again once the compiler is fixed should be
+    renamed without it. */
+static void keep(struct result* result) {
+    char filename[255];
+    const char* part = partNames[result->shape.grow];
+    if(result->failed) {
+        snprintf(filename, 255, "%s/%s-failed.orng", CORPUS, part);
+    } else {
+        snprintf(filename, 255, "%s/%s.orng", CORPUS, part);
+        struct shape kept;
+        int scale;
+        double exponent;
+        if(readShape(filename, &kept, &scale, &exponent) && exponent >= result->exponent) {
+            return;
+        }
+    }
+    writeProgram(&result->shape, result->scale, filename);
+
+    // The exponent is written after the program, so that it can be compared
+    FILE* out = fopen(filename, "a");
+    fprintf(out, "// exponent %.2f, %.1f ns/byte at %ld bytes\n", result->exponent, result->nsPerByte, result->bytes[1]);
+    fclose(out);
+    printf("kept %s\n", filename);
+}
+
+/*
+    Reads the shape at the top of a corpus file, and the exponent at the end.
+    Returns 0 if the file is not there or was not written by fuzz. */
+static int readShape(const char* filename, struct shape* shape, int* scale, double* exponent) {
+    FILE* in = fopen(filename, "r");
+    if(!in) {
+        return 0;
+    }
+    int read = fscanf(in, "// fuzz shape");
+    for(int i = 0; i < PARTS && read != EOF; i++) {
+        read = fscanf(in, " %d", &shape->amounts[i]);
+    }
+    int grow;
+    int fields = fscanf(in, " grow %d seed %u scale %d", &grow, &shape->seed, scale);
+    shape->grow = grow;
+
+    // The exponent is on the last line
+    char line[255];
+    *exponent = 0;
+    while(fgets(line, 255, in)) {
+        sscanf(line, "// exponent %lf", exponent);
+    }
+    fclose(in);
+    return fields == 3 && grow >= 0 && grow < PARTS;
+}
+
+static void search(unsigned int seed, int rounds) {
+    unsigned int random = seed | 1;
+    struct result population[POPULATION];
+    int size = 0;
+    printf("seed %u\n", seed);
+    printf("%-8s %-15s %6s %9s %9s %9s %9s %8s\n", "round", "growing", "scale", "bytes", "small ms", "big ms", "ns/byte", "exponent");
+
+    // The search starts from one small shape for each growing part
+    for(int part = 0; part < PARTS && size < POPULATION; part++) {
+        struct shape shape;
+        for(int i = 0; i < PARTS; i++) {
+            shape.amounts[i] = minAmounts[i] > 2 ? minAmounts[i] : 2;
+        }
+        shape.grow = part;
+        shape.seed = nextRandom(&random);
+        evaluate(&shape, &population[size]);
+        printResult("start", &population[size]);
+        if(population[size].failed == TOO_BIG) {
+            continue;
+        } else if(population[size].failed) {
+            keep(&population[size]);
+        } else {
+            size++;
+        }
+    }
+    if(size == 0) {
+        printf("every program failed to compile, is %s built?\n", COMPILER);
+        return;
+    }
+
+    for(int round = 0; round < rounds; round++) {
+        struct shape shape;
+        mutate(&shape, &population[nextRandom(&random) % size].shape, &random);
+        struct result result;
+        evaluate(&shape, &result);
+        char label[16];
+        snprintf(label, 16, "%d", round);
+        printResult(label, &result);
+        if(result.failed) {
+            if(result.failed != TOO_BIG) {
+                keep(&result);
+            }
+            continue;
+        }
+
+        // The new shape takes the place of the cheapest kept shape, if it is worse
+        int cheapest = 0;
+        for(int i = 1; i < size; i++) {
+            if(population[i].nsPerByte < population[cheapest].nsPerByte) {
+                cheapest = i;
+            }
+        }
+        if(size < POPULATION) {
+            population[size++] = result;
+        } else if(result.nsPerByte > population[cheapest].nsPerByte) {
+            population[cheapest] = result;
+        }
+    }
+
+    printf("\nworst shapes found\n");
+    for(int i = 0; i < size; i++) {
+        printResult("", &population[i]);
+        if(population[i].exponent > SUPERLINEAR) {
+            keep(&population[i]);
+        }
+    }
+}
+
+/*
+    Writes and compiles each shape in the corpus again at both scales. Returns
+    1 if any program did not compile, or has an exponent above SUPERLINEAR. 
+    Programs that stop getting bigger, or compile too fast to time, are not 
+    given an exponent. */
+static int timeCorpus() {
+    DIR* dir = opendir(CORPUS);
+    if(!dir) {
+        perror(CORPUS);
+        exit(1);
+    }
+    printf("%-30s %9s %9s %9s %8s %8s\n", "file", "bytes", "small ms", "big ms", "exponent", "was");
+    int failed = 0;
+    struct dirent* entry;
+    while((entry = readdir(dir))) {
+        if(!strstr(entry->d_name, ".orng")) {
+            continue;
+        }
+        char filename[512];
+        snprintf(filename, 512, "%s/%s", CORPUS, entry->d_name);
+        struct shape shape;
+        int scale;
+        double was;
+        if(!readShape(filename, &shape, &scale, &was)) {
+            printf("%-30s    not written by fuzz\n", entry->d_name);
+            continue;
+        }
+        struct result result = {shape, scale};
+        result.failed = measure(&shape, scale, &result.bytes[0], &result.seconds[0]);
+        if(!result.failed) {
+            result.failed = measure(&shape, scale * 4, &result.bytes[1], &result.seconds[1]);
+        }
+        if(result.failed == TOO_BIG) {
+            printf("%-30s    too big to compile\n", entry->d_name);
+            continue;
+        } else if(result.failed) {
+            printf("%-30s    still fails, status %d\n", entry->d_name, result.failed);
+            failed = 1;
+            continue;
+        }
+        printf("%-30s %9ld %9.1f %9.1f", entry->d_name, result.bytes[1], result.seconds[0] * 1e3, result.seconds[1] * 1e3);
+        if(result.bytes[1] < result.bytes[0] * 2 || result.seconds[0] < MIN_SECONDS) {
+            printf(" %8s %8.2f\n", "-", was);
+            continue;
+        }
+        double exponent = log(result.seconds[1] / result.seconds[0]) / log((double)result.bytes[1] / result.bytes[0]);
+        printf(" %8.2f %8.2f", exponent, was);
+        if(exponent > SUPERLINEAR) {
+            printf("  above %.2f", SUPERLINEAR);
+            failed = 1;
+        }
+        printf("\n");
+    }
+    closedir(dir);
+    if(failed) {
+        printf("\nA program in the corpus did not compile, or compiled superlinearly\n");
+    }
+    return failed;
+}
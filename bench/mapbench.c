@@ -0,0 +1,194 @@
+/*  mapbench.c
+
+    Times the util map and list against the number of elements in them, from
+    10 up to a million. Keys look like the names the compiler puts in maps:
+    camel case identifiers made of common words, with every eighth one given
+    a #id like struct types are. After each size, the map's stats are printed
+    so that slow sizes can be matched with long bucket chains.
+
+    Maps whose keys take too long to put in are not timed at bigger sizes.
+
+    Run with "make mapbench".
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../util/list.h"
+#include "../util/map.h"
+
+#define MAX_SIZE 1000000
+#define SKIP_SECONDS 5.0 // bigger sizes are skipped once putting keys takes longer than this
+
+static const char* words[64] = {
+    "get", "set", "draw", "update", "init", "create", "remove", "add",
+    "value", "index", "count", "size", "length", "node", "list", "map",
+    "point", "rect", "color", "width", "height", "left", "right", "top",
+    "key", "data", "name", "type", "scope", "block", "token", "line",
+    "x", "y", "i", "j", "n", "a", "b", "c",
+    "mouse", "event", "canvas", "sprite", "player", "enemy", "score", "level",
+    "is", "has", "to", "from", "min", "max", "sum", "total",
+    "buffer", "queue", "stack", "tree", "parent", "child", "next", "prev"
+};
+
+static char** makeKeys(int, int);
+static void freeKeys(char**, int);
+static double now();
+static void printRow(const char*, int, double, int);
+static void benchMap(int, double*);
+static void benchList(int);
+
+int main() {
+    double putSeconds = 0;
+    int timedSize = 0; // biggest size maps were timed at
+    map_countLookups(1); // for the probes per get printed with each map's stats
+    printf("%-22s %9s %12s %10s\n", "operation", "elements", "ns/op", "total ms");
+    for(int size = 10; size <= MAX_SIZE; size *= 10) {
+        if(putSeconds < SKIP_SECONDS) {
+            benchMap(size, &putSeconds);
+            timedSize = size;
+        } else {
+            printf("%-22s %9d    skipped, %d keys took %.2f s to put\n", "map", size, timedSize, putSeconds);
+        }
+        benchList(size);
+        printf("\n");
+    }
+    return 0;
+}
+
+/*
+    Makes keys for a map. The words of each key are picked by the digits of
+    its index in base 64, after the index is scrambled, so keys are unique but
+    do not go in order. Low indices give one word names, like locals. */
+static char** makeKeys(int number, int offset) {
+    char** keys = (char**)malloc(sizeof(char*) * number);
+    for(int i = 0; i < number; i++) {
+        unsigned int n = ((unsigned int)(i + offset) * 2654435761u) % (64 * 64 * 64 * 64);
+        if(i + offset < 64) {
+            n = i + offset;
+        }
+        char key[64] = "";
+        int first = 1;
+        do {
+            char word[16];
+            strcpy(word, words[n % 64]);
+            if(!first) {
+                word[0] = word[0] - 'a' + 'A';
+            }
+            strcat(key, word);
+            first = 0;
+            n /= 64;
+        } while(n > 0);
+        if(i % 8 == 7) {
+            sprintf(key + strlen(key), "#%d", i);
+        }
+        keys[i] = (char*)malloc(strlen(key) + 1);
+        strcpy(keys[i], key);
+    }
+    return keys;
+}
+
+static void freeKeys(char** keys, int number) {
+    for(int i = 0; i < number; i++) {
+        free(keys[i]);
+    }
+    free(keys);
+}
+
+static double now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static void printRow(const char* operation, int size, double seconds, int ops) {
+    printf("%-22s %9d %12.1f %10.2f\n", operation, size, seconds * 1e9 / ops, seconds * 1e3);
+}
+
+/*
+    Times putting keys into a map, getting keys that are in it and keys that
+    are not, and copying it, then prints its stats */
+static void benchMap(int size, double* putSeconds) {
+    char** keys = makeKeys(size, 0);
+    char** missing = makeKeys(size, 64 * 64 * 64);
+    struct map* map = map_create();
+    volatile long found = 0;
+
+    double start = now();
+    for(int i = 0; i < size; i++) {
+        map_put(map, keys[i], keys[i]);
+    }
+    *putSeconds = now() - start;
+    printRow("map_put", size, *putSeconds, size);
+
+    start = now();
+    for(int i = 0; i < size; i++) {
+        found += map_get(map, keys[(i * 7919L) % size]) != NULL;
+    }
+    printRow("map_get hit", size, now() - start, size);
+
+    start = now();
+    for(int i = 0; i < size; i++) {
+        found += map_get(map, missing[i]) != NULL;
+    }
+    printRow("map_get miss", size, now() - start, size);
+
+    struct mapStats stats;
+    map_stats(map, &stats);
+
+    struct map* copy = map_create();
+    start = now();
+    map_copy(copy, map);
+    printRow("map_copy", size, now() - start, size);
+
+    printf("%-22s %9d    load %.1f, %d of %d buckets used, longest chain %d, %.1f probes per get\n",
+        "map stats", size, (double)stats.size / stats.capacity, stats.usedBuckets, stats.capacity,
+        stats.maxChain, (double)stats.probes / stats.lookups);
+
+    map_destroy(copy);
+    map_destroy(map);
+    freeKeys(keys, size);
+    freeKeys(missing, size);
+}
+
+/*
+    Times a list used as a queue, as a stack, and gone through in order */
+static void benchList(int size) {
+    struct list* list = list_create();
+    volatile long sum = 0;
+
+    double start = now();
+    for(long i = 0; i < size; i++) {
+        queue_push(list, (void*)i);
+    }
+    for(int i = 0; i < size; i++) {
+        sum += (long)queue_pop(list);
+    }
+    printRow("queue push+pop", size, now() - start, size * 2);
+
+    start = now();
+    for(long i = 0; i < size; i++) {
+        stack_push(list, (void*)i);
+    }
+    for(int i = 0; i < size; i++) {
+        sum += (long)stack_pop(list);
+    }
+    printRow("stack push+pop", size, now() - start, size * 2);
+
+    for(long i = 0; i < size; i++) {
+        queue_push(list, (void*)i);
+    }
+    start = now();
+    struct listElem* elem;
+    for(elem = list_begin(list); elem != list_end(list); elem = list_next(elem)) {
+        sum += (long)elem->data;
+    }
+    printRow("list traverse", size, now() - start, size);
+
+    list_destroy(list);
+}
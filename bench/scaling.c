@@ -0,0 +1,275 @@
+/*  scaling.c
+
+    Checks that compile time grows linearly with the size of the program.
+    Programs are written at 1, 2, 4, up to 64 times a base size along each of
+    a few axes:
+
+        modules         many modules, each in its own file
+        symbols         one module with many globals and functions
+        nesting         one function with blocks inside blocks
+        expressions     one long expression
+        lines           one function with many statements
+
+    Each program is compiled with --time, which prints the seconds spent in
+    each phase of the compiler. Programs are compiled a few times each, and
+    the fastest time of each phase is kept. Every size is compiled once
+    before any size is compiled again, so that the machine getting slower or
+    faster partway through times each size alike. For each axis and phase, a
+    line is fit through the log of the time against the log of the bytes 
+    compiled, and its slope is the exponent the phase grows with. Phases that
+    stay too fast to time well are not fit.
+
+    Base sizes are big enough that programs at 1x already take up a few
+    megabytes once parsed. Programs small enough to stay in cache compile
+    faster per byte than bigger ones, which would bend the fit upwards even
+    for phases that do the same work for each byte. Each level of nesting
+    takes up about 3 kilobytes once parsed, so nesting starts 1024 deep.
+
+    Exits with 1 if any exponent is above the threshold, 1.2 unless another is
+    given with --threshold, or if any program does not compile.
+
+    Run with "make scaling", or "make scaling THRESHOLD=1.3".
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define COMPILER "orangec"
+#define DIRECTORY "/tmp/orangec_scaling"
+#define OUTPUT "out.js"
+#define MAX_PATH 4096
+
+#define SIZES 7 // 1x up to 64x
+#define REPEATS 5 // each program is compiled this many times, the fastest is kept
+#define MIN_SECONDS 0.002 // phase times below this are mostly noise, and are not fit
+#define MIN_POINTS 3 // phases timed well at fewer sizes than this are not fit
+#define MAX_PHASES 8
+#define MAX_FILES 4096
+
+enum axis {
+    MODULES, SYMBOLS, NESTING, EXPRESSIONS, LINES, AXES
+};
+
+static const char* axisNames[AXES] = {"modules", "symbols", "nesting", "expressions", "lines"};
+
+// Size of each axis at 1x
+static const int baseSizes[AXES] = {64, 1024, 1024, 1024, 4096};
+
+/*
+    Times of each phase of the compiler for one program */
+struct timing {
+    long bytes;
+    int numPhases;
+    char names[MAX_PHASES][16];
+    double seconds[MAX_PHASES];
+};
+
+// Programs are written and compiled in DIRECTORY, so that the names of many
+// files still fit in one command
+static char compiler[MAX_PATH];
+
+static long writeProgram(enum axis, int, int, int*);
+static void writeModule(FILE*, int);
+static int compile(int, int, int, struct timing*);
+static double fit(struct timing*, int);
+
+int main(int argc, char** argv) {
+    double threshold = 1.2;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "--threshold") && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: scaling [--threshold exponent]\n");
+            return 1;
+        }
+    }
+    if(!getcwd(compiler, MAX_PATH - sizeof(COMPILER) - 1) || system("mkdir -p " DIRECTORY) || chdir(DIRECTORY)) {
+        perror(DIRECTORY);
+        return 1;
+    }
+    strcat(compiler, "/" COMPILER);
+
+    int failed = 0;
+    printf("%-12s %-10s %9s %9s %9s\n", "axis", "phase", "1x ms", "64x ms", "exponent");
+    for(int axis = 0; axis < AXES; axis++) {
+        struct timing timings[SIZES];
+        int numFiles[SIZES];
+        int compiled = 1;
+        for(int i = 0; i < SIZES; i++) {
+            timings[i].bytes = writeProgram(axis, i, baseSizes[axis] << i, &numFiles[i]);
+        }
+        for(int repeat = 0; repeat < REPEATS && compiled; repeat++) {
+            for(int i = 0; i < SIZES && compiled; i++) {
+                if(compile(i, numFiles[i], repeat, &timings[i])) {
+                    printf("%-12s could not compile %dx\n", axisNames[axis], 1 << i);
+                    compiled = 0;
+                    failed = 1;
+                }
+            }
+        }
+        for(int phase = 0; compiled && phase < timings[0].numPhases; phase++) {
+            double exponent = fit(timings, phase);
+            printf("%-12s %-10s %9.2f %9.2f", axisNames[axis], timings[0].names[phase],
+                timings[0].seconds[phase] * 1e3, timings[SIZES - 1].seconds[phase] * 1e3);
+            if(isnan(exponent)) {
+                printf(" %9s\n", "too fast");
+            } else if(exponent > threshold) {
+                printf(" %9.2f  above %.2f\n", exponent, threshold);
+                failed = 1;
+            } else {
+                printf(" %9.2f\n", exponent);
+            }
+        }
+    }
+    if(failed) {
+        printf("\nCompile time grows faster than n^%.2f, or a program did not compile\n", threshold);
+    }
+    return failed;
+}
+
+/*
+    Writes the program for an axis at a size, to files of its own for the 
+    index of the size, giving the number of files it was written to and the 
+    bytes written */
+static long writeProgram(enum axis axis, int index, int size, int* numFiles) {
+    char filename[255];
+    *numFiles = axis == MODULES ? size : 1;
+    long bytes = 0;
+    for(int file = 0; file < *numFiles; file++) {
+        snprintf(filename, 255, "s%d-m%d.orng", index, file);
+        FILE* out = fopen(filename, "w");
+        if(!out) {
+            perror(filename);
+            exit(1);
+        }
+        switch(axis) {
+        case MODULES:
+            writeModule(out, file);
+            break;
+        case SYMBOLS:
+            fprintf(out, "Symbols {\n");
+            for(int i = 0; i < size; i++) {
+                fprintf(out, "    int global%d = %d;\n", i, i);
+            }
+            for(int i = 0; i < size; i++) {
+                fprintf(out, "    int function%d(int a) {\n        return a + global%d;\n    }\n", i, i);
+            }
+            fprintf(out, "}\n");
+            break;
+        case NESTING:
+            fprintf(out, "Nesting {\n    int f(int a) {\n        int x = a;\n");
+            for(int i = 0; i < size; i++) {
+                fprintf(out, "%*sif x > %d {\n", 8 + i % 32, "", i);
+            }
+            for(int i = size - 1; i >= 0; i--) {
+                fprintf(out, "%*sx = x - %d;\n%*s}\n", 12 + i % 32, "", i, 8 + i % 32, "");
+            }
+            fprintf(out, "        return x;\n    }\n}\n");
+            break;
+        case EXPRESSIONS:
+            fprintf(out, "Expressions {\n    int f(int a, int b) {\n        return a");
+            for(int i = 0; i < size; i++) {
+                fprintf(out, "%s(b - %d)", i % 8 == 7 ? "\n            + " : " + ", i);
+            }
+            fprintf(out, ";\n    }\n}\n");
+            break;
+        case LINES:
+            fprintf(out, "Lines {\n    int f(int a) {\n        int x = a;\n");
+            for(int i = 0; i < size; i++) {
+                fprintf(out, "        x = x * %d + a;\n", i % 100);
+            }
+            fprintf(out, "        return x;\n    }\n}\n");
+            break;
+        default:
+            break;
+        }
+        bytes += ftell(out);
+        fclose(out);
+    }
+    return bytes;
+}
+
+/*
+    Modules each have a few functions, and call into the module before them */
+static void writeModule(FILE* out, int module) {
+    fprintf(out, "Module%d {\n    int count = %d;\n", module, module);
+    for(int i = 0; i < 4; i++) {
+        fprintf(out, "    int f%d(int a) {\n        int x = a + count;\n", i);
+        if(module > 0) {
+            fprintf(out, "        x = x + Module%d:f%d(a);\n", module - 1, i);
+        }
+        fprintf(out, "        return x;\n    }\n");
+    }
+    fprintf(out, "}\n");
+}
+
+/*
+    Compiles the files written for the index of a size once, keeping the 
+    fastest time of each phase so far. Returns 1 if the program did not 
+    compile. */
+static int compile(int index, int numFiles, int repeat, struct timing* timing) {
+    static char command[MAX_PATH + MAX_FILES * 32 + 255];
+    int length = sprintf(command, "%s --time -o " OUTPUT, compiler);
+    for(int file = 0; file < numFiles && file < MAX_FILES; file++) {
+        length += sprintf(command + length, " s%d-m%d.orng", index, file);
+    }
+
+    if(repeat == 0) {
+        timing->numPhases = 0;
+    }
+    FILE* in = popen(command, "r");
+    if(!in) {
+        return 1;
+    }
+    char name[16];
+    double seconds;
+    int phase = 0;
+    int done = 0;
+    char line[255];
+    while(fgets(line, 255, in)) {
+        if(!strcmp(line, "Done.\n")) {
+            done = 1;
+        } else if(sscanf(line, "%15s %lf", name, &seconds) == 2 && phase < MAX_PHASES) {
+            if(repeat == 0) {
+                strcpy(timing->names[phase], name);
+                timing->seconds[phase] = seconds;
+                timing->numPhases++;
+            } else if(seconds < timing->seconds[phase]) {
+                timing->seconds[phase] = seconds;
+            }
+            phase++;
+        }
+    }
+    return pclose(in) != 0 || !done;
+}
+
+/*
+    Fits a line through log(seconds) against log(bytes) for one phase, with
+    least squares, and gives its slope. Gives NAN if the phase was timed well
+    at too few sizes. */
+static double fit(struct timing* timings, int phase) {
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    int n = 0;
+    for(int i = 0; i < SIZES; i++) {
+        if(timings[i].seconds[phase] < MIN_SECONDS) {
+            continue;
+        }
+        double x = log((double)timings[i].bytes);
+        double y = log(timings[i].seconds[phase]);
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        n++;
+    }
+    if(n < MIN_POINTS) {
+        return NAN;
+    }
+    return (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+}
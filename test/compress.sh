@@ -0,0 +1,69 @@
+#!/bin/sh
+#   compress.sh
+#
+#   Checks that the gzip and brotli copies written with --gzip and --brotli
+#   decompress to the output they were made from. The sample program and each
+#   regress program are compiled at every --level from 0 to 9, plainly and
+#   with --minify, and each copy is decompressed with node's zlib and compared
+#   byte for byte with the JavaScript it sits next to. The sample is also
+#   compiled with --split, so that small chunks are checked too.
+#
+#   Run with "make compress". Exits with 1 if any copy does not decompress to
+#   its output.
+#
+#   Author: Joseph Shimel
+#   Date: 10/17/26
+
+COMPILER=./orangec
+DIRECTORY=/tmp/orangec_compress
+mkdir -p $DIRECTORY
+
+# Decompresses each file given into the file named without its .gz or .br
+cat > $DIRECTORY/decompress.js << 'EOF'
+const fs = require("fs");
+const zlib = require("zlib");
+for (const name of process.argv.slice(2)) {
+    const data = fs.readFileSync(name);
+    const out = name.endsWith(".gz") ? zlib.gunzipSync(data) : zlib.brotliDecompressSync(data);
+    fs.writeFileSync(name + ".out", out);
+}
+EOF
+
+failed=0
+check() {
+    rm -f $DIRECTORY/out*
+    if ! $COMPILER "$@" -o $DIRECTORY/out.js --gzip --brotli > $DIRECTORY/compiled 2>&1; then
+        echo "FAIL $name $flags: did not compile:"
+        cat $DIRECTORY/compiled
+        failed=1
+        return
+    fi
+    if ! node $DIRECTORY/decompress.js $DIRECTORY/out*.gz $DIRECTORY/out*.br > $DIRECTORY/decompressed 2>&1; then
+        echo "FAIL $name $flags: did not decompress:"
+        cat $DIRECTORY/decompressed
+        failed=1
+        return
+    fi
+    for copy in $DIRECTORY/out*.gz $DIRECTORY/out*.br; do
+        if ! cmp -s "${copy%.*}" "$copy.out"; then
+            echo "FAIL $name $flags: $(basename "$copy") does not decompress to $(basename "${copy%.*}")"
+            failed=1
+        fi
+    done
+}
+
+for level in 0 1 2 3 4 5 6 7 8 9; do
+    for program in test/test.orng test/regress/*.orng; do
+        name=$(basename "$program" .orng)
+        grep -q "^// expect error: " "$program" && continue
+        for flags in "" "--minify"; do
+            flags="--level $level $flags"
+            check "$program" test/ornglib/*.orng $flags
+        done
+    done
+    name=test
+    flags="--level $level --split"
+    check test/test.orng test/ornglib/*.orng $flags
+    [ $failed = 0 ] && echo "ok   level $level"
+done
+exit $failed
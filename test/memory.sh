@@ -0,0 +1,47 @@
+#!/bin/sh
+#   memory.sh
+#
+#   Checks that --stream lowers how much memory the compiler needs. The sample
+#   program and each program in bench/corpus are compiled with --mem-report,
+#   with and without --stream, and the highest peak of any phase is compared.
+#   Compiling with --stream must peak lower for every program.
+#
+#   Run with "make memory". Exits with 1 if --stream does not peak lower for
+#   a program.
+#
+#   Author: Joseph Shimel
+#   Date: 10/17/26
+
+COMPILER=./orangec
+DIRECTORY=/tmp/orangec_memory
+mkdir -p $DIRECTORY
+
+# Prints the highest peak of any phase in the --mem-report of a compile
+peak() {
+    if ! $COMPILER "$@" -o $DIRECTORY/out.js --mem-report > $DIRECTORY/report 2>&1; then
+        echo "did not compile:" >&2
+        cat $DIRECTORY/report >&2
+        return 1
+    fi
+    awk '$1 ~ /^(startup|read|parse|validate|generate)$/ && $NF > peak { peak = $NF } END { print peak }' $DIRECTORY/report
+}
+
+failed=0
+check() {
+    plain=$(peak "$@") || { echo "FAIL $name"; failed=1; return; }
+    streamed=$(peak "$@" --stream) || { echo "FAIL $name --stream"; failed=1; return; }
+    if [ "$streamed" -lt "$plain" ]; then
+        echo "ok   $name peak $plain, $streamed with --stream"
+    else
+        echo "FAIL $name peak $plain, $streamed with --stream"
+        failed=1
+    fi
+}
+
+name=test
+check test/test.orng test/ornglib/*.orng
+for program in bench/corpus/*.orng; do
+    name=$(basename "$program" .orng)
+    check "$program"
+done
+exit $failed
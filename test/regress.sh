@@ -0,0 +1,91 @@
+#!/bin/sh
+#   regress.sh
+#
+#   Compiles each program in test/regress with ornglib and checks it against
+#   the comments at its top:
+#
+#       // expect: line         the program prints this line, in order with
+#                               the other expected lines, when start() is run
+#       // expect error: text   the program does not compile, with an error
+#                               message that has this text in it
+#       // profile: json        the program is also compiled with this
+#                               profile, using --profile-use, with -j 4
+#                               and with --stream
+#
+#   Programs with expected lines are compiled and run in the default mode,
+#   and with --minify, --ir, --split, --stream, -j 4, and --heap, and must
+#   print the same in each. Split programs are written to a directory of
+#   their own, marked as ES modules, so that node loads the chunks.
+#
+#   Programs are run with three worker threads for parallel loops, however
+#   many cores there are, so that loops are split between workers even on
+#   machines with one core. Split programs are ES modules, which have no 
+#   require to load worker_threads with, so they are given node's.
+#
+#   Run with "make regress". Exits with 1 if any program does not do what
+#   it expects.
+#
+#   Author: Joseph Shimel
+#   Date: 10/17/26
+
+COMPILER=./orangec
+DIRECTORY=/tmp/orangec_regress
+mkdir -p $DIRECTORY/split
+echo '{"type": "module"}' > $DIRECTORY/split/package.json
+echo 'globalThis.orangeWorkers = 3; globalThis.require = require;' > $DIRECTORY/workers.js
+
+failed=0
+for program in test/regress/*.orng; do
+    name=$(basename "$program" .orng)
+    sed -n 's|^// expect: ||p' "$program" > $DIRECTORY/expected
+    error=$(sed -n 's|^// expect error: ||p' "$program")
+    sed -n 's|^// profile: ||p' "$program" > $DIRECTORY/profile.json
+
+    if [ -n "$error" ]; then
+        if $COMPILER "$program" test/ornglib/*.orng -o $DIRECTORY/out.js > $DIRECTORY/compiled 2>&1; then
+            echo "FAIL $name: compiled, expected error \"$error\""
+            failed=1
+        elif ! grep -qF "$error" $DIRECTORY/compiled; then
+            echo "FAIL $name: expected error \"$error\", got:"
+            cat $DIRECTORY/compiled
+            failed=1
+        else
+            echo "ok   $name"
+        fi
+        continue
+    fi
+
+    passed=1
+    modes="default --minify --ir --split --stream -j --heap"
+    if [ -s $DIRECTORY/profile.json ]; then
+        modes="$modes --profile-use --profile-stream"
+    fi
+    for mode in $modes; do
+        output=$DIRECTORY/out.js
+        case $mode in
+            default)        flags="" ;;
+            --split)        flags=$mode; output=$DIRECTORY/split/out.js; rm -f $DIRECTORY/split/*.js ;;
+            -j)             flags="-j 4" ;;
+            --profile-use)  flags="--profile-use $DIRECTORY/profile.json -j 4" ;;
+            --profile-stream) flags="--profile-use $DIRECTORY/profile.json --stream" ;;
+            *)              flags=$mode ;;
+        esac
+        if ! $COMPILER "$program" test/ornglib/*.orng -o $output $flags > $DIRECTORY/compiled 2>&1; then
+            echo "FAIL $name $mode: did not compile:"
+            cat $DIRECTORY/compiled
+            passed=0
+        elif ! node -r $DIRECTORY/workers.js $output > $DIRECTORY/actual 2>&1 || ! cmp -s $DIRECTORY/expected $DIRECTORY/actual; then
+            echo "FAIL $name $mode: expected"
+            cat $DIRECTORY/expected
+            echo "got"
+            cat $DIRECTORY/actual
+            passed=0
+        fi
+    done
+    if [ $passed = 1 ]; then
+        echo "ok   $name"
+    else
+        failed=1
+    fi
+done
+exit $failed
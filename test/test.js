@@ -3,36 +3,42 @@
 	Written and developed by Joseph Shimel
 	https://github.com/rakhyvel/Orange
 */
-_3v={NULL_POINTER:0};
+_bg={NULL_POINTER:0};
 class _w {
-	constructor(width, height, next) {this.width=width;this.height=height;this.next=next;}
+	constructor(width, height, next) {this.width=width|0;this.height=height|0;this.next=next??null;}
 }
 class _10 {
 	constructor() {}
 }
 class _11 {
-	constructor(x, y, w, h) {this.x=x;this.y=y;this.w=w;this.h=h;}
+	constructor(x, y, w, h) {this.x=x|0;this.y=y|0;this.w=w|0;this.h=h|0;}
 }
 class _16 {
-	constructor(x, y) {this.x=x;this.y=y;}
+	constructor(x, y) {this.x=x|0;this.y=y|0;}
 }
 class _19 {
-	constructor(a, r, g, b) {this.a=a;this.r=r;this.g=g;this.b=b;}
+	constructor(a, r, g, b) {this.a=a|0;this.r=r|0;this.g=g|0;this.b=b|0;}
 }
 class _1e {
-	constructor(offsetX, offsetY) {this.offsetX=offsetX;this.offsetY=offsetY;}
+	constructor(offsetX, offsetY) {this.offsetX=offsetX|0;this.offsetY=offsetY|0;}
 }
 class _1h {
-	constructor(keyCode) {this.keyCode=keyCode;}
+	constructor(keyCode) {this.keyCode=keyCode|0;}
 }
-class _3o {
-	constructor(src) {this.src=src;}
+class _77 {
+	constructor(src) {this.src=src??null;}
 }
-class _3y {
-	constructor(next, prev, data) {this.next=next;this.prev=prev;this.data=data;}
+class _7e {
+	constructor(data, head, size, mask) {this.data=data??null;this.head=head|0;this.size=size|0;this.mask=mask|0;}
 }
-class _42 {
-	constructor(head, tail, size) {this.head=head;this.tail=tail;this.size=size;}
+class _8x {
+	constructor(keys, values, used, size, limit, mask, shift) {this.keys=keys??null;this.values=values??null;this.used=used??null;this.size=size|0;this.limit=limit|0;this.mask=mask|0;this.shift=shift|0;}
+}
+class _bj {
+	constructor(data, size) {this.data=data??null;this.size=size|0;}
+}
+class _d6 {
+	constructor(keys, values, hashes, used, size, limit, mask) {this.keys=keys??null;this.values=values??null;this.hashes=hashes??null;this.used=used??null;this.size=size|0;this.limit=limit|0;this.mask=mask|0;}
 }
 let _2=0.000000;
 let _3=0;
@@ -44,30 +50,133 @@ let _8=83;
 let _9=68;
 let _1j;
 let _1k;
-function _a(){let _l=0;while(_l<256){_5[_l]=false;_l=_l+1;}_1l("canvas");_32("mousemove", _c);_38("keydown", _f);_38("keyup", _i);_3i(_n);}
+let _1l;
+let _1m;
+let _1n;
+let _1o;
+let _1p;
+let _1q;
+let _1r;
+let _1s=12;
+let _1t=0;
+let _1u=1;
+let _1v=2;
+let _1w=32;
+let _1x;
+let _1y;
+let _1z;
+let _20;
+let _21;
+let _22;
+let _23;
+let _24;
+let _fu=1024;
+let _fv=false;
+let _fw;
+let _fx=0;
+function _a(){let _l=0;if(256<=_5.length){_5.fill(false,_l,256);_l=256}for(;_l<256;_l++){_5[_l]=false;}_25("canvas");_6l("mousemove", _c);_6r("keydown", _f);_6r("keyup", _i);_71(_n);}
 function _c(_d){}
 function _f(_g){_5[_g.keyCode]=true;}
 function _i(_j){_5[_j.keyCode]=false;}
-function _n(_o){let _q=_o-_2;_2=_o;_1q(255, 255, 255, 255);_2e(0, 0, _3e(), _3g());_1q(255, 255, 128, 0);if(_5[_6]){_4=_4-_q/16.000000;}if(_5[_8]){_4=_4+_q/16.000000;}if(_5[_7]){_3=_3-_q/16.000000;}if(_5[_9]){_3=_3+_q/16.000000;}_2e(_3, _4, 50, 50);_3i(_n);}
-function _1l(_1m){_1j=document.getElementById(_1m);_1k=_1j.getContext('2d');}
-function _1o(){}
-function _1q(_1r, _1s, _1t, _1u){_1k.fillStyle='rgba('+_1s+','+_1t+','+_1u+','+_1r+')';_1k.strokeStyle='rgba('+_1s+','+_1t+','+_1u+','+_1r+')';}
-function _1w(_1x){_1k.lineWidth=_1x;}
-function _1z(_20){_1k.font=_20;}
-function _22(_23, _24, _25, _26){_1k.beginPath();_1k.moveTo(_23,_24);_1k.lineTo(_25,_26);_1k.stroke();}
-function _28(_29, _2a, _2b, _2c){_1k.beginPath();_1k.rect(_29,_2a,_2b,_2c);_1k.stroke();}
-function _2e(_2f, _2g, _2h, _2i){_1k.fillRect(_2f,_2g,_2h,_2i);}
-function _2k(_2l, _2m, _2n){_1k.drawImage(_2l,_2m,_2n);}
-function _2p(_2q, _2r, _2s){_1k.fillText(_2q,_2r,_2s);}
-function _2u(_2v, _2w){}
-function _2y(_2z, _30){}
-function _32(_33, _34){_1j.addEventListener(_33,_34);}
-function _38(_39, _3a){document.addEventListener(_39,_3a);}
-function _3e(){return _1j.width;}
-function _3g(){return _1j.height;}
-function _3i(_3j){window.requestAnimationFrame(_3j);}
-function _3q(_3r){let _3t=new Image();_3t.onload=function(){};_3t.src=_3r;return _3t;}
-function _46(){}
-function _49(_4a){console.log(_4a);}
-function _4c(_4d){}
+function _n(_o){let _q=_o-_2;_2=_o;_2a(255, 255, 255, 255);_5t(0, 0, _6x(), _6z());_2a(255, 255, 128, 0);if(_5[_6]){_4=(_4-_q/16.000000|0);}if(_5[_8]){_4=(_4+_q/16.000000|0);}if(_5[_7]){_3=(_3-_q/16.000000|0);}if(_5[_9]){_3=(_3+_q/16.000000|0);}_5t(_3, _4, 50, 50);_71(_n);}
+function _25(_26){_1j=document.getElementById(_26);_1k=_1j.getContext('2d');_1o=new Map();_1p=255<<24;_1q=1;_1r=true;_1o.set(_1p,'rgba(0,0,0,255)');_1l=_1p;_1m=_1q;_1n="";_1x=false;_23=0;_24=0;}
+function _28(){}
+function _2a(_2b, _2c, _2d, _2e){let _2g=_2b<<24|_2c<<16|_2d<<8|_2e;if(!_1o.has(_2g))_1o.set(_2g,'rgba('+_2c+','+_2d+','+_2e+','+_2b+')');_1p=_2g;_1r=_2b==255;if(_1x==false){_2q(_1p);}}
+function _2i(_2j){_1q=_2j;if(_1x==false){_2u(_1q);}}
+function _2m(_2n){if(_2n!=_1n){_1n=_2n;_1k.font=_2n;}}
+function _2q(_2r){if(_2r!=_1l){_1l=_2r;let style=_1o.get(_2r);_1k.fillStyle=style;_1k.strokeStyle=style;}}
+function _2u(_2v){if(_2v!=_1m){_1m=_2v;_1k.lineWidth=_2v;}}
+function _2y(){_1x=true;}
+function _30(){_32();_1x=false;}
+function _32(){let _34=0;let _35=0;for(;_35<_23;_35++){let _37=Math.imul(_35,_1s);let _38=_3x(_37, _34);let _39=Math.imul(_38,4);if(_38==_34){_20[_38]=_35;_22[_39]=_1y[(_37+8|0)];_22[(_39+1|0)]=_1y[(_37+9|0)];_22[(_39+2|0)]=_1y[(_37+10|0)];_22[(_39+3|0)]=_1y[(_37+11|0)];_34=(_34+1|0);}else{let _3c=_21[_38];_1z[_3c]=_35;_22[_39]=_53(_22[_39], _1y[(_37+8|0)]);_22[(_39+1|0)]=_53(_22[(_39+1|0)], _1y[(_37+9|0)]);_22[(_39+2|0)]=_58(_22[(_39+2|0)], _1y[(_37+10|0)]);_22[(_39+3|0)]=_58(_22[(_39+3|0)], _1y[(_37+11|0)]);}_21[_38]=_35;_1z[_35]=0-1;}let _3d=0;for(;_3d<_34;_3d++){_4n(_3d);}_23=0;_2q(_1p);_2u(_1q);}
+function _3f(_3g, _3h, _3i, _3j, _3k){if(_23==_24){_3r();}let _3n=0;if(_3g!=_1t){_3n=_1q;}let _3p=Math.imul(_23,_1s);_1y[_3p]=_3g;_1y[(_3p+1|0)]=_1p;_1y[(_3p+2|0)]=_1q;_1y[(_3p+3|0)]=0;if(_1r){_1y[(_3p+3|0)]=1;}_1y[(_3p+4|0)]=_3h;_1y[(_3p+5|0)]=_3i;_1y[(_3p+6|0)]=_3j;_1y[(_3p+7|0)]=_3k;_1y[(_3p+8|0)]=(_53(_3h, _3j)-_3n|0);_1y[(_3p+9|0)]=(_53(_3i, _3k)-_3n|0);_1y[(_3p+10|0)]=(_58(_3h, _3j)+_3n|0);_1y[(_3p+11|0)]=(_58(_3i, _3k)+_3n|0);_23=(_23+1|0);}
+function _3r(){let _3t=Math.imul(_24,2);if(_3t==0){_3t=256;}let _3v=new Int32Array(Math.imul(_3t,_1s));if(_23>0){_3v.set(_1y);}_1y=_3v;_1z=new Int32Array(_3t);_20=new Int32Array(_3t);_21=new Int32Array(_3t);_22=new Int32Array(Math.imul(_3t,4));_24=_3t;}
+function _3x(_3y, _3z){let _41=(_3z-1|0);let _42=(_3z-_1w|0);while(_41>=0&&_41>=_42){let _44=_20[_41];_44=Math.imul(_44,_1s);if(_1y[(_3y+3|0)]==1&&_47(_3y, _44)){return _41;}if(_4f(_3y, _41)){return _3z;}_41=_41-1;}return _3z;}
+function _47(_48, _49){let _4b=_1y[_48]==_1t;let _4c=_1y[_49]==_1t;if(_4b!=_4c){return false;}if(_1y[(_48+1|0)]!=_1y[(_49+1|0)]){return false;}return _4b||_1y[(_48+2|0)]==_1y[(_49+2|0)];}
+function _4f(_4g, _4h){let _4j=Math.imul(_4h,4);if(_1y[(_4g+8|0)]>=_22[(_4j+2|0)]){return false;}if(_1y[(_4g+10|0)]<=_22[_4j]){return false;}if(_1y[(_4g+9|0)]>=_22[(_4j+3|0)]){return false;}return _1y[(_4g+11|0)]>_22[(_4j+1|0)];}
+function _4n(_4o){let _4q=_20[_4o];let _4r=Math.imul(_4q,_1s);let _4s=_1y[_4r]==_1t;_2q(_1y[(_4r+1|0)]);if(_4s==false){_2u(_1y[(_4r+2|0)]);}_1k.beginPath();while(_4q>=0){_4r=Math.imul(_4q,_1s);let _4v=_1y[(_4r+4|0)];let _4w=_1y[(_4r+5|0)];let _4x=_1y[(_4r+6|0)];let _4y=_1y[(_4r+7|0)];if(_1y[_4r]==_1v){_1k.moveTo(_4v,_4w);_1k.lineTo(_4x,_4y);}else{_1k.rect(_4v,_4w,(_4x-_4v|0),(_4y-_4w|0));}_4q=_1z[_4q];}if(_4s){_1k.fill();}else{_1k.stroke();}}
+function _53(_54, _55){if(_54<_55){return _54;}return _55;}
+function _58(_59, _5a){if(_59>_5a){return _59;}return _5a;}
+function _5d(_5e, _5f, _5g, _5h){if(_1x){_3f(_1v, _5e, _5f, _5g, _5h);}else{_1k.beginPath();_1k.moveTo(_5e,_5f);_1k.lineTo(_5g,_5h);_1k.stroke();}}
+function _5l(_5m, _5n, _5o, _5p){if(_1x){_3f(_1u, _5m, _5n, (_5m+_5o|0), (_5n+_5p|0));}else{_1k.beginPath();_1k.rect(_5m,_5n,_5o,_5p);_1k.stroke();}}
+function _5t(_5u, _5v, _5w, _5x){if(_1x){_3f(_1t, _5u, _5v, (_5u+_5w|0), (_5v+_5x|0));}else{_1k.fillRect(_5u,_5v,_5w,_5x);}}
+function _61(_62, _63, _64){if(_1x){_32();}_1k.drawImage(_62,_63,_64);}
+function _67(_68, _69, _6a){if(_1x){_32();}_1k.fillText(_68,_69,_6a);}
+function _6d(_6e, _6f){}
+function _6h(_6i, _6j){}
+function _6l(_6m, _6n){_1j.addEventListener(_6m,_6n);}
+function _6r(_6s, _6t){document.addEventListener(_6s,_6t);}
+function _6x(){return _1j.width;}
+function _6z(){return _1j.height;}
+function _71(_72){window.requestAnimationFrame(_72);}
+function _79(_7a){let _7c=new Image();_7c.onload=function(){};_7c.src=_7a;return _7c;}
+function _7j(){return new _7e(new Array(8), 0, 0, 7);}
+function _7l(_7m, _7n){if(_7m.size>_7m.mask){_8o(_7m);}let _7q=_8k(_7m, (_7m.head+_7m.size|0));_7m.data[_7q]=_7n;_7m.size=(_7m.size+1|0);}
+function _7r(_7s, _7t){if(_7s.size>_7s.mask){_8o(_7s);}_7s.head=_8k(_7s, (_7s.head+_7s.mask|0));_7s.data[_7s.head]=_7t;_7s.size=(_7s.size+1|0);}
+function _7w(_7x){let _7z=_7x.data[_7x.head];_7x.data[_7x.head]=undefined;_7x.head=_8k(_7x, (_7x.head+1|0));_7x.size=(_7x.size-1|0);return _7z;}
+function _80(_81){_81.size=(_81.size-1|0);let _83=_8k(_81, (_81.head+_81.size|0));let _84=_81.data[_83];_81.data[_83]=undefined;return _84;}
+function _85(_86){return _86.data[_86.head];}
+function _88(_89){let _8b=_8k(_89, ((_89.head+_89.size|0)-1|0));return _89.data[_8b];}
+function _8c(_8d, _8e){let _8g=_8k(_8d, (_8d.head+_8e|0));return _8d.data[_8g];}
+function _8h(_8i){return _8i.size;}
+function _8k(_8l, _8m){return _8m&_8l.mask;}
+function _8o(_8p){let _8r=Math.imul(_8p.data.length,2);let _8s=new Array(_8r);let _8t=0;for(;_8t<_8p.size;_8t++){let _8v=_8k(_8p, (_8p.head+_8t|0));_8s[_8t]=_8p.data[_8v];}_8p.data=_8s;_8p.head=0;_8p.mask=(_8r-1|0);}
+function _95(){return _az(16, 28);}
+function _97(_98, _99, _9a){if(_98.size>=_98.limit){_b7(_98);}let _9d=_ak(_98, _99);if(_98.used[_9d]==0){_98.used[_9d]=1;_98.keys[_9d]=_99;_98.size=(_98.size+1|0);}_98.values[_9d]=_9a;}
+function _9f(_9g, _9h){let _9j=_ak(_9g, _9h);if(_9g.used[_9j]==0){return null;}return _9g.values[_9j];}
+function _9l(_9m, _9n){let _9p=_ak(_9m, _9n);return _9m.used[_9p]==1;}
+function _9q(_9r, _9s){let _9u=_ak(_9r, _9s);if(_9r.used[_9u]==0){return false;}let _9w=_av(_9r, (_9u+1|0));while(_9r.used[_9w]==1){let _9y=_ar(_9r, _9r.keys[_9w]);let _9z=_av(_9r, (_9w-_9y|0));let _a0=_av(_9r, (_9w-_9u|0));if(_a0<=_9z){_9r.keys[_9u]=_9r.keys[_9w];_9r.values[_9u]=_9r.values[_9w];_9u=_9w;}_9w=_av(_9r, (_9w+1|0));}_9r.used[_9u]=0;_9r.values[_9u]=undefined;_9r.size=(_9r.size-1|0);return true;}
+function _a2(_a3){return _a3.size;}
+function _a5(_a6, _a7){let _a9=_a7;for(;_a9<=_a6.mask;_a9++){if(_a6.used[_a9]==1){return _a9;}}return 0-1;}
+function _ac(_ad, _ae){return _ad.keys[_ae];}
+function _ag(_ah, _ai){return _ah.values[_ai];}
+function _ak(_al, _am){let _ao=_ar(_al, _am);while(_al.used[_ao]==1){if(_al.keys[_ao]==_am){return _ao;}_ao=_av(_al, (_ao+1|0));}return _ao;}
+function _ar(_as, _at){return Math.imul(_at,-1640531535)>>>_as.shift;}
+function _av(_aw, _ax){return _ax&_aw.mask;}
+function _az(_b0, _b1){let _b3=new Float64Array(_b0);let _b4=new Array(_b0);let _b5=new Uint8Array(_b0);let _b6=(_b0/4|0)*3;return new _8x(_b3, _b4, _b5, 0, _b6, (_b0-1|0), _b1);}
+function _b7(_b8){let _ba=(_b8.mask+1|0);let _bb=_az(Math.imul(_ba,2), (_b8.shift-1|0));let _bc=0;for(;_bc<_ba;_bc++){if(_b8.used[_bc]==1){_97(_bb, _b8.keys[_bc], _b8.values[_bc]);}}_b8.keys=_bb.keys;_b8.values=_bb.values;_b8.used=_bb.used;_b8.limit=_bb.limit;_b8.mask=_bb.mask;_b8.shift=_bb.shift;}
+function _bm(){return new _bj(new Array(8), 0);}
+function _bo(_bp, _bq){if(_bp.size==_bp.data.length){_co(_bp, Math.imul(_bp.size,2));}_bp.data[_bp.size]=_bq;_bp.size=(_bp.size+1|0);}
+function _bt(_bu, _bv){return _bu.data[_bv];}
+function _bx(_by, _bz, _c0){_by.data[_bz]=_c0;}
+function _c2(_c3){_c3.size=(_c3.size-1|0);let _c5=_c3.data[_c3.size];_c3.data[_c3.size]=undefined;return _c5;}
+function _c6(_c7, _c8){let _ca=_c7.data[_c8];_c7.data.copyWithin(_c8,(_c8+1|0),_c7.size);_c2(_c7);return _ca;}
+function _cb(_cc, _cd){let _cf=0;for(;_cf<_cc.size;_cf++){if(_cc.data[_cf]==_cd){return _cf;}}return 0-1;}
+function _ci(_cj){return _cj.size;}
+function _cl(_cm){_cm.data=new Array(8);_cm.size=0;}
+function _co(_cp, _cq){let _cs=new Array(_cq);let _ct=0;for(;_ct<_cp.size;_ct++){_cs[_ct]=_cp.data[_ct];}_cp.data=_cs;}
+function _cw(_cx){return new Int32Array(_d2(Math.imul(4,_cx)));}
+function _cz(_d0){return new Float64Array(_d2(Math.imul(8,_d0)));}
+function _d2(_d3){return new(typeof SharedArrayBuffer==='undefined'?ArrayBuffer:SharedArrayBuffer)(_d3);}
+function _de(){return _fc(16);}
+function _dg(_dh, _di, _dj){if(_dh.size>=_dh.limit){_fk(_dh);}let _dm=_f2(_di);let _dn=_eu(_dh, _di, _dm);if(_dh.used[_dn]==0){_dh.used[_dn]=1;_dh.keys[_dn]=_di;_dh.hashes[_dn]=_dm;_dh.size=(_dh.size+1|0);}_dh.values[_dn]=_dj;}
+function _dp(_dq, _dr){let _dt=_eu(_dq, _dr, _f2(_dr));if(_dq.used[_dt]==0){return null;}return _dq.values[_dt];}
+function _dv(_dw, _dx){let _dz=_eu(_dw, _dx, _f2(_dx));return _dw.used[_dz]==1;}
+function _e0(_e1, _e2){let _e4=_eu(_e1, _e2, _f2(_e2));if(_e1.used[_e4]==0){return false;}let _e6=_f8(_e1, (_e4+1|0));while(_e1.used[_e6]==1){let _e8=_f8(_e1, _e1.hashes[_e6]);let _e9=_f8(_e1, (_e6-_e8|0));let _ea=_f8(_e1, (_e6-_e4|0));if(_ea<=_e9){_e1.keys[_e4]=_e1.keys[_e6];_e1.values[_e4]=_e1.values[_e6];_e1.hashes[_e4]=_e1.hashes[_e6];_e4=_e6;}_e6=_f8(_e1, (_e6+1|0));}_e1.used[_e4]=0;_e1.keys[_e4]=undefined;_e1.values[_e4]=undefined;_e1.size=(_e1.size-1|0);return true;}
+function _ec(_ed){return _ed.size;}
+function _ef(_eg, _eh){let _ej=_eh;for(;_ej<=_eg.mask;_ej++){if(_eg.used[_ej]==1){return _ej;}}return 0-1;}
+function _em(_en, _eo){return _en.keys[_eo];}
+function _eq(_er, _es){return _er.values[_es];}
+function _eu(_ev, _ew, _ex){let _ez=_f8(_ev, _ex);while(_ev.used[_ez]==1){if(_ev.hashes[_ez]==_ex&&_ev.keys[_ez]==_ew){return _ez;}_ez=_f8(_ev, (_ez+1|0));}return _ez;}
+function _f2(_f3){let _f5=-2128831035;let _f6=0;for(;_f6<_f3.length;_f6++){_f5=Math.imul(_f5^_f3.charCodeAt(_f6),16777619);}return _f5;}
+function _f8(_f9, _fa){return _fa&_f9.mask;}
+function _fc(_fd){let _ff=new Array(_fd);let _fg=new Array(_fd);let _fh=new Int32Array(_fd);let _fi=new Uint8Array(_fd);let _fj=(_fd/4|0)*3;return new _d6(_ff, _fg, _fh, _fi, 0, _fj, (_fd-1|0));}
+function _fk(_fl){let _fn=(_fl.mask+1|0);let _fo=_fc(Math.imul(_fn,2));let _fp=0;for(;_fp<_fn;_fp++){if(_fl.used[_fp]==1){let _fs=_eu(_fo, _fl.keys[_fp], _fl.hashes[_fp]);_fo.used[_fs]=1;_fo.keys[_fs]=_fl.keys[_fp];_fo.values[_fs]=_fl.values[_fp];_fo.hashes[_fs]=_fl.hashes[_fp];}}_fl.keys=_fo.keys;_fl.values=_fo.values;_fl.hashes=_fo.hashes;_fl.used=_fo.used;_fl.limit=_fo.limit;_fl.mask=_fo.mask;}
+function _fy(_fz){if(_fv){console.log(_fz);}else{if(_fx==0){_fw=[];(typeof queueMicrotask==='function'?queueMicrotask:setTimeout)(_g5);}_fw.push(_fz);_fx=(_fx+1|0);if(_fx>=_fu){_g5();}}}
+function _g5(){if(_fx>0){console.log(_fw.join('\n'));_fx=0;}}
+function _g8(_g9){_g5();_fv=_g9;}
+function _gb(_gc){}
+function _gf(_gg){return new Float32Array(_gg);}
+function _gi(){let _gk=_gf(9);_gl(_gk);return _gk;}
+function _gl(_gm){{let _gp=0;if(9<=_gm.length){_gm.fill(0.000000,_gp,9);_gp=9}for(;_gp<9;_gp++){_gm[_gp]=0.000000;}}_gm[0]=1.000000;_gm[4]=1.000000;_gm[8]=1.000000;}
+function _gr(_gs, _gt, _gu, _gv, _gw, _gx){let _gz=Math.cos(_gv);let _h0=Math.sin(_gv);_gs[0]=_gz*_gw;_gs[1]=0.000000-_h0*_gx;_gs[2]=_gt;_gs[3]=_h0*_gw;_gs[4]=_gz*_gx;_gs[5]=_gu;_gs[6]=0.000000;_gs[7]=0.000000;_gs[8]=1.000000;}
+function _h1(_h2, _h3, _h4){let _h6=_h2[0];let _h7=_h2[1];let _h8=_h2[2];let _h9=_h2[3];let _ha=_h2[4];let _hb=_h2[5];let _hc=_h2[6];let _hd=_h2[7];let _he=_h2[8];let _hf=_h3[0];let _hg=_h3[1];let _hh=_h3[2];let _hi=_h3[3];let _hj=_h3[4];let _hk=_h3[5];let _hl=_h3[6];let _hm=_h3[7];let _hn=_h3[8];_h4[0]=_h6*_hf+_h7*_hi+_h8*_hl;_h4[1]=_h6*_hg+_h7*_hj+_h8*_hm;_h4[2]=_h6*_hh+_h7*_hk+_h8*_hn;_h4[3]=_h9*_hf+_ha*_hi+_hb*_hl;_h4[4]=_h9*_hg+_ha*_hj+_hb*_hm;_h4[5]=_h9*_hh+_ha*_hk+_hb*_hn;_h4[6]=_hc*_hf+_hd*_hi+_he*_hl;_h4[7]=_hc*_hg+_hd*_hj+_he*_hm;_h4[8]=_hc*_hh+_hd*_hk+_he*_hn;}
+function _ho(_hp, _hq, _hr, _hs, _ht){{let _hw=0;let _hx=_ht;for(;_hw<_hx;_hw++){_hp[_hw]=_hp[_hw]+_hr[_hw];_hq[_hw]=_hq[_hw]+_hs[_hw];}}}
+function _hz(_i0, _i1, _i2, _i3, _i4, _i5){{let _i8=0;let _i9=_i5;for(;_i8<_i9;_i8++){_i0[_i8]=_i0[_i8]+_i2[_i8]*_i4;_i1[_i8]=_i1[_i8]+_i3[_i8]*_i4;}}}
+function _ib(_ic, _id, _ie, _if){{let _ii=0;let _ij=_if;for(;_ii<_ij;_ii++){_ic[_ii]=_ic[_ii]*_ie;_id[_ii]=_id[_ii]*_ie;}}}
+function _il(_im, _in, _io, _ip, _iq, _ir){let _it=_im[0];let _iu=_im[1];let _iv=_im[2];let _iw=_im[3];let _ix=_im[4];let _iy=_im[5];{let _j0=0;let _j1=_ir;for(;_j0<_j1;_j0++){let _j3=_in[_j0];let _j4=_io[_j0];_ip[_j0]=_it*_j3+_iu*_j4+_iv;_iq[_j0]=_iw*_j3+_ix*_j4+_iy;}}}
+function _j5(_j6, _j7, _j8, _j9, _ja, _jb, _jc){{let _jf=0;let _jg=_jc;for(;_jf<_jg;_jf++){_j6[_jf]=_j6[_jf]+_j9[_jf];_j7[_jf]=_j7[_jf]+_ja[_jf];_j8[_jf]=_j8[_jf]+_jb[_jf];}}}
+function _ji(_jj, _jk, _jl, _jm, _jn){{let _jq=0;let _jr=_jn;for(;_jq<_jr;_jq++){_jj[_jq]=_jj[_jq]*_jm;_jk[_jq]=_jk[_jq]*_jm;_jl[_jq]=_jl[_jq]*_jm;}}}
+function _jt(_ju, _jv, _jw, _jx, _jy){let _k0=_ju[0];let _k1=_ju[1];let _k2=_ju[2];let _k3=_ju[3];let _k4=_ju[4];let _k5=_ju[5];let _k6=_ju[6];let _k7=_ju[7];let _k8=_ju[8];{let _ka=0;let _kb=_jy;for(;_ka<_kb;_ka++){let _kd=_jv[_ka];let _ke=_jw[_ka];let _kf=_jx[_ka];_jv[_ka]=_k0*_kd+_k1*_ke+_k2*_kf;_jw[_ka]=_k3*_kd+_k4*_ke+_k5*_kf;_jx[_ka]=_k6*_kd+_k7*_ke+_k8*_kf;}}}
+function _kg(_kh, _ki, _kj, _kk, _kl, _km, _kn, _ko, _kp, _kq){let _ks=0;{let _ku=0;let _kv=_kq;for(;_ku<_kv;_ku++){let _kx=0;if(_kh[_ku]<=_kn&&_kj[_ku]>=_kl&&_ki[_ku]<=_ko&&_kk[_ku]>=_km){_kx=1;}_kp[_ku]=_kx;_ks=(_ks+_kx|0);}}return _ks;}
 _a()
@@ -0,0 +1,161 @@
+/*  alloc.c
+
+    Counts the memory used by the compiler's data structures. Each allocation
+    is counted under its kind, and under the phase of the compiler it was made
+    in, so that a report can show which structures take up the most memory 
+    while compiling large programs. The time spent in each phase is kept too.
+
+    Frees are given the size of what is freed, so nothing extra is kept next
+    to each allocation. Counts are added atomically, and the peak is raised
+    with a compare and swap, since code is generated on more than one thread
+    with -j. Phases are only started while no other threads are running.
+    
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "alloc.h"
+#include "./debug.h"
+
+#define MAX_PHASES 8
+
+// Memory allocated and freed while the compiler was in a phase
+struct phaseStats {
+    const char* name;
+    long allocBytes[ALLOC_KINDS];
+    long allocObjects[ALLOC_KINDS];
+    long freeBytes[ALLOC_KINDS];
+    long peak;  // most bytes live at any point in the phase
+    long live;  // bytes live when the phase last ended
+    double seconds; // time spent in the phase
+};
+
+static const char* kindNames[ALLOC_KINDS] = {"tokens", "ast nodes", "symbols", "maps", "lists", "deques", "vectors"};
+static struct phaseStats phases[MAX_PHASES] = {{.name = "startup"}};
+static int numPhases = 1;
+static struct phaseStats* current = &phases[0];
+static long live = 0;
+static long liveObjects[ALLOC_KINDS];
+static double phaseStart = 0; // when the current phase was last started
+
+static void count(enum allocKind, long, int);
+static double now();
+static void endPhase();
+
+/*  Allocates memory, counting it under a kind */
+void* alloc_malloc(enum allocKind kind, size_t size) {
+    count(kind, size, 1);
+    return malloc(size);
+}
+
+/*  Allocates memory that is set to zero, counting it under a kind */
+void* alloc_calloc(enum allocKind kind, size_t number, size_t size) {
+    count(kind, number * size, 1);
+    return calloc(number, size);
+}
+
+/*  Frees memory given by alloc_malloc or alloc_calloc. The size must be the
+    size it was allocated with */
+void alloc_free(enum allocKind kind, void* data, size_t size) {
+    if(data == NULL) {
+        return;
+    }
+    count(kind, -(long)size, -1);
+    free(data);
+}
+
+/*
+    Starts a phase of the compiler. Phases can be started more than once, like
+    lexing and parsing for each file, in which case their counts add up. */
+void alloc_phase(const char* name) {
+    endPhase();
+    for(int i = 0; i < numPhases; i++) {
+        if(!strcmp(phases[i].name, name)) {
+            current = &phases[i];
+            return;
+        }
+    }
+    ASSERT(numPhases < MAX_PHASES);
+    current = &phases[numPhases++];
+    current->name = name;
+    current->peak = live;
+}
+
+/*
+    Prints how much memory was allocated in each phase for each kind, as bytes
+    and number of objects, followed by the bytes that were live when each phase
+    ended and at the most in each phase */
+void alloc_report(FILE* out) {
+    endPhase();
+    fprintf(out, "%-10s", "phase");
+    for(int kind = 0; kind < ALLOC_KINDS; kind++) {
+        fprintf(out, " %22s", kindNames[kind]);
+    }
+    fprintf(out, " %12s %12s\n", "live", "peak");
+    for(int i = 0; i < numPhases; i++) {
+        struct phaseStats* phase = &phases[i];
+        fprintf(out, "%-10s", phase->name);
+        for(int kind = 0; kind < ALLOC_KINDS; kind++) {
+            fprintf(out, " %12ld (%7ld)", phase->allocBytes[kind], phase->allocObjects[kind]);
+        }
+        fprintf(out, " %12ld %12ld\n", phase->live, phase->peak);
+    }
+    fprintf(out, "%-10s", "still live");
+    for(int kind = 0; kind < ALLOC_KINDS; kind++) {
+        long bytes = 0;
+        for(int i = 0; i < numPhases; i++) {
+            bytes += phases[i].allocBytes[kind] - phases[i].freeBytes[kind];
+        }
+        fprintf(out, " %12ld (%7ld)", bytes, liveObjects[kind]);
+    }
+    fprintf(out, "\n");
+}
+
+/*
+    Prints the seconds spent in each phase, one phase to a line */
+void alloc_timeReport(FILE* out) {
+    endPhase();
+    for(int i = 0; i < numPhases; i++) {
+        fprintf(out, "%-10s %12.6f\n", phases[i].name, phases[i].seconds);
+    }
+}
+
+/*
+    Adds an allocation, or takes away a free, from the counts of the current
+    phase and the live total */
+static void count(enum allocKind kind, long bytes, int objects) {
+    if(bytes >= 0) {
+        __atomic_add_fetch(&current->allocBytes[kind], bytes, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&current->allocObjects[kind], objects, __ATOMIC_RELAXED);
+    } else {
+        __atomic_add_fetch(&current->freeBytes[kind], -bytes, __ATOMIC_RELAXED);
+    }
+    __atomic_add_fetch(&liveObjects[kind], objects, __ATOMIC_RELAXED);
+    long now = __atomic_add_fetch(&live, bytes, __ATOMIC_RELAXED);
+    long peak = __atomic_load_n(&current->peak, __ATOMIC_RELAXED);
+    while(now > peak && !__atomic_compare_exchange_n(&current->peak, &peak, now, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // peak now holds what another thread raised it to, try again if it is still lower
+    }
+}
+
+static double now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/*
+    Adds the time since the current phase was started to it, and keeps what
+    is live at the end of it. The startup phase starts with the first call. */
+static void endPhase() {
+    double time = now();
+    if(phaseStart > 0) {
+        current->seconds += time - phaseStart;
+    }
+    phaseStart = time;
+    current->live = live;
+}
@@ -0,0 +1,22 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// What an allocation is for, memory is counted separately for each kind
+enum allocKind {
+    ALLOC_TOKEN, ALLOC_AST, ALLOC_SYMBOL, ALLOC_MAP, ALLOC_LIST, ALLOC_DEQUE, ALLOC_VECTOR, ALLOC_KINDS
+};
+
+// Counted allocation
+void* alloc_malloc(enum allocKind, size_t);
+void* alloc_calloc(enum allocKind, size_t, size_t);
+void alloc_free(enum allocKind, void*, size_t);
+
+// Phases and reporting
+void alloc_phase(const char*);
+void alloc_report(FILE*);
+void alloc_timeReport(FILE*);
+
+#endif
@@ -0,0 +1,786 @@
+/*  compress.c
+
+    Compresses buffers into gzip (RFC 1951, RFC 1952) and brotli (RFC 7932)
+    streams, so that output files can be served already compressed.
+
+    Both formats are built the same way. Repeated strings are found with hash
+    chains over a 32K window, and each block is written with prefix codes
+    made from the block's own symbol counts. The level, from 0 to 9, sets how
+    far down the hash chains matches are searched for. Level 0 does not look
+    for repeated strings at all, and levels 4 and up check if waiting a byte
+    gives a longer match.
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "./compress.h"
+#include "./debug.h"
+
+#define WINDOW_SIZE 32768
+#define WINDOW_MASK (WINDOW_SIZE - 1)
+#define HASH_SIZE 32768
+#define MIN_MATCH 3
+#define MAX_BITS 15
+#define DEFLATE_BLOCK_SIZE 65536
+#define BROTLI_BLOCK_SIZE (1 << 24)
+
+/*
+    A run of literal bytes, followed by a copy of earlier bytes. Only the last
+    command of a buffer may have a copy length of 0 */
+struct command {
+    int insert;     // number of literal bytes before the copy
+    int copy;       // number of bytes copied
+    int distance;   // how far back the copied bytes start
+};
+
+/*
+    Finds repeated strings in a buffer. Chains link every position to the
+    previous position with the same hash of its next three bytes. */
+struct matcher {
+    const unsigned char* data;
+    int end;        // matches do not go past here
+    int inserted;   // positions before this are in the hash chains
+    int maxChain;   // number of chain links followed looking for a match
+    int maxCopy;    // longest match allowed
+    int* head;      // hash -> most recent position with that hash
+    int* prev;      // position -> previous position with the same hash
+};
+
+/*
+    Writes bits to a buffer that grows as needed, least significant bit
+    first */
+struct bitWriter {
+    unsigned char* data;
+    int length;
+    int capacity;
+    unsigned long long bits;
+    int numBits;
+};
+
+// Deflate length and distance codes
+static const int lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const int distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const int distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const int deflateCodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// Brotli insert and copy length codes
+static const int insertBase[24] = {0, 1, 2, 3, 4, 5, 6, 8, 10, 14, 18, 26, 34, 50, 66, 98, 130, 194, 322, 578, 1090, 2114, 6210, 22594};
+static const int insertExtra[24] = {0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 7, 8, 9, 10, 12, 14, 24};
+static const int copyBase[24] = {2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 14, 18, 22, 30, 38, 54, 70, 102, 134, 198, 326, 582, 1094, 2118};
+static const int copyExtra[24] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 7, 8, 9, 10, 24};
+static const int brotliCodeLengthOrder[18] = {1, 2, 3, 4, 0, 5, 17, 6, 16, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+// Static prefix code that brotli code length code lengths are written with
+static const int brotliLengthCodes[6] = {0, 7, 3, 2, 1, 15};
+static const int brotliLengthBits[6] = {2, 4, 3, 2, 2, 4};
+
+static struct command* findCommands(const unsigned char*, int, int, int, int, int*);
+static int longestMatch(struct matcher*, int, int*);
+static void insertPositions(struct matcher*, int);
+static void writeDeflateBlock(struct bitWriter*, const unsigned char*, int, struct command*, int, int);
+static void writeBrotliMetaBlock(struct bitWriter*, const unsigned char*, int, int, struct command*, int, int, int*);
+static void writeBrotliPrefixCode(struct bitWriter*, const unsigned char*, int, int);
+static void buildLengths(const int*, int, int, unsigned char*);
+static int huffmanLengths(const int*, int, unsigned char*);
+static void buildCodes(const unsigned char*, int, unsigned int*);
+static int findCode(const int*, int, int);
+static int compareKeys(const void*, const void*);
+static unsigned int crc32(const unsigned char*, int);
+static void writeBits(struct bitWriter*, unsigned long long, int);
+static void writeByte(struct bitWriter*, unsigned char);
+static void alignByte(struct bitWriter*);
+
+/*
+    Compresses a buffer into a gzip file, made of a header, deflate blocks,
+    and the CRC and length of the original buffer. The modification time is
+    left as 0, so that the same input always gives the same output. */
+unsigned char* compress_gzip(const unsigned char* data, int length, int level, int* outLength) {
+    struct bitWriter writer = {NULL, 0, 0, 0, 0};
+    unsigned char header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, level >= 9 ? 2 : level <= 1 ? 4 : 0, 255};
+    for(int i = 0; i < 10; i++) {
+        writeByte(&writer, header[i]);
+    }
+
+    int numCommands;
+    struct command* commands = findCommands(data, 0, length, level, lengthBase[28], &numCommands);
+    int first = 0;
+    int pos = 0;
+    do { // Always write at least one block, even for empty input
+        int last = first;
+        int blockEnd = pos;
+        while(last < numCommands && blockEnd - pos < DEFLATE_BLOCK_SIZE) {
+            blockEnd += commands[last].insert + commands[last].copy;
+            last++;
+        }
+        writeDeflateBlock(&writer, data, pos, commands + first, last - first, last == numCommands);
+        first = last;
+        pos = blockEnd;
+    } while(first < numCommands);
+    alignByte(&writer);
+
+    unsigned int crc = crc32(data, length);
+    for(int i = 0; i < 4; i++) {
+        writeByte(&writer, (crc >> (8 * i)) & 0xFF);
+    }
+    for(int i = 0; i < 4; i++) {
+        writeByte(&writer, ((unsigned int)length >> (8 * i)) & 0xFF);
+    }
+    free(commands);
+    *outLength = writer.length;
+    return writer.data;
+}
+
+/*
+    Compresses a buffer into a brotli stream. The stream uses a 64K window,
+    and each meta-block uses one literal code, one insert and copy code, and
+    one distance code, without context modeling. */
+unsigned char* compress_brotli(const unsigned char* data, int length, int level, int* outLength) {
+    struct bitWriter writer = {NULL, 0, 0, 0, 0};
+    writeBits(&writer, 0, 1); // WBITS = 16
+    if(length == 0) {
+        writeBits(&writer, 1, 1); // ISLAST
+        writeBits(&writer, 1, 1); // ISLASTEMPTY
+    }
+    int lastDistance = 4;
+    for(int start = 0; start < length; start += BROTLI_BLOCK_SIZE) {
+        int end = start + BROTLI_BLOCK_SIZE < length ? start + BROTLI_BLOCK_SIZE : length;
+        int numCommands;
+        struct command* commands = findCommands(data, start, end, level, 1 << 16, &numCommands);
+        writeBrotliMetaBlock(&writer, data, start, end, commands, numCommands, end == length, &lastDistance);
+        free(commands);
+    }
+    alignByte(&writer);
+    *outLength = writer.length;
+    return writer.data;
+}
+
+/*
+    Splits the bytes from start to end into commands. Bytes before start
+    can still be copied from. */
+static struct command* findCommands(const unsigned char* data, int start, int end, int level, int maxCopy, int* numCommands) {
+    struct matcher matcher;
+    matcher.data = data;
+    matcher.end = end;
+    matcher.inserted = start - WINDOW_SIZE > 0 ? start - WINDOW_SIZE : 0;
+    matcher.maxChain = level > 0 ? 4 << level : 0;
+    matcher.maxCopy = maxCopy;
+    matcher.head = (int*)malloc(HASH_SIZE * sizeof(int));
+    matcher.prev = (int*)malloc(WINDOW_SIZE * sizeof(int));
+    for(int i = 0; i < HASH_SIZE; i++) {
+        matcher.head[i] = -1;
+    }
+
+    int capacity = 64;
+    struct command* commands = (struct command*)malloc(capacity * sizeof(struct command));
+    *numCommands = 0;
+    int literalStart = start;
+    int pos = start;
+    while(pos < end) {
+        int distance;
+        int length = longestMatch(&matcher, pos, &distance);
+        if(length >= MIN_MATCH && level >= 4 && pos + 1 < end) {
+            int nextDistance;
+            if(longestMatch(&matcher, pos + 1, &nextDistance) > length) {
+                pos++; // Leave this byte as a literal, the match at the next byte is better
+                continue;
+            }
+        }
+        if(length < MIN_MATCH) {
+            pos++;
+            continue;
+        }
+        if(*numCommands == capacity) {
+            capacity *= 2;
+            commands = (struct command*)realloc(commands, capacity * sizeof(struct command));
+        }
+        commands[*numCommands].insert = pos - literalStart;
+        commands[*numCommands].copy = length;
+        commands[*numCommands].distance = distance;
+        (*numCommands)++;
+        pos += length;
+        literalStart = pos;
+    }
+    if(literalStart < end) {
+        if(*numCommands == capacity) {
+            capacity *= 2;
+            commands = (struct command*)realloc(commands, capacity * sizeof(struct command));
+        }
+        commands[*numCommands].insert = end - literalStart;
+        commands[*numCommands].copy = 0;
+        commands[*numCommands].distance = 0;
+        (*numCommands)++;
+    }
+    free(matcher.head);
+    free(matcher.prev);
+    return commands;
+}
+
+/*
+    Returns the length of the longest earlier string that matches the string
+    at a position, and sets how far back it is. */
+static int longestMatch(struct matcher* matcher, int pos, int* distance) {
+    insertPositions(matcher, pos);
+    int best = 0;
+    int maxLength = matcher->end - pos < matcher->maxCopy ? matcher->end - pos : matcher->maxCopy;
+    if(maxLength < MIN_MATCH || matcher->maxChain == 0) {
+        return 0;
+    }
+    const unsigned char* data = matcher->data;
+    int hash = ((data[pos] << 10) ^ (data[pos + 1] << 5) ^ data[pos + 2]) & (HASH_SIZE - 1);
+    int candidate = matcher->head[hash];
+    for(int chain = matcher->maxChain; candidate >= 0 && pos - candidate < WINDOW_SIZE && chain > 0; chain--) {
+        if(data[candidate + best] == data[pos + best]) {
+            int length = 0;
+            while(length < maxLength && data[candidate + length] == data[pos + length]) {
+                length++;
+            }
+            if(length > best) {
+                best = length;
+                *distance = pos - candidate;
+                if(length == maxLength) {
+                    break;
+                }
+            }
+        }
+        int next = matcher->prev[candidate & WINDOW_MASK];
+        if(next >= candidate) {
+            break;
+        }
+        candidate = next;
+    }
+    return best;
+}
+
+/*
+    Adds every position before the given position to the hash chains */
+static void insertPositions(struct matcher* matcher, int pos) {
+    const unsigned char* data = matcher->data;
+    for(; matcher->inserted < pos; matcher->inserted++) {
+        int i = matcher->inserted;
+        if(i + MIN_MATCH > matcher->end) {
+            continue;
+        }
+        int hash = ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & (HASH_SIZE - 1);
+        matcher->prev[i & WINDOW_MASK] = matcher->head[hash];
+        matcher->head[hash] = i;
+    }
+}
+
+/*
+    Writes a deflate block with dynamic prefix codes. The literal/length and
+    distance code lengths are run length encoded together, and are written
+    with a third prefix code. */
+static void writeDeflateBlock(struct bitWriter* writer, const unsigned char* data, int pos, struct command* commands, int numCommands, int isFinal) {
+    int literalFreqs[286] = {0};
+    int distanceFreqs[30] = {0};
+    int start = pos;
+    for(int i = 0; i < numCommands; i++) {
+        for(int j = 0; j < commands[i].insert; j++) {
+            literalFreqs[data[pos++]]++;
+        }
+        if(commands[i].copy > 0) {
+            literalFreqs[257 + findCode(lengthBase, 29, commands[i].copy)]++;
+            distanceFreqs[findCode(distanceBase, 30, commands[i].distance)]++;
+            pos += commands[i].copy;
+        }
+    }
+    literalFreqs[256] = 1; // end of block
+
+    unsigned char literalLengths[286];
+    unsigned char distanceLengths[30];
+    buildLengths(literalFreqs, 286, MAX_BITS, literalLengths);
+    buildLengths(distanceFreqs, 30, MAX_BITS, distanceLengths);
+    int numLiterals = 286;
+    while(numLiterals > 257 && literalLengths[numLiterals - 1] == 0) numLiterals--;
+    int numDistances = 30;
+    while(numDistances > 1 && distanceLengths[numDistances - 1] == 0) numDistances--;
+    unsigned char lengths[286 + 30];
+    memcpy(lengths, literalLengths, numLiterals);
+    memcpy(lengths + numLiterals, distanceLengths, numDistances);
+
+    // Run length encode the code lengths
+    int numLengths = numLiterals + numDistances;
+    int symbols[286 + 30];
+    int extras[286 + 30];
+    int numSymbols = 0;
+    int codeLengthFreqs[19] = {0};
+    for(int i = 0; i < numLengths;) {
+        int run = 1;
+        while(i + run < numLengths && lengths[i + run] == lengths[i]) {
+            run++;
+        }
+        i += run;
+        if(lengths[i - run] == 0) {
+            while(run >= 11) {
+                int repeat = run < 138 ? run : 138;
+                symbols[numSymbols] = 18;
+                extras[numSymbols++] = repeat - 11;
+                run -= repeat;
+            }
+            if(run >= 3) {
+                symbols[numSymbols] = 17;
+                extras[numSymbols++] = run - 3;
+                run = 0;
+            }
+        } else if(run >= 4) {
+            symbols[numSymbols] = lengths[i - run];
+            extras[numSymbols++] = 0;
+            run--;
+            while(run >= 3) {
+                int repeat = run < 6 ? run : 6;
+                symbols[numSymbols] = 16;
+                extras[numSymbols++] = repeat - 3;
+                run -= repeat;
+            }
+        }
+        for(; run > 0; run--) {
+            symbols[numSymbols] = lengths[i - run];
+            extras[numSymbols++] = 0;
+        }
+    }
+    for(int i = 0; i < numSymbols; i++) {
+        codeLengthFreqs[symbols[i]]++;
+    }
+    unsigned char codeLengthLengths[19];
+    unsigned int codeLengthCodes[19];
+    buildLengths(codeLengthFreqs, 19, 7, codeLengthLengths);
+    buildCodes(codeLengthLengths, 19, codeLengthCodes);
+    int numCodeLengths = 19;
+    while(numCodeLengths > 4 && codeLengthLengths[deflateCodeLengthOrder[numCodeLengths - 1]] == 0) numCodeLengths--;
+
+    // Header
+    writeBits(writer, isFinal, 1);
+    writeBits(writer, 2, 2); // dynamic prefix codes
+    writeBits(writer, numLiterals - 257, 5);
+    writeBits(writer, numDistances - 1, 5);
+    writeBits(writer, numCodeLengths - 4, 4);
+    for(int i = 0; i < numCodeLengths; i++) {
+        writeBits(writer, codeLengthLengths[deflateCodeLengthOrder[i]], 3);
+    }
+    for(int i = 0; i < numSymbols; i++) {
+        writeBits(writer, codeLengthCodes[symbols[i]], codeLengthLengths[symbols[i]]);
+        if(symbols[i] == 16) {
+            writeBits(writer, extras[i], 2);
+        } else if(symbols[i] == 17) {
+            writeBits(writer, extras[i], 3);
+        } else if(symbols[i] == 18) {
+            writeBits(writer, extras[i], 7);
+        }
+    }
+
+    // Data
+    unsigned int literalCodes[286];
+    unsigned int distanceCodes[30];
+    buildCodes(literalLengths, 286, literalCodes);
+    buildCodes(distanceLengths, 30, distanceCodes);
+    pos = start;
+    for(int i = 0; i < numCommands; i++) {
+        for(int j = 0; j < commands[i].insert; j++, pos++) {
+            writeBits(writer, literalCodes[data[pos]], literalLengths[data[pos]]);
+        }
+        if(commands[i].copy > 0) {
+            int lengthCode = findCode(lengthBase, 29, commands[i].copy);
+            writeBits(writer, literalCodes[257 + lengthCode], literalLengths[257 + lengthCode]);
+            writeBits(writer, commands[i].copy - lengthBase[lengthCode], lengthExtra[lengthCode]);
+            int distanceCode = findCode(distanceBase, 30, commands[i].distance);
+            writeBits(writer, distanceCodes[distanceCode], distanceLengths[distanceCode]);
+            writeBits(writer, commands[i].distance - distanceBase[distanceCode], distanceExtra[distanceCode]);
+            pos += commands[i].copy;
+        }
+    }
+    writeBits(writer, literalCodes[256], literalLengths[256]);
+}
+
+/*
+    Writes a compressed brotli meta-block for the bytes from start to end.
+    The last distance used is kept between meta-blocks, so that copies with
+    the same distance can use distance code 0. */
+static void writeBrotliMetaBlock(struct bitWriter* writer, const unsigned char* data, int start, int end, struct command* commands, int numCommands, int isLast, int* lastDistance) {
+    int* commandCodes = (int*)malloc((numCommands + 1) * sizeof(int));
+    int* distanceCodes = (int*)malloc((numCommands + 1) * sizeof(int));
+    int* distanceExtras = (int*)malloc((numCommands + 1) * sizeof(int));
+    int* distanceBits = (int*)malloc((numCommands + 1) * sizeof(int));
+    int literalFreqs[256] = {0};
+    int commandFreqs[704] = {0};
+    int distanceFreqs[64] = {0};
+    int pos = start;
+    for(int i = 0; i < numCommands; i++) {
+        for(int j = 0; j < commands[i].insert; j++) {
+            literalFreqs[data[pos++]]++;
+        }
+        pos += commands[i].copy;
+
+        // Insert and copy codes are combined, in cells of 64 with explicit distances
+        static const int cells[9] = {2, 3, 6, 4, 5, 8, 7, 9, 10};
+        int insertCode = findCode(insertBase, 24, commands[i].insert);
+        int copyCode = commands[i].copy > 0 ? findCode(copyBase, 24, commands[i].copy) : 0;
+        commandCodes[i] = cells[(copyCode >> 3) + 3 * (insertCode >> 3)] * 64 + ((insertCode & 7) << 3) + (copyCode & 7);
+        commandFreqs[commandCodes[i]]++;
+
+        if(commands[i].copy == 0) {
+            continue; // only ends the meta-block, no distance is read
+        } else if(commands[i].distance == *lastDistance) {
+            distanceCodes[i] = 0;
+            distanceBits[i] = 0;
+            distanceExtras[i] = 0;
+        } else {
+            int offset = commands[i].distance + 3;
+            int topBit = 31 - __builtin_clz(offset);
+            int numBits = topBit - 1;
+            int half = (offset >> numBits) & 1;
+            distanceCodes[i] = 16 + 2 * (numBits - 1) + half;
+            distanceBits[i] = numBits;
+            distanceExtras[i] = offset - ((2 + half) << numBits);
+            *lastDistance = commands[i].distance;
+        }
+        distanceFreqs[distanceCodes[i]]++;
+    }
+
+    // Header
+    int length = end - start;
+    int numNibbles = length - 1 < (1 << 16) ? 4 : length - 1 < (1 << 20) ? 5 : 6;
+    writeBits(writer, isLast, 1);
+    if(isLast) {
+        writeBits(writer, 0, 1); // ISLASTEMPTY
+    }
+    writeBits(writer, numNibbles - 4, 2);
+    writeBits(writer, length - 1, numNibbles * 4);
+    if(!isLast) {
+        writeBits(writer, 0, 1); // ISUNCOMPRESSED
+    }
+    writeBits(writer, 0, 1); // NBLTYPESL = 1
+    writeBits(writer, 0, 1); // NBLTYPESI = 1
+    writeBits(writer, 0, 1); // NBLTYPESD = 1
+    writeBits(writer, 0, 2); // NPOSTFIX = 0
+    writeBits(writer, 0, 4); // NDIRECT = 0
+    writeBits(writer, 0, 2); // context mode LSB6
+    writeBits(writer, 0, 1); // NTREESL = 1
+    writeBits(writer, 0, 1); // NTREESD = 1
+
+    unsigned char literalLengths[256];
+    unsigned char commandLengths[704];
+    unsigned char distanceLengths[64];
+    unsigned int literalCodes[256];
+    unsigned int commandCodeBits[704];
+    unsigned int distanceCodeBits[64];
+    buildLengths(literalFreqs, 256, MAX_BITS, literalLengths);
+    buildLengths(commandFreqs, 704, MAX_BITS, commandLengths);
+    buildLengths(distanceFreqs, 64, MAX_BITS, distanceLengths);
+    buildCodes(literalLengths, 256, literalCodes);
+    buildCodes(commandLengths, 704, commandCodeBits);
+    buildCodes(distanceLengths, 64, distanceCodeBits);
+    writeBrotliPrefixCode(writer, literalLengths, 256, 8);
+    writeBrotliPrefixCode(writer, commandLengths, 704, 10);
+    writeBrotliPrefixCode(writer, distanceLengths, 64, 6);
+
+    // Data
+    pos = start;
+    for(int i = 0; i < numCommands; i++) {
+        int insertCode = findCode(insertBase, 24, commands[i].insert);
+        int copyCode = commands[i].copy > 0 ? findCode(copyBase, 24, commands[i].copy) : 0;
+        writeBits(writer, commandCodeBits[commandCodes[i]], commandLengths[commandCodes[i]]);
+        writeBits(writer, commands[i].insert - insertBase[insertCode], insertExtra[insertCode]);
+        writeBits(writer, commands[i].copy > 0 ? commands[i].copy - copyBase[copyCode] : 0, copyExtra[copyCode]);
+        for(int j = 0; j < commands[i].insert; j++, pos++) {
+            writeBits(writer, literalCodes[data[pos]], literalLengths[data[pos]]);
+        }
+        if(commands[i].copy > 0) {
+            writeBits(writer, distanceCodeBits[distanceCodes[i]], distanceLengths[distanceCodes[i]]);
+            writeBits(writer, distanceExtras[i], distanceBits[i]);
+            pos += commands[i].copy;
+        }
+    }
+    free(commandCodes);
+    free(distanceCodes);
+    free(distanceExtras);
+    free(distanceBits);
+}
+
+/*
+    Writes the code lengths of a brotli prefix code. Codes with four or fewer
+    symbols are written as simple prefix codes, by listing their symbols.
+    Other codes have their code lengths written with a code length code,
+    with runs of zeros run length encoded. */
+static void writeBrotliPrefixCode(struct bitWriter* writer, const unsigned char* lengths, int alphabetSize, int alphabetBits) {
+    int numUsed = 0;
+    int lastUsed = 0;
+    for(int i = 0; i < alphabetSize; i++) {
+        if(lengths[i] > 0) {
+            numUsed++;
+            lastUsed = i;
+        }
+    }
+    if(numUsed <= 4) {
+        int symbols[4];
+        int numSymbols = 0;
+        for(int length = 1; length <= 3; length++) { // Shorter codes are listed first
+            for(int i = 0; i < alphabetSize; i++) {
+                if(lengths[i] == length) {
+                    symbols[numSymbols++] = i;
+                }
+            }
+        }
+        ASSERT(numSymbols == numUsed);
+        writeBits(writer, 1, 2); // HSKIP = 1, simple prefix code
+        writeBits(writer, numSymbols - 1, 2);
+        for(int i = 0; i < numSymbols; i++) {
+            writeBits(writer, symbols[i], alphabetBits);
+        }
+        if(numSymbols == 4) {
+            writeBits(writer, lengths[symbols[0]] == 1, 1); // tree select, lengths 1,2,3,3 rather than 2,2,2,2
+        }
+        return;
+    }
+
+    // Run length encode zeros. Repeated 17 codes multiply the previous repeat by 8
+    int* symbols = (int*)malloc(alphabetSize * sizeof(int));
+    int* extras = (int*)malloc(alphabetSize * sizeof(int));
+    int numSymbols = 0;
+    for(int i = 0; i <= lastUsed;) {
+        int run = 1;
+        while(i + run <= lastUsed && lengths[i + run] == lengths[i]) {
+            run++;
+        }
+        if(lengths[i] != 0 || run < 3) {
+            for(int j = 0; j < run; j++) {
+                symbols[numSymbols] = lengths[i];
+                extras[numSymbols++] = 0;
+            }
+        } else {
+            int first = numSymbols;
+            int repeat = run - 3;
+            for(;;) {
+                symbols[numSymbols] = 17;
+                extras[numSymbols++] = repeat & 7;
+                repeat >>= 3;
+                if(repeat == 0) break;
+                repeat--;
+            }
+            for(int j = 0; j < (numSymbols - first) / 2; j++) {
+                int temp = extras[first + j];
+                extras[first + j] = extras[numSymbols - 1 - j];
+                extras[numSymbols - 1 - j] = temp;
+            }
+        }
+        i += run;
+    }
+
+    int codeLengthFreqs[18] = {0};
+    for(int i = 0; i < numSymbols; i++) {
+        codeLengthFreqs[symbols[i]]++;
+    }
+    unsigned char codeLengthLengths[18];
+    unsigned int codeLengthCodes[18];
+    buildLengths(codeLengthFreqs, 18, 5, codeLengthLengths);
+    buildCodes(codeLengthLengths, 18, codeLengthCodes);
+
+    int skip = 0;
+    if(codeLengthLengths[brotliCodeLengthOrder[0]] == 0 && codeLengthLengths[brotliCodeLengthOrder[1]] == 0) {
+        skip = codeLengthLengths[brotliCodeLengthOrder[2]] == 0 ? 3 : 2;
+    }
+    int numCodeLengths = 18;
+    while(numCodeLengths > 0 && codeLengthLengths[brotliCodeLengthOrder[numCodeLengths - 1]] == 0) numCodeLengths--;
+    writeBits(writer, skip, 2);
+    for(int i = skip; i < numCodeLengths; i++) {
+        int length = codeLengthLengths[brotliCodeLengthOrder[i]];
+        writeBits(writer, brotliLengthCodes[length], brotliLengthBits[length]);
+    }
+    for(int i = 0; i < numSymbols; i++) {
+        writeBits(writer, codeLengthCodes[symbols[i]], codeLengthLengths[symbols[i]]);
+        if(symbols[i] == 17) {
+            writeBits(writer, extras[i], 3);
+        }
+    }
+    free(symbols);
+    free(extras);
+}
+
+/*
+    Finds prefix code lengths for symbols with the given frequencies, no
+    longer than maxBits. Codes are always complete, so at least two symbols
+    are given lengths even if fewer are used. If the lengths are too long,
+    frequencies are halved until they fit. */
+static void buildLengths(const int* freqs, int numSymbols, int maxBits, unsigned char* lengths) {
+    int* counts = (int*)malloc(numSymbols * sizeof(int));
+    int numUsed = 0;
+    for(int i = 0; i < numSymbols; i++) {
+        counts[i] = freqs[i];
+        numUsed += counts[i] > 0;
+    }
+    for(int i = 0; i < numSymbols && numUsed < 2; i++) {
+        if(counts[i] == 0) {
+            counts[i] = 1;
+            numUsed++;
+        }
+    }
+    while(huffmanLengths(counts, numSymbols, lengths) > maxBits) {
+        for(int i = 0; i < numSymbols; i++) {
+            if(counts[i] > 0) {
+                counts[i] = (counts[i] >> 1) | 1;
+            }
+        }
+    }
+    free(counts);
+}
+
+/*
+    Builds a Huffman tree for symbols with non-zero counts, and sets each
+    symbol's code length to its depth. Returns the longest length.
+
+    Leaves are sorted by count, and internal nodes are made in order of
+    count, so the two smallest nodes are always at the front of one of the
+    two queues. */
+static int huffmanLengths(const int* counts, int numSymbols, unsigned char* lengths) {
+    long long* keys = (long long*)malloc(numSymbols * sizeof(long long));
+    int numLeaves = 0;
+    for(int i = 0; i < numSymbols; i++) {
+        lengths[i] = 0;
+        if(counts[i] > 0) {
+            keys[numLeaves++] = ((long long)counts[i] << 16) | i;
+        }
+    }
+    qsort(keys, numLeaves, sizeof(long long), compareKeys);
+    if(numLeaves < 2) { // buildLengths gives at least two, but a lone leaf would have no tree to be in
+        for(int i = 0; i < numLeaves; i++) {
+            lengths[keys[i] & 0xFFFF] = 1;
+        }
+        free(keys);
+        return numLeaves;
+    }
+
+    int numNodes = 2 * numLeaves - 1;
+    long long* weights = (long long*)malloc(numNodes * sizeof(long long));
+    int* parents = (int*)malloc(numNodes * sizeof(int));
+    int* depths = (int*)malloc(numNodes * sizeof(int));
+    for(int i = 0; i < numLeaves; i++) {
+        weights[i] = keys[i] >> 16;
+    }
+    int nextLeaf = 0;
+    int nextInternal = numLeaves;
+    for(int node = numLeaves; node < numNodes; node++) {
+        weights[node] = 0;
+        for(int j = 0; j < 2; j++) {
+            int smallest;
+            if(nextLeaf < numLeaves && (nextInternal >= node || weights[nextLeaf] <= weights[nextInternal])) {
+                smallest = nextLeaf++;
+            } else {
+                smallest = nextInternal++;
+            }
+            weights[node] += weights[smallest];
+            parents[smallest] = node;
+        }
+    }
+    int maxLength = 0;
+    depths[numNodes - 1] = 0;
+    for(int i = numNodes - 2; i >= 0; i--) {
+        depths[i] = depths[parents[i]] + 1;
+    }
+    for(int i = 0; i < numLeaves; i++) {
+        lengths[keys[i] & 0xFFFF] = depths[i];
+        if(depths[i] > maxLength) {
+            maxLength = depths[i];
+        }
+    }
+    free(keys);
+    free(weights);
+    free(parents);
+    free(depths);
+    return maxLength;
+}
+
+/*
+    Assigns canonical prefix codes from code lengths. Codes are bit reversed,
+    since prefix codes are packed starting with their most significant bit
+    but bits are written least significant first. */
+static void buildCodes(const unsigned char* lengths, int numSymbols, unsigned int* codes) {
+    int lengthCounts[MAX_BITS + 1] = {0};
+    unsigned int nextCode[MAX_BITS + 1];
+    for(int i = 0; i < numSymbols; i++) {
+        lengthCounts[lengths[i]]++;
+    }
+    lengthCounts[0] = 0;
+    unsigned int code = 0;
+    for(int bits = 1; bits <= MAX_BITS; bits++) {
+        code = (code + lengthCounts[bits - 1]) << 1;
+        nextCode[bits] = code;
+    }
+    for(int i = 0; i < numSymbols; i++) {
+        codes[i] = 0;
+        if(lengths[i] == 0) continue;
+        unsigned int symbolCode = nextCode[lengths[i]]++;
+        for(int bit = 0; bit < lengths[i]; bit++) {
+            codes[i] = (codes[i] << 1) | ((symbolCode >> bit) & 1);
+        }
+    }
+}
+
+/*
+    Returns the index of the largest base that is not larger than a value */
+static int findCode(const int* bases, int numBases, int value) {
+    int code = 0;
+    while(code + 1 < numBases && bases[code + 1] <= value) {
+        code++;
+    }
+    return code;
+}
+
+/*
+    Orders leaf keys, which are a count followed by a symbol */
+static int compareKeys(const void* a, const void* b) {
+    long long left = *(const long long*)a;
+    long long right = *(const long long*)b;
+    return (left > right) - (left < right);
+}
+
+/*
+    Returns the CRC-32 of a buffer, as used by gzip */
+static unsigned int crc32(const unsigned char* data, int length) {
+    unsigned int table[256];
+    for(unsigned int i = 0; i < 256; i++) {
+        unsigned int crc = i;
+        for(int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+        table[i] = crc;
+    }
+    unsigned int crc = 0xFFFFFFFF;
+    for(int i = 0; i < length; i++) {
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+/*
+    Writes the lowest bits of a value */
+static void writeBits(struct bitWriter* writer, unsigned long long value, int numBits) {
+    if(numBits == 0) return;
+    writer->bits |= (value & ((1ULL << numBits) - 1)) << writer->numBits;
+    writer->numBits += numBits;
+    while(writer->numBits >= 8) {
+        writeByte(writer, writer->bits & 0xFF);
+        writer->bits >>= 8;
+        writer->numBits -= 8;
+    }
+}
+
+/*
+    Writes a whole byte to the buffer, ignoring bits that are not yet written */
+static void writeByte(struct bitWriter* writer, unsigned char byte) {
+    if(writer->length == writer->capacity) {
+        writer->capacity = writer->capacity > 0 ? writer->capacity * 2 : 4096;
+        writer->data = (unsigned char*)realloc(writer->data, writer->capacity);
+    }
+    writer->data[writer->length++] = byte;
+}
+
+/*
+    Pads the bits written so far with zeros, up to the next byte */
+static void alignByte(struct bitWriter* writer) {
+    if(writer->numBits > 0) {
+        writeBits(writer, 0, 8 - writer->numBits);
+    }
+}
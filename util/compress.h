@@ -0,0 +1,16 @@
+/*  compress.h
+
+    Gzip and brotli compression of output files, at levels from 0 to 9.
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+// Compress a buffer, returns a new buffer and sets its length
+unsigned char* compress_gzip(const unsigned char*, int, int, int*);
+unsigned char* compress_brotli(const unsigned char*, int, int, int*);
+
+#endif
@@ -0,0 +1,90 @@
+/*  deque.c
+
+    A deque keeps its elements in one array that is used as a ring buffer.
+    Elements start at head and wrap around to the start of the array, so 
+    elements can be popped off the front without moving the rest.
+
+    Unlike lists, pushing onto a deque does not allocate anything unless the 
+    array is full, in which case the array is doubled.
+    
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "deque.h"
+#include "./alloc.h"
+#include "./debug.h"
+
+static void grow(struct deque*);
+
+/*  Creates a new, empty deque */
+struct deque* deque_create() {
+    struct deque* deque = (struct deque*)alloc_malloc(ALLOC_DEQUE, sizeof(struct deque));
+    deque->capacity = 16;
+    deque->data = (void**)alloc_malloc(ALLOC_DEQUE, sizeof(void*) * deque->capacity);
+    deque->head = 0;
+    deque->size = 0;
+    return deque;
+}
+
+/*  Destroys a deque. The data pointed to by the deque is NOT freed */
+void deque_destroy(struct deque* deque) {
+    ASSERT(deque != NULL);
+    alloc_free(ALLOC_DEQUE, deque->data, sizeof(void*) * deque->capacity);
+    alloc_free(ALLOC_DEQUE, deque, sizeof(struct deque));
+}
+
+/*  Appends a data pointer to the end of the deque */
+void deque_push(struct deque* deque, void* data) {
+    ASSERT(deque != NULL);
+    if(deque->size == deque->capacity) {
+        grow(deque);
+    }
+    deque->data[(deque->head + deque->size) & (deque->capacity - 1)] = data;
+    deque->size++;
+}
+
+/*  Removes the front data pointer from the deque and returns it */
+void* deque_pop(struct deque* deque) {
+    ASSERT(deque != NULL);
+    ASSERT(!deque_isEmpty(deque));
+    void* retval = deque->data[deque->head];
+    deque->head = (deque->head + 1) & (deque->capacity - 1);
+    deque->size--;
+    return retval;
+}
+
+/*  Returns the front data pointer of the deque */
+void* deque_peek(struct deque* deque) {
+    ASSERT(deque != NULL);
+    ASSERT(!deque_isEmpty(deque));
+    return deque->data[deque->head];
+}
+
+/*  Returns the data pointer that is a given number of places from the front */
+void* deque_get(struct deque* deque, int i) {
+    ASSERT(deque != NULL);
+    ASSERT(i >= 0 && i < deque->size);
+    return deque->data[(deque->head + i) & (deque->capacity - 1)];
+}
+
+int deque_isEmpty(struct deque* deque) {
+    ASSERT(deque != NULL);
+    return deque->size == 0;
+}
+
+/*  Doubles the array, moving the elements so that the front is at index 0 */
+static void grow(struct deque* deque) {
+    void** data = (void**)alloc_malloc(ALLOC_DEQUE, sizeof(void*) * deque->capacity * 2);
+    int first = deque->capacity - deque->head; // elements before wrapping around
+    if(first > deque->size) first = deque->size;
+    memcpy(data, deque->data + deque->head, sizeof(void*) * first);
+    memcpy(data + first, deque->data, sizeof(void*) * (deque->size - first));
+    alloc_free(ALLOC_DEQUE, deque->data, sizeof(void*) * deque->capacity);
+    deque->data = data;
+    deque->head = 0;
+    deque->capacity *= 2;
+}
@@ -0,0 +1,36 @@
+/*  deque.h
+
+    Deques of void pointers, which token streams use to hold the tokens that
+    have been lexed but not yet taken by the parser.
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#ifndef DEQUE_H
+#define DEQUE_H
+
+// Ring buffer of void pointers, used as a queue or as a list that is read in order
+struct deque {
+    void** data;
+    int head;
+    int size;
+    int capacity; // always a power of two
+};
+
+// Deque create/destroy
+struct deque* deque_create();
+void deque_destroy(struct deque*);
+
+// Queue operations
+void deque_push(struct deque*, void*);
+void* deque_pop(struct deque*);
+void* deque_peek(struct deque*);
+
+// Random access
+void* deque_get(struct deque*, int);
+
+// Simple operations
+int deque_isEmpty(struct deque*);
+
+#endif
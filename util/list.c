@@ -16,11 +16,12 @@
 #include <stdio.h>
 
 #include "list.h"
+#include "./alloc.h"
 #include "./debug.h"
 
 /*  Creates a new list, with no new nodes. */
 struct list* list_create() {
-    struct list* list = (struct list*)malloc(sizeof(struct list));
+    struct list* list = (struct list*)alloc_malloc(ALLOC_LIST, sizeof(struct list));
 
     list->head.prev = NULL;
     list->head.next = &list->tail;
@@ -37,6 +38,13 @@ struct list* list_create() {
     free data before hand! (or it'll be bad) */
 void list_destroy(struct list* list) {
     ASSERT(list != NULL);
+    struct listElem* elem = list_begin(list);
+    while(elem != list_end(list)) {
+        struct listElem* next = list_next(elem);
+        alloc_free(ALLOC_LIST, elem, sizeof(struct listElem));
+        elem = next;
+    }
+    alloc_free(ALLOC_LIST, list, sizeof(struct list));
 }
 
 /*  Gives the starting point of the list */
@@ -63,7 +71,7 @@ struct listElem* list_end(struct list* list) {
 void list_insert(struct list* list, struct listElem* before, void* data) {
     ASSERT(list != NULL);
     ASSERT(before != NULL);
-    struct listElem* elem = (struct listElem*)malloc(sizeof(struct listElem));
+    struct listElem* elem = (struct listElem*)alloc_malloc(ALLOC_LIST, sizeof(struct listElem));
     elem->data = data;
     elem->prev = before->prev;
     elem->next = before;
@@ -88,7 +96,7 @@ void* list_remove(struct list* list, struct listElem* elem) {
     // Swap pointers, free old node
     prev->next = next;
     next->prev = prev;
-    free(elem);
+    alloc_free(ALLOC_LIST, elem, sizeof(struct listElem));
     list->size--;
 
     return retval;
@@ -11,19 +11,25 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include "./alloc.h"
 #include "./debug.h"
 #include "./list.h"
 
 int hash(const char*);
 void addNode(struct map* map, char* key, void* value, int hash);
+static void grow(struct map*);
+
+static int countLookups = 0; // whether map_get counts lookups and probes for map_stats
 
 /*
     Creates a map pointer */
 struct map* map_create() {
-    struct map* map = (struct map*)malloc(sizeof(map));
+    struct map* map = (struct map*)alloc_malloc(ALLOC_MAP, sizeof(struct map));
     map->size = 0;
     map->capacity = 10;
-    map->lists = (struct mapNode**)calloc(map->capacity, sizeof(struct mapNode*));
+    map->lookups = 0;
+    map->probes = 0;
+    map->lists = (struct mapNode**)alloc_calloc(ALLOC_MAP, map->capacity, sizeof(struct mapNode*));
     map->keyList = list_create();
     return map;
 }
@@ -36,16 +42,16 @@ struct map* map_create() {
 void map_destroy(struct map* map) {
     ASSERT(map != NULL);
     for (int i = 0; i < map->capacity; i++) {
-        if (!map->lists[i]) {
-            struct mapNode* curr = map->lists[i];
-            while (curr != NULL) {
-                struct mapNode* freeMe = curr;
-                curr = curr->next;
-                free(freeMe);
-            }
+        struct mapNode* curr = map->lists[i];
+        while (curr != NULL) {
+            struct mapNode* freeMe = curr;
+            curr = curr->next;
+            alloc_free(ALLOC_MAP, freeMe, sizeof(struct mapNode));
         }
     }
-    free(map);
+    alloc_free(ALLOC_MAP, map->lists, map->capacity * sizeof(struct mapNode*));
+    list_destroy(map->keyList);
+    alloc_free(ALLOC_MAP, map, sizeof(struct map));
 }
 
 /*
@@ -66,9 +72,34 @@ int map_put(struct map* map, char* key, void* value) {
         return 1;
     }
     map->size++;
+    if (map->size > map->capacity) {
+        grow(map);
+    }
     return 0;
 }
 
+/*
+    Doubles the buckets of a map, so that chains stay short however many keys
+    a scope has. Nodes are moved to their new buckets rather than copied. The
+    key list is left as it is, so keys keep the order they were added in. */
+static void grow(struct map* map) {
+    int capacity = map->capacity * 2;
+    struct mapNode** lists = (struct mapNode**)alloc_calloc(ALLOC_MAP, capacity, sizeof(struct mapNode*));
+    for (int i = 0; i < map->capacity; i++) {
+        struct mapNode* curr = map->lists[i];
+        while (curr != NULL) {
+            struct mapNode* next = curr->next;
+            unsigned int hashcode = abs(hash(curr->key)) % capacity;
+            curr->next = lists[hashcode];
+            lists[hashcode] = curr;
+            curr = next;
+        }
+    }
+    alloc_free(ALLOC_MAP, map->lists, map->capacity * sizeof(struct mapNode*));
+    map->lists = lists;
+    map->capacity = capacity;
+}
+
 /*
     Returns a the pointer associated with a given string key. Returns NULL if 
     key is not in map. */
@@ -76,20 +107,50 @@ void* map_get(struct map* map, const char* key) {
     ASSERT(map != NULL);
     ASSERT(key != NULL);
     unsigned int hashcode = abs(hash(key)) % map->capacity;
-    struct mapNode* bucket = map->lists[hashcode];
-    if (bucket == NULL) {
+    struct mapNode* curr = map->lists[hashcode];
+    long probes = 0;
+    while (curr != NULL) {
+        probes++;
+        if (strcmp(curr->key, key) == 0) {
+            break;
+        }
+        curr = curr->next;
+    }
+    if (countLookups) {
+        __atomic_add_fetch(&map->lookups, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&map->probes, probes, __ATOMIC_RELAXED);
+    }
+    return curr != NULL ? curr->value : NULL;
+}
+
+/*
+    Removes a key from a map. Returns the pointer that was associated with the
+    key, or NULL if the key was not in the map. */
+void* map_remove(struct map* map, const char* key) {
+    ASSERT(map != NULL);
+    ASSERT(key != NULL);
+    unsigned int hashcode = abs(hash(key)) % map->capacity;
+    struct mapNode** link = &map->lists[hashcode];
+    while (*link != NULL && strcmp((*link)->key, key) != 0) {
+        link = &(*link)->next;
+    }
+    if (*link == NULL) {
         return NULL;
     }
-    else {
-        struct mapNode* curr = bucket;
-        while (curr != NULL) {
-            if (strcmp(curr->key, key) == 0) {
-                return curr->value;
-            }
-            curr = curr->next;
+    struct mapNode* node = *link;
+    void* retval = node->value;
+    *link = node->next;
+
+    struct listElem* elem;
+    for(elem = list_begin(map->keyList); elem != list_end(map->keyList); elem = list_next(elem)) {
+        if(strcmp(elem->data, key) == 0) {
+            list_remove(map->keyList, elem);
+            break;
         }
     }
-    return NULL;
+    alloc_free(ALLOC_MAP, node, sizeof(struct mapNode));
+    map->size--;
+    return retval;
 }
 
 /*
@@ -123,10 +184,45 @@ int set_contains(struct map* set, const char* key) {
     return map_get(set, key) != NULL;
 }
 
+/*
+    Turns counting lookups and probes in map_get on or off. Counting is off
+    unless asked for, since map_get is on the compiler's hottest path. Counts
+    are added atomically, since maps are read from more than one thread with
+    -j */
+void map_countLookups(int on) {
+    countLookups = on;
+}
+
+/*
+    Fills in how full a map is, how long its bucket chains are, and how many 
+    keys have been compared to find keys in it. Lookups are only counted
+    after map_countLookups has been turned on */
+void map_stats(struct map* map, struct mapStats* stats) {
+    ASSERT(map != NULL);
+    stats->size = map->size;
+    stats->capacity = map->capacity;
+    stats->usedBuckets = 0;
+    stats->maxChain = 0;
+    stats->lookups = map->lookups;
+    stats->probes = map->probes;
+    for (int i = 0; i < map->capacity; i++) {
+        int chain = 0;
+        for (struct mapNode* curr = map->lists[i]; curr != NULL; curr = curr->next) {
+            chain++;
+        }
+        if (chain > 0) {
+            stats->usedBuckets++;
+        }
+        if (chain > stats->maxChain) {
+            stats->maxChain = chain;
+        }
+    }
+}
+
 /*
     Adds a node to a map, and the key to the keylist */
 void addNode(struct map* map, char* key, void* value, int hash) {
-    struct mapNode* node = (struct mapNode*) malloc(sizeof(struct mapNode*));
+    struct mapNode* node = (struct mapNode*)alloc_malloc(ALLOC_MAP, sizeof(struct mapNode));
     node->key = key;
     node->value = value;
     node->next = map->lists[hash];
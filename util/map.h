@@ -15,15 +15,30 @@ struct map {
 	int capacity;
 	struct mapNode** lists;
 	struct list* keyList;
+	long lookups;	// calls to map_get, counted for map_stats once map_countLookups is on
+	long probes;	// keys compared in those calls
+};
+
+// How well a map spreads out its keys
+struct mapStats {
+	int size;
+	int capacity;
+	int usedBuckets;	// buckets with at least one key
+	int maxChain;		// most keys in one bucket
+	long lookups;
+	long probes;
 };
 
 struct map* map_create();
 void map_destroy(struct map*);
 int map_put(struct map*, char*, void*);
 void* map_get(struct map*, const char*);
+void* map_remove(struct map*, const char*);
 struct list* map_getKeyList(struct map* map);
 void map_copy(struct map*, struct map*);
 int set_add(struct map*, char*);
 int set_contains(struct map*, const char*);
+void map_countLookups(int);
+void map_stats(struct map*, struct mapStats*);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+/*  vector.c
+
+    A vector keeps its elements in one array, with the top of the stack at the
+    end. The array is doubled when it is full, so pushing only allocates once
+    in a while.
+    
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vector.h"
+#include "./alloc.h"
+#include "./debug.h"
+
+/*  Creates a new, empty vector */
+struct vector* vector_create() {
+    struct vector* vector = (struct vector*)alloc_malloc(ALLOC_VECTOR, sizeof(struct vector));
+    vector->capacity = 16;
+    vector->data = (void**)alloc_malloc(ALLOC_VECTOR, sizeof(void*) * vector->capacity);
+    vector->size = 0;
+    return vector;
+}
+
+/*  Destroys a vector. The data pointed to by the vector is NOT freed */
+void vector_destroy(struct vector* vector) {
+    ASSERT(vector != NULL);
+    alloc_free(ALLOC_VECTOR, vector->data, sizeof(void*) * vector->capacity);
+    alloc_free(ALLOC_VECTOR, vector, sizeof(struct vector));
+}
+
+/*  Pushes a data pointer onto the top of the vector */
+void vector_push(struct vector* vector, void* data) {
+    ASSERT(vector != NULL);
+    if(vector->size == vector->capacity) {
+        void** data = (void**)alloc_malloc(ALLOC_VECTOR, sizeof(void*) * vector->capacity * 2);
+        memcpy(data, vector->data, sizeof(void*) * vector->size);
+        alloc_free(ALLOC_VECTOR, vector->data, sizeof(void*) * vector->capacity);
+        vector->data = data;
+        vector->capacity *= 2;
+    }
+    vector->data[vector->size++] = data;
+}
+
+/*  Removes the top data pointer from the vector and returns it */
+void* vector_pop(struct vector* vector) {
+    ASSERT(vector != NULL);
+    ASSERT(!vector_isEmpty(vector));
+    return vector->data[--vector->size];
+}
+
+/*  Returns the top data pointer of the vector */
+void* vector_peek(struct vector* vector) {
+    ASSERT(vector != NULL);
+    ASSERT(!vector_isEmpty(vector));
+    return vector->data[vector->size - 1];
+}
+
+int vector_isEmpty(struct vector* vector) {
+    ASSERT(vector != NULL);
+    return vector->size == 0;
+}
@@ -0,0 +1,32 @@
+/*  vector.h
+
+    Vectors of void pointers, which the parser uses as the stacks of operators
+    and operands it builds expressions with.
+
+    Author: Joseph Shimel
+    Date: 10/17/26
+*/
+
+#ifndef VECTOR_H
+#define VECTOR_H
+
+// Growable array of void pointers, used as a stack
+struct vector {
+    void** data;
+    int size;
+    int capacity;
+};
+
+// Vector create/destroy
+struct vector* vector_create();
+void vector_destroy(struct vector*);
+
+// Stack operations
+void vector_push(struct vector*, void*);
+void* vector_pop(struct vector*);
+void* vector_peek(struct vector*);
+
+// Simple operations
+int vector_isEmpty(struct vector*);
+
+#endif